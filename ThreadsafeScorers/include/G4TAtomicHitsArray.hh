@@ -0,0 +1,275 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file parallel/ThreadsafeScorers/include/G4TAtomicHitsArray.hh
+/// \brief Definition of the G4TAtomicHitsArray class
+//
+//
+//
+//
+/// This is a dense alternative to G4TAtomicHitsMap<T> for scorers whose
+///     keys are copy numbers in a range known up front, e.g.
+///     [0, TSDetectorConstruction::GetTotalTargets()). The values are
+///     std::atomic<T> stored contiguously in cache-line aligned blocks, so
+///     an add is a single lock-free read-modify-write with no lookup and no
+///     per-entry heap allocation. When the array is small enough, every
+///     entry gets a cache line of its own so that threads scoring in
+///     neighbouring sections do not invalidate each other's lines (false
+///     sharing); large arrays are packed since contention per entry is low.
+/// The accumulator type defaults to std::atomic<T>, added to with fetch_add
+///     where available (C++20 for floating-point types); it can also be
+///     G4atomic_compensated<T> for order-independent floating-point sums.
+/// Keys outside of the dense range are accepted and accumulated in a sparse
+///     map guarded by a mutex, so the class can be used where the range is
+///     only mostly known.
+/// Like G4TAtomicHitsMap, there should only be one instance, shared by
+///     all of the threads, and it does not need to be summed in
+///     G4Run::Merge().
+//
+//
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#ifndef G4TAtomicHitsArray_h
+#define G4TAtomicHitsArray_h 1
+
+#include "G4VHitsCollection.hh"
+#include "G4THitsMap.hh"
+#include "globals.hh"
+#include "G4Threading.hh"
+#include "G4AutoLock.hh"
+#include "G4atomic_compensated.hh"
+#include "TSContention.hh"
+
+#include <atomic>
+#include <map>
+#include <type_traits>
+#include <vector>
+
+template <typename T, typename Acc = std::atomic<T>>
+class G4TAtomicHitsArray : public G4VHitsCollection
+{
+ protected:
+  static_assert(std::is_fundamental<T>::value,
+                "G4TAtomicHitsArray must use fundamental type");
+
+ public:
+  typedef Acc value_type;
+  typedef std::map<G4int, T> sparse_type;
+
+  // size of the blocks the dense entries are stored in
+  static constexpr size_t CacheLineSize = 64;
+  // arrays up to this many bytes when padded get one cache line per entry
+  static constexpr size_t PaddingLimit = 1 << 20;
+
+ public:
+  G4TAtomicHitsArray(G4String detName, G4String colNam, G4int size);
+  virtual ~G4TAtomicHitsArray() {}
+
+ public:
+  G4TAtomicHitsArray<T, Acc>& operator+=(const G4THitsMap<T>& right) const;
+
+ public:
+  virtual void DrawAllHits() {}
+  virtual void PrintAllHits();
+
+ public:
+  //  Add to the entry of a key. Dense keys are lock-free, others lock.
+  inline void add(G4int key, const T& aHit) const;
+  //  Overwrite the entry of a key.
+  inline void set(G4int key, const T& aHit) const;
+  //  Value of the entry of a key, zero if never scored.
+  inline T get(G4int key) const;
+  //  Reset every entry to zero. Not to be called concurrently with add().
+  void clear();
+
+  //  Calls func(key, value) for every non-zero entry, dense keys first
+  //  in increasing order. Only meaningful once the threads are done.
+  template <typename Func>
+  void for_each(Func&& func) const;
+
+  inline G4int dense_size() const { return fSize; }
+  inline G4bool padded() const { return fStride > 1; }
+
+ public:
+  virtual G4VHit* GetHit(size_t) const { return 0; }
+  virtual size_t GetSize() const { return size(); }
+  virtual size_t size() const;
+
+ private:
+  static constexpr size_t SlotsPerLine =
+    (CacheLineSize / sizeof(value_type) > 0)
+      ? CacheLineSize / sizeof(value_type)
+      : 1;
+
+  struct alignas(CacheLineSize) Line
+  {
+    value_type slots[SlotsPerLine] = {};
+  };
+
+  inline value_type& slot(G4int key) const
+  {
+    size_t i = static_cast<size_t>(key) * fStride;
+    return fLines[i / SlotsPerLine].slots[i % SlotsPerLine];
+  }
+
+  static inline void increment(std::atomic<T>& entry, const T& value)
+  {
+#if defined(__cpp_lib_atomic_float)
+    entry.fetch_add(value, std::memory_order_relaxed);
+#else
+    if constexpr(std::is_integral<T>::value && !std::is_same<T, bool>::value)
+      entry.fetch_add(value, std::memory_order_relaxed);
+    else
+    {
+      T expected = entry.load(std::memory_order_relaxed);
+      while(!entry.compare_exchange_weak(expected, expected + value,
+                                         std::memory_order_relaxed))
+      {
+        TS_CONTENTION_ADD(kCasRetries, 1);
+      }
+    }
+#endif
+  }
+
+  template <typename U>
+  static inline void increment(U& entry, const T& value)
+  {
+    entry += value;
+  }
+
+ private:
+  G4int fSize;
+  size_t fStride;
+  mutable std::vector<Line> fLines;
+  mutable sparse_type fSparse;
+  mutable G4Mutex fMutex;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+template <typename T, typename Acc>
+G4TAtomicHitsArray<T, Acc>::G4TAtomicHitsArray(G4String detName,
+                                               G4String colNam, G4int size)
+  : G4VHitsCollection(detName, colNam)
+  , fSize((size > 0) ? size : 0)
+  , fStride(1)
+{
+  size_t padded = static_cast<size_t>(fSize) * CacheLineSize;
+  if(padded <= PaddingLimit)
+    fStride = SlotsPerLine;
+  size_t slots = static_cast<size_t>(fSize) * fStride;
+  fLines       = std::vector<Line>((slots + SlotsPerLine - 1) / SlotsPerLine);
+}
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+template <typename T, typename Acc>
+G4TAtomicHitsArray<T, Acc>& G4TAtomicHitsArray<T, Acc>::operator+=(
+  const G4THitsMap<T>& rhs) const
+{
+  for(auto itr = rhs.GetMap()->begin(); itr != rhs.GetMap()->end(); itr++)
+    add(itr->first, *(itr->second));
+
+  return (G4TAtomicHitsArray<T, Acc>&) (*this);
+}
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+template <typename T, typename Acc>
+inline void G4TAtomicHitsArray<T, Acc>::add(G4int key, const T& aHit) const
+{
+  if(key >= 0 && key < fSize)
+    increment(slot(key), aHit);
+  else
+  {
+    TS_CONTENTION_LOCK(l, &fMutex);
+    TS_CONTENTION_INSERTIONS(ins, fSparse);
+    fSparse[key] += aHit;
+  }
+}
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+template <typename T, typename Acc>
+inline void G4TAtomicHitsArray<T, Acc>::set(G4int key, const T& aHit) const
+{
+  if(key >= 0 && key < fSize)
+    slot(key) = aHit;
+  else
+  {
+    TS_CONTENTION_LOCK(l, &fMutex);
+    fSparse[key] = aHit;
+  }
+}
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+template <typename T, typename Acc>
+inline T G4TAtomicHitsArray<T, Acc>::get(G4int key) const
+{
+  if(key >= 0 && key < fSize)
+    return slot(key);
+
+  TS_CONTENTION_LOCK(l, &fMutex);
+  auto itr = fSparse.find(key);
+  return (itr != fSparse.end()) ? itr->second : T();
+}
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+template <typename T, typename Acc>
+void G4TAtomicHitsArray<T, Acc>::clear()
+{
+  for(G4int i = 0; i < fSize; ++i)
+    slot(i) = T();
+
+  TS_CONTENTION_LOCK(l, &fMutex);
+  fSparse.clear();
+}
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+template <typename T, typename Acc>
+template <typename Func>
+void G4TAtomicHitsArray<T, Acc>::for_each(Func&& func) const
+{
+  for(G4int i = 0; i < fSize; ++i)
+  {
+    T value = slot(i);
+    if(value != T())
+      func(i, value);
+  }
+
+  TS_CONTENTION_LOCK(l, &fMutex);
+  for(const auto& itr : fSparse)
+    if(itr.second != T())
+      func(itr.first, itr.second);
+}
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+template <typename T, typename Acc>
+size_t G4TAtomicHitsArray<T, Acc>::size() const
+{
+  TS_CONTENTION_LOCK(l, &fMutex);
+  return fSize + fSparse.size();
+}
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+template <typename T, typename Acc>
+void G4TAtomicHitsArray<T, Acc>::PrintAllHits()
+{
+  G4cout << "G4TAtomicHitsArray " << SDname << " / " << collectionName
+         << " --- " << fSize << " dense entries"
+         << (padded() ? " (padded)" : "") << G4endl;
+}
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -37,6 +37,9 @@
 ///     STL implementation is lock-free) but the synchronization does
 ///     not come without a cost. If performance is the primary concern,
 ///     use G4THitsMap<T> in thread-local instances.
+/// The accumulator type defaults to G4atomic<T>; a compensated accumulator,
+///     G4atomic_compensated<T>, can be given instead for floating-point sums
+///     that must not depend on the order the threads add in.
 //
 //
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -49,8 +52,10 @@
 #include "G4THitsMap.hh"
 #include "globals.hh"
 #include "G4atomic.hh"
+#include "G4atomic_compensated.hh"
 #include "G4Threading.hh"
 #include "G4AutoLock.hh"
+#include "TSContention.hh"
 
 #include <map>
 #include <type_traits>
@@ -65,7 +70,7 @@
 // cannot be instansiated with a template class. Thus G4HitsMap
 // class MUST NOT be directly used by the user.
 
-template <typename T>
+template <typename T, typename Acc = G4atomic<T>>
 class G4TAtomicHitsMap : public G4VHitsCollection
 {
  protected:
@@ -73,7 +78,7 @@ class G4TAtomicHitsMap : public G4VHitsCollection
                 "G4TAtomicHitsMap must use fundamental type");
 
  public:
-  typedef G4atomic<T> value_type;
+  typedef Acc value_type;
   typedef value_type* mapped_type;
   typedef typename std::map<G4int, mapped_type> container_type;
   typedef typename container_type::iterator iterator;
@@ -88,9 +93,10 @@ class G4TAtomicHitsMap : public G4VHitsCollection
 
  public:
   virtual ~G4TAtomicHitsMap();
-  G4bool operator==(const G4TAtomicHitsMap<T>& right) const;
-  G4TAtomicHitsMap<T>& operator+=(const G4TAtomicHitsMap<T>& right) const;
-  G4TAtomicHitsMap<T>& operator+=(const G4THitsMap<T>& right) const;
+  G4bool operator==(const G4TAtomicHitsMap<T, Acc>& right) const;
+  G4TAtomicHitsMap<T, Acc>& operator+=(
+    const G4TAtomicHitsMap<T, Acc>& right) const;
+  G4TAtomicHitsMap<T, Acc>& operator+=(const G4THitsMap<T>& right) const;
 
  public:  // with description
   virtual void DrawAllHits();
@@ -141,19 +147,19 @@ class G4TAtomicHitsMap : public G4VHitsCollection
 };
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
-template <typename T>
-G4TAtomicHitsMap<T>::G4TAtomicHitsMap()
+template <typename T, typename Acc>
+G4TAtomicHitsMap<T, Acc>::G4TAtomicHitsMap()
   : theCollection(new container_type)
 {}
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
-template <typename T>
-G4TAtomicHitsMap<T>::G4TAtomicHitsMap(G4String detName, G4String colNam)
+template <typename T, typename Acc>
+G4TAtomicHitsMap<T, Acc>::G4TAtomicHitsMap(G4String detName, G4String colNam)
   : G4VHitsCollection(detName, colNam)
   , theCollection(new container_type)
 {}
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
-template <typename T>
-G4TAtomicHitsMap<T>::~G4TAtomicHitsMap()
+template <typename T, typename Acc>
+G4TAtomicHitsMap<T, Acc>::~G4TAtomicHitsMap()
 {
   for(auto itr = theCollection->begin(); itr != theCollection->end(); itr++)
     delete itr->second;
@@ -161,46 +167,47 @@ G4TAtomicHitsMap<T>::~G4TAtomicHitsMap()
   delete theCollection;
 }
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
-template <typename T>
-G4bool G4TAtomicHitsMap<T>::operator==(const G4TAtomicHitsMap<T>& right) const
+template <typename T, typename Acc>
+G4bool G4TAtomicHitsMap<T, Acc>::operator==(
+  const G4TAtomicHitsMap<T, Acc>& right) const
 {
   return (collectionName == right.collectionName);
 }
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
-template <typename T>
-G4TAtomicHitsMap<T>& G4TAtomicHitsMap<T>::operator+=(
-  const G4TAtomicHitsMap<T>& rhs) const
+template <typename T, typename Acc>
+G4TAtomicHitsMap<T, Acc>& G4TAtomicHitsMap<T, Acc>::operator+=(
+  const G4TAtomicHitsMap<T, Acc>& rhs) const
 {
   for(auto itr = rhs.GetMap()->begin(); itr != rhs.GetMap()->end(); itr++)
     add(itr->first, *(itr->second));
 
-  return (G4TAtomicHitsMap<T>&) (*this);
+  return (G4TAtomicHitsMap<T, Acc>&) (*this);
 }
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
-template <typename T>
-G4TAtomicHitsMap<T>& G4TAtomicHitsMap<T>::operator+=(
+template <typename T, typename Acc>
+G4TAtomicHitsMap<T, Acc>& G4TAtomicHitsMap<T, Acc>::operator+=(
   const G4THitsMap<T>& rhs) const
 {
   for(auto itr = rhs.GetMap()->begin(); itr != rhs.GetMap()->end(); itr++)
     add(itr->first, *(itr->second));
 
-  return (G4TAtomicHitsMap<T>&) (*this);
+  return (G4TAtomicHitsMap<T, Acc>&) (*this);
 }
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
-template <typename T>
-inline
-  typename G4TAtomicHitsMap<T>::value_type* G4TAtomicHitsMap<T>::operator[](
-    G4int key) const
+template <typename T, typename Acc>
+inline typename G4TAtomicHitsMap<T, Acc>::value_type*
+G4TAtomicHitsMap<T, Acc>::operator[](G4int key) const
 {
   if(theCollection->find(key) != theCollection->end())
     return theCollection->find(key)->second;
   else
   {
-    G4AutoLock l(&fMutex);
+    TS_CONTENTION_LOCK(l, &fMutex);
     if(theCollection->find(key) == theCollection->end())
     {
       value_type* ptr       = new value_type;
       (*theCollection)[key] = ptr;
+      TS_CONTENTION_ADD(kInsertions, 1);
       return ptr;
     }
     else
@@ -208,22 +215,24 @@ inline
   }
 }
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
-template <typename T>
-inline G4int G4TAtomicHitsMap<T>::add(const G4int& key, value_type*& aHit) const
+template <typename T, typename Acc>
+inline G4int G4TAtomicHitsMap<T, Acc>::add(const G4int& key,
+                                            value_type*& aHit) const
 {
   if(theCollection->find(key) != theCollection->end())
     *(*theCollection)[key] += *aHit;
   else
   {
-    G4AutoLock l(&fMutex);
+    TS_CONTENTION_LOCK(l, &fMutex);
     (*theCollection)[key] = aHit;
+    TS_CONTENTION_ADD(kInsertions, 1);
   }
-  G4AutoLock l(&fMutex);
+  TS_CONTENTION_LOCK(l, &fMutex);
   return theCollection->size();
 }
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
-template <typename T>
-inline G4int G4TAtomicHitsMap<T>::add(const G4int& key, T& aHit) const
+template <typename T, typename Acc>
+inline G4int G4TAtomicHitsMap<T, Acc>::add(const G4int& key, T& aHit) const
 {
   if(theCollection->find(key) != theCollection->end())
     *(*theCollection)[key] += aHit;
@@ -231,26 +240,28 @@ inline G4int G4TAtomicHitsMap<T>::add(const G4int& key, T& aHit) const
   {
     value_type* hit = new value_type;
     *hit            = aHit;
-    G4AutoLock l(&fMutex);
+    TS_CONTENTION_LOCK(l, &fMutex);
     (*theCollection)[key] = hit;
+    TS_CONTENTION_ADD(kInsertions, 1);
   }
-  G4AutoLock l(&fMutex);
+  TS_CONTENTION_LOCK(l, &fMutex);
   return theCollection->size();
 }
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
-template <typename T>
-inline G4int G4TAtomicHitsMap<T>::set(const G4int& key, value_type*& aHit) const
+template <typename T, typename Acc>
+inline G4int G4TAtomicHitsMap<T, Acc>::set(const G4int& key,
+                                            value_type*& aHit) const
 {
   if(theCollection->find(key) != theCollection->end())
     delete(*theCollection)[key]->second;
 
   (*theCollection)[key] = aHit;
-  G4AutoLock l(&fMutex);
+  TS_CONTENTION_LOCK(l, &fMutex);
   return theCollection->size();
 }
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
-template <typename T>
-inline G4int G4TAtomicHitsMap<T>::set(const G4int& key, T& aHit) const
+template <typename T, typename Acc>
+inline G4int G4TAtomicHitsMap<T, Acc>::set(const G4int& key, T& aHit) const
 {
   if(theCollection->find(key) != theCollection->end())
     *(*theCollection)[key] = aHit;
@@ -260,25 +271,25 @@ inline G4int G4TAtomicHitsMap<T>::set(const G4int& key, T& aHit) const
     *hit                  = aHit;
     (*theCollection)[key] = hit;
   }
-  G4AutoLock l(&fMutex);
+  TS_CONTENTION_LOCK(l, &fMutex);
   return theCollection->size();
 }
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
-template <typename T>
-void G4TAtomicHitsMap<T>::DrawAllHits()
+template <typename T, typename Acc>
+void G4TAtomicHitsMap<T, Acc>::DrawAllHits()
 {}
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
-template <typename T>
-void G4TAtomicHitsMap<T>::PrintAllHits()
+template <typename T, typename Acc>
+void G4TAtomicHitsMap<T, Acc>::PrintAllHits()
 {
   G4cout << "G4TAtomicHitsMap " << SDname << " / " << collectionName << " --- "
          << entries() << " entries" << G4endl;
 }
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
-template <typename T>
-void G4TAtomicHitsMap<T>::clear()
+template <typename T, typename Acc>
+void G4TAtomicHitsMap<T, Acc>::clear()
 {
-  G4AutoLock l(&fMutex);
+  TS_CONTENTION_LOCK(l, &fMutex);
 
   for(auto itr = theCollection->begin(); itr != theCollection->end(); itr++)
     delete itr->second;
@@ -0,0 +1,195 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file parallel/ThreadsafeScorers/include/G4atomic_compensated.hh
+/// \brief Definition of the G4atomic_compensated class
+//
+//
+//
+//
+/// This is a compensated (two-word) atomic accumulator for floating-point
+///     sums. A plain atomic sum of many small deposits rounds at every
+///     addition, and since the additions happen in whatever order the
+///     threads run, the result differs from run to run. Here every
+///     addition s + x = t updates the sum atomically and recovers its
+///     rounding error e = (s + x) - t exactly (TwoSum), which is added to a
+///     second atomic word. The value, sum + compensation, is then within
+///     about one rounding of the exact sum, i.e. reproducible to within
+///     that bound whatever the interleaving, as long as the number of terms
+///     times the unit round-off is small.
+/// The old value of the sum is needed to compute the error, so the sum is
+///     updated with fetch_add when std::atomic<_Tp> has it (C++20) and with
+///     a compare-and-swap loop otherwise; both words are lock-free.
+///
+/// IMPORTANT: the error term relies on IEEE rounding, so this must not be
+///     compiled with -ffast-math or equivalent. As with G4atomic, the value
+///     should only be read once the threads are done adding to it.
+///
+/// It can be used as the accumulator of G4TAtomicHitsMap and
+///     G4TAtomicHitsArray, e.g.
+///         G4TAtomicHitsMap<G4double, G4atomic_compensated<G4double>>
+//
+//
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#ifndef G4atomic_compensated_hh_
+#define G4atomic_compensated_hh_
+
+#include "TSContention.hh"
+
+#include <atomic>
+#include <type_traits>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+template <typename _Tp>
+class G4atomic_compensated
+{
+  static_assert(std::is_floating_point<_Tp>::value,
+                "G4atomic_compensated must use floating-point type");
+
+ public:
+  typedef _Tp value_type;
+  typedef std::atomic<_Tp> base_type;
+
+ public:
+  G4atomic_compensated()
+    : fsum(_Tp())
+    , fcomp(_Tp())
+  {}
+
+  explicit G4atomic_compensated(const value_type& _init)
+    : fsum(_init)
+    , fcomp(_Tp())
+  {}
+
+  G4atomic_compensated(const G4atomic_compensated&) = delete;
+
+  // assignment operators
+  G4atomic_compensated& operator=(const G4atomic_compensated& rhs)
+  {
+    if(this != &rhs)
+    {
+      fsum.store(rhs.fsum.load());
+      fcomp.store(rhs.fcomp.load());
+    }
+    return *this;
+  }
+
+  G4atomic_compensated& operator=(const value_type& rhs)
+  {
+    store(rhs);
+    return *this;
+  }
+
+  // value_type operators
+  G4atomic_compensated& operator+=(const value_type& rhs)
+  {
+    add(rhs);
+    return *this;
+  }
+  G4atomic_compensated& operator-=(const value_type& rhs)
+  {
+    add(-rhs);
+    return *this;
+  }
+
+  // compensated operators
+  G4atomic_compensated& operator+=(const G4atomic_compensated& rhs)
+  {
+    add(rhs.sum());
+    increment(fcomp, rhs.compensation());
+    return *this;
+  }
+
+  // store and load functions, as G4atomic
+  void store(value_type _desired,
+             std::memory_order mo = std::memory_order_seq_cst)
+  {
+    fsum.store(_desired, mo);
+    fcomp.store(_Tp(), mo);
+  }
+  value_type load(std::memory_order mo = std::memory_order_seq_cst) const
+  {
+    return fsum.load(mo) + fcomp.load(mo);
+  }
+
+  // the two words
+  value_type sum() const { return fsum.load(); }
+  value_type compensation() const { return fcomp.load(); }
+
+  operator value_type() const { return load(); }
+
+  bool is_lock_free() const
+  {
+    return fsum.is_lock_free() && fcomp.is_lock_free();
+  }
+
+ private:
+  static void increment(base_type& _atomic, const value_type& _value)
+  {
+#if defined(__cpp_lib_atomic_float)
+    _atomic.fetch_add(_value, std::memory_order_relaxed);
+#else
+    _Tp _expected = _atomic.load(std::memory_order_relaxed);
+    while(!_atomic.compare_exchange_weak(_expected, _expected + _value,
+                                         std::memory_order_relaxed))
+    {
+      TS_CONTENTION_ADD(kCasRetries, 1);
+    }
+#endif
+  }
+
+  void add(const value_type& x)
+  {
+    // s is the value the addition was applied to, t = fl(s + x)
+#if defined(__cpp_lib_atomic_float)
+    _Tp s = fsum.fetch_add(x, std::memory_order_relaxed);
+    _Tp t = s + x;
+#else
+    _Tp s = fsum.load(std::memory_order_relaxed);
+    _Tp t = s + x;
+    while(!fsum.compare_exchange_weak(s, t, std::memory_order_relaxed))
+    {
+      TS_CONTENTION_ADD(kCasRetries, 1);
+      t = s + x;
+    }
+#endif
+    // TwoSum: s + x == t + e exactly
+    _Tp bp = t - s;
+    _Tp e  = (s - (t - bp)) + (x - bp);
+    if(e != _Tp())
+      increment(fcomp, e);
+  }
+
+ private:
+  base_type fsum;
+  base_type fcomp;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif  // G4atomic_compensated_hh_
@@ -32,6 +32,10 @@
 /// This is a functional class for G4atomic. The functions in this
 ///     file are not intended to be used outside of their implementation
 ///     in G4atomic.
+/// Additions and subtractions use std::atomic<T>::fetch_add/fetch_sub when
+///     the standard library provides them, i.e. for integral types and, in
+///     C++20 (__cpp_lib_atomic_float), for floating-point types. The other
+///     cases go through a compare-and-swap loop.
 //
 //
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -46,8 +50,11 @@
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+#  include "TSContention.hh"
+
 #  include <functional>
 #  include <atomic>
+#  include <type_traits>
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
@@ -60,6 +67,18 @@ namespace atomics
     template <typename _Tp>
     using OpFunction = std::function<_Tp(const _Tp&, const _Tp&)>;
     //--------------------------------------------------------------------//
+    // whether std::atomic<_Tp> has a native fetch_add/fetch_sub
+    template <typename _Tp>
+    struct has_fetch_add
+    {
+      static constexpr bool value =
+        (std::is_integral<_Tp>::value && !std::is_same<_Tp, bool>::value)
+#  if defined(__cpp_lib_atomic_float)
+        || std::is_floating_point<_Tp>::value
+#  endif
+        ;
+    };
+    //--------------------------------------------------------------------//
     template <typename _Tp>
     inline void do_fetch_and_store(std::atomic<_Tp>* _atomic, const _Tp& _value,
                                    std::memory_order mem_odr)
@@ -81,12 +100,13 @@ namespace atomics
                                     const OpFunction<_Tp>& _operator,
                                     std::memory_order mem_odr)
     {
-      _Tp _expected = _Tp();
-      do
+      _Tp _expected = _atomic->load();
+      // a failed exchange reloads _expected
+      while(!(_atomic->compare_exchange_weak(
+        _expected, _operator(_expected, _value), mem_odr)))
       {
-        _expected = _atomic->load();
-      } while(!(_atomic->compare_exchange_weak(
-        _expected, _operator(_expected, _value), mem_odr)));
+        TS_CONTENTION_ADD(kCasRetries, 1);
+      }
     }
     //--------------------------------------------------------------------//
     template <typename _Tp>
@@ -95,12 +115,13 @@ namespace atomics
                                     const OpFunction<_Tp>& _operator,
                                     std::memory_order mem_odr)
     {
-      _Tp _expected = _Tp();
-      do
+      _Tp _expected = _atomic->load();
+      // a failed exchange reloads _expected
+      while(!(_atomic->compare_exchange_weak(
+        _expected, _operator(_expected, _atomic_value.load()), mem_odr)))
       {
-        _expected = _atomic->load();
-      } while(!(_atomic->compare_exchange_weak(
-        _expected, _operator(_expected, _atomic_value.load()), mem_odr)));
+        TS_CONTENTION_ADD(kCasRetries, 1);
+      }
     }
     //--------------------------------------------------------------------//
   }  // namespace details
@@ -127,20 +148,26 @@ namespace atomics
   inline void increment(std::atomic<T>* _atomic, const T& _increment,
                         std::memory_order mem_odr)
   {
-    details::do_compare_and_swap(
-      _atomic, _increment,
-      details::OpFunction<T>([](const T& x, const T& y) { return x + y; }),
-      mem_odr);
+    if constexpr(details::has_fetch_add<T>::value)
+      _atomic->fetch_add(_increment, mem_odr);
+    else
+      details::do_compare_and_swap(
+        _atomic, _increment,
+        details::OpFunction<T>([](const T& x, const T& y) { return x + y; }),
+        mem_odr);
   }
   //------------------------------------------------------------------------//
   template <typename T>
   inline void decrement(std::atomic<T>* _atomic, const T& _decrement,
                         std::memory_order mem_odr)
   {
-    details::do_compare_and_swap(
-      _atomic, _decrement,
-      details::OpFunction<T>([](const T& x, const T& y) { return x - y; }),
-      mem_odr);
+    if constexpr(details::has_fetch_add<T>::value)
+      _atomic->fetch_sub(_decrement, mem_odr);
+    else
+      details::do_compare_and_swap(
+        _atomic, _decrement,
+        details::OpFunction<T>([](const T& x, const T& y) { return x - y; }),
+        mem_odr);
   }
   //------------------------------------------------------------------------//
   template <typename T>
@@ -189,10 +216,13 @@ namespace atomics
                         const std::atomic<T>& _atomic_increment,
                         std::memory_order mem_odr)
   {
-    details::do_compare_and_swap(
-      _atomic, _atomic_increment,
-      details::OpFunction<T>([](const T& x, const T& y) { return x + y; }),
-      mem_odr);
+    if constexpr(details::has_fetch_add<T>::value)
+      _atomic->fetch_add(_atomic_increment.load(), mem_odr);
+    else
+      details::do_compare_and_swap(
+        _atomic, _atomic_increment,
+        details::OpFunction<T>([](const T& x, const T& y) { return x + y; }),
+        mem_odr);
   }
   //------------------------------------------------------------------------//
   template <typename T>
@@ -200,10 +230,13 @@ namespace atomics
                         const std::atomic<T>& _atomic_decrement,
                         std::memory_order mem_odr)
   {
-    details::do_compare_and_swap(
-      _atomic, _atomic_decrement,
-      details::OpFunction<T>([](const T& x, const T& y) { return x - y; }),
-      mem_odr);
+    if constexpr(details::has_fetch_add<T>::value)
+      _atomic->fetch_sub(_atomic_decrement.load(), mem_odr);
+    else
+      details::do_compare_and_swap(
+        _atomic, _atomic_decrement,
+        details::OpFunction<T>([](const T& x, const T& y) { return x - y; }),
+        mem_odr);
   }
   //------------------------------------------------------------------------//
   template <typename T>
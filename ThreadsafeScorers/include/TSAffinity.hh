@@ -0,0 +1,99 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file parallel/ThreadsafeScorers/include/TSAffinity.hh
+/// \brief Definition of the TSAffinity class
+//
+//
+//
+//
+/// TSAffinity pins the worker threads to CPUs following the policy of the
+///     TS_AFFINITY environment variable:
+///         none     (default) the threads float over the allowed CPUs
+///         compact  thread i on the i-th CPU, sockets filled one at a time
+///                  (hyper-thread siblings next to each other)
+///         scatter  thread i on socket i % (# of sockets), spreading the
+///                  threads evenly over the sockets
+///     The topology is read from /sys/devices/system/cpu on Linux, within
+///     the CPUs the process is allowed to run on; elsewhere there is a
+///     single socket and Pin() does nothing.
+/// TS_AFFINITY is only read when configured with TS_NUMA_EXPERIMENTAL=ON,
+///     which defines TS_NUMA; otherwise the policy is always none.
+/// Pinning happens when the worker builds its user actions, i.e. before it
+///     allocates its thread-local scorers, so these are first touched (and
+///     placed in memory) on the socket of their owning thread.
+/// GetSocket() is the socket of the calling thread, used by TSRun to pick
+///     the per-socket shard of the global atomic scores.
+/// Each pinned thread is reported to G4cout, unless SetVerbose(false), e.g.
+///     in ts_scorers_bench, whose results may go to stdout.
+//
+//
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#ifndef tsaffinity_hh
+#define tsaffinity_hh 1
+
+#include "globals.hh"
+
+#include <vector>
+
+class TSAffinity
+{
+ public:
+  enum Policy
+  {
+    kNone,
+    kCompact,
+    kScatter
+  };
+
+ public:
+  static Policy GetPolicy();
+  // pin the calling thread by the policy, returns the CPU or -1 if unpinned
+  static G4int Pin(G4int thread);
+  // socket of the calling thread
+  static G4int GetSocket();
+  static G4int GetNumberOfSockets();
+  // report the pinned threads (default), set before the threads start
+  static void SetVerbose(G4bool val) { fVerbose = val; }
+
+ private:
+  struct Cpu
+  {
+    G4int fId;
+    G4int fSocket;
+    G4int fCore;
+  };
+
+  // allowed CPUs ordered by socket, core and id
+  static const std::vector<Cpu>& GetCpus();
+
+ private:
+  static G4ThreadLocal G4int fSocket;
+  static G4bool fVerbose;
+};
+
+#endif
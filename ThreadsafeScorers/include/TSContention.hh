@@ -0,0 +1,198 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file parallel/ThreadsafeScorers/include/TSContention.hh
+/// \brief Definition of the TSContention class
+//
+//
+//
+//
+/// TSContention holds per-thread counters of the synchronization done by
+///     the scorers: lock acquisitions, how many of them found the lock
+///     taken and how long they waited, how long the locks were held,
+///     compare-and-swap retries, new keys inserted in the run-level maps,
+///     and the bytes summed when merging the thread-local containers.
+/// The counters only exist when the example is configured with
+///     -DTS_CONTENTION_COUNTERS=ON, which defines TS_CONTENTION. Otherwise
+///     the TS_CONTENTION_* macros below expand to nothing (or to a plain
+///     G4AutoLock), so the hot paths are the same as without them.
+/// Each thread adds to its own counters, registered at its first use,
+///     with relaxed loads and stores only. Report() prints them per thread
+///     and summed, and resets them; the master TSRunAction calls it at the
+///     end of each run, once the workers are done.
+//
+//
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#ifndef tscontention_hh
+#define tscontention_hh 1
+
+#include "globals.hh"
+#include "G4AutoLock.hh"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#if defined(TS_CONTENTION)
+#  define TS_CONTENTION_LOCK(name, mutex) TSContention::AutoLock name(mutex)
+#  define TS_CONTENTION_ADD(counter, n)                                       \
+    TSContention::Add(TSContention::counter, n)
+#  define TS_CONTENTION_INSERTIONS(name, container)                           \
+    TSContention::Insertions name(container)
+#else
+#  define TS_CONTENTION_LOCK(name, mutex) G4AutoLock name(mutex)
+#  define TS_CONTENTION_ADD(counter, n)
+#  define TS_CONTENTION_INSERTIONS(name, container)
+#endif
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+class TSContention
+{
+ public:
+  enum Counter
+  {
+    kLocks,        // lock acquisitions
+    kLockWaits,    // acquisitions that found the lock taken
+    kLockWaitNs,   // time spent waiting for the lock
+    kLockHoldNs,   // time from acquisition to release
+    kCasRetries,   // failed compare-and-swap
+    kInsertions,   // new keys in the run-level maps
+    kBytesMerged,  // bytes of the containers summed in the merge
+    kCounters
+  };
+
+  struct Counters_t
+  {
+    G4int fThread = -1;
+    std::atomic<std::uint64_t> fValues[kCounters] = {};
+  };
+
+#if defined(TS_CONTENTION)
+  static constexpr G4bool Enabled = true;
+#else
+  static constexpr G4bool Enabled = false;
+#endif
+
+ public:
+  // counters of the calling thread
+  static inline Counters_t& Local()
+  {
+    if(!fLocal)
+      fLocal = Register();
+    return *fLocal;
+  }
+
+  static inline void Add(Counter counter, std::uint64_t n)
+  {
+    // only the owning thread writes its counters
+    auto& value = Local().fValues[counter];
+    value.store(value.load(std::memory_order_relaxed) + n,
+                std::memory_order_relaxed);
+  }
+
+  // print the counters of every thread and their sum, then reset them
+  static void Report(std::ostream&);
+  static void Reset();
+
+ public:
+  typedef std::chrono::steady_clock Clock_t;
+
+  static inline std::uint64_t Nanoseconds(Clock_t::duration elapsed)
+  {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)
+      .count();
+  }
+
+  // G4AutoLock counting the acquisitions, the waits and the hold time.
+  // The uncontended path only reads the clock once the lock is taken.
+  class AutoLock
+  {
+   public:
+    explicit AutoLock(G4Mutex* mutex)
+      : fMutex(mutex)
+    {
+      if(!fMutex->try_lock())
+      {
+        auto start = Clock_t::now();
+        fMutex->lock();
+        Add(kLockWaits, 1);
+        Add(kLockWaitNs, Nanoseconds(Clock_t::now() - start));
+      }
+      Add(kLocks, 1);
+      fStart = Clock_t::now();
+    }
+
+    ~AutoLock()
+    {
+      Add(kLockHoldNs, Nanoseconds(Clock_t::now() - fStart));
+      fMutex->unlock();
+    }
+
+    AutoLock(const AutoLock&) = delete;
+    AutoLock& operator=(const AutoLock&) = delete;
+
+   private:
+    G4Mutex* fMutex;
+    Clock_t::time_point fStart;
+  };
+
+  // counts the entries added to a container within its scope
+  template <typename _Tp>
+  class Insertions
+  {
+   public:
+    explicit Insertions(const _Tp& container)
+      : fContainer(container)
+      , fSize(container.size())
+    {}
+
+    ~Insertions()
+    {
+      if(fContainer.size() > fSize)
+        Add(kInsertions, fContainer.size() - fSize);
+    }
+
+    Insertions(const Insertions&) = delete;
+    Insertions& operator=(const Insertions&) = delete;
+
+   private:
+    const _Tp& fContainer;
+    size_t fSize;
+  };
+
+ private:
+  static Counters_t* Register();
+
+ private:
+  static G4ThreadLocal Counters_t* fLocal;
+};
+
+#endif
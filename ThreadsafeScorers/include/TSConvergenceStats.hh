@@ -0,0 +1,158 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file parallel/ThreadsafeScorers/include/TSConvergenceStats.hh
+/// \brief Definition of the TSConvergenceStats class
+//
+//
+//
+//
+/// TSConvergenceStats is a mergeable replacement of G4ConvergenceTester for
+///     thread-local scoring. G4ConvergenceTester keeps every score and
+///     cannot be summed, so TSRun used to feed one global instance per
+///     section under a mutex at every event. This class keeps instead:
+///     (1) the count, mean and central moments 2-4 of the scores, updated
+///         per score (Welford) and merged between threads (Chan/Pebay);
+///     (2) the tally fluctuation chart: cumulative moments every fBatch
+///         scores, with fBatch doubling to keep 16 to 32 snapshots; merged
+///         charts are summed point by point at the same fraction of each
+///         thread's scores;
+///     (3) the largest scores (up to LargestCapacity per instance), for the
+///         slope of the high-score tail.
+/// The chart and the largest scores take up to 10 kB per instance, so their
+///     memory is shared out of a budget per thread with SetBudget: with many
+///     instances fewer of the largest scores are kept, and with too many
+///     neither is, only the moments (about 150 bytes per instance), and
+///     ShowResult skips the statistical checks.
+/// ShowResult prints the same diagnostics as G4ConvergenceTester: mean,
+///     variance, relative error, shift, variance of the variance, figure of
+///     merit, the effect of the largest score happening once more, and the
+///     ten statistical checks of the chart and of the tail slope.
+/// Note the chart of merged instances is an approximation of the one of a
+///     single sequence of histories, at a resolution of 1/16 of each
+///     thread's scores, and that the slope is fitted to the largest 5% of
+///     the non-zero scores, or the largest LargestCapacity of them per
+///     thread, whichever is smaller.
+//
+//
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#ifndef tsconvergencestats_hh
+#define tsconvergencestats_hh 1
+
+#include "globals.hh"
+#include "G4Timer.hh"
+
+#include <istream>
+#include <ostream>
+#include <vector>
+
+class TSConvergenceStats
+{
+ public:
+  // number of points of the tally fluctuation chart
+  static constexpr G4int HistoryPoints = 16;
+  // largest scores kept per instance, at most
+  static constexpr size_t LargestCapacity = 1000;
+  // fewest largest scores the slope is fitted to
+  static constexpr size_t SmallestTail = 20;
+
+ public:
+  TSConvergenceStats();
+  ~TSConvergenceStats() = default;
+
+  // add a score
+  void AddScore(G4double);
+  TSConvergenceStats& operator+=(const G4double& val)
+  {
+    AddScore(val);
+    return *this;
+  }
+  // merge another instance, e.g. from another thread
+  TSConvergenceStats& operator+=(const TSConvergenceStats&);
+
+  void ShowResult(std::ostream&) const;
+
+  // binary state, for TSSnapshot
+  void Write(std::ostream&) const;
+  void Read(std::istream&);
+
+  G4long GetEntries() const { return static_cast<G4long>(fMoments.n); }
+  G4double GetMean() const { return fMoments.mean; }
+  G4double GetVariance() const { return fMoments.Variance(); }
+  G4double GetR() const { return fMoments.R(); }
+  G4double GetEfficiency() const;
+  // slope of the high-score tail, as in ShowResult
+  G4double GetSlope() const { return Slope(); }
+
+  // event ID reported for the largest score, set per event by TSRun
+  static void SetCurrentEvent(G4int);
+  // start of the timing used for the figure of merit
+  static void StartTimer();
+  // shares bytes for the chart and largest scores among instances; not
+  // thread-safe, called between runs
+  static void SetBudget(G4double bytes, size_t instances);
+  // largest scores kept per instance, 0 if neither they nor the chart are
+  static size_t GetTailCapacity() { return fTailCapacity; }
+  // memory of the chart and of tail largest scores of an instance, at most
+  static size_t DetailBytes(size_t tail);
+
+ private:
+  struct Moments
+  {
+    G4double n    = 0.0;
+    G4double mean = 0.0;
+    G4double m2   = 0.0;
+    G4double m3   = 0.0;
+    G4double m4   = 0.0;
+
+    void Add(G4double);
+    void Merge(const Moments&);
+    G4double Variance() const;
+    G4double R() const;
+    G4double Shift() const;
+    G4double VOV() const;
+  };
+
+  std::vector<Moments> Chart() const;
+  G4double Slope() const;
+
+ private:
+  Moments fMoments;
+  G4long fNonZero    = 0;
+  G4double fLargest  = 0.0;
+  G4int fLargestEvt  = -1;
+  G4long fBatch      = 1;
+  std::vector<Moments> fSnapshots;
+  std::vector<Moments> fMergedChart;
+  std::vector<G4double> fTail;  // min-heap
+
+  static G4ThreadLocal G4int fCurrentEvent;
+  static G4Timer fTimer;
+  static size_t fTailCapacity;
+};
+
+#endif
@@ -46,6 +46,19 @@
 ///     The energy deposit is to (possibly) show the round-off error seen
 ///     with thread-local hits maps. The # of steps scorer is to verify
 ///     the thread-safe and thread-local hits maps provide the same results.
+/// The number of sections per dimension is read from TS_TARGET_SECTIONS
+///     (default = 5). Each section is a separate placement by default; with
+///     TS_VOXEL_GEOMETRY=ON the sections are instead the voxels of a single
+///     G4PhantomParameterisation navigated with G4RegularNavigation, which
+///     keeps construction and navigation cheap for grids of millions of
+///     sections (e.g. 200 x 200 x 200). The scoring index is the voxel
+///     index in both cases.
+/// The steps are limited to a tenth of a section so that the scores land in
+///     the right section. With TS_TRACK_LENGTH_SCORING=ON (which implies
+///     TS_VOXEL_GEOMETRY) there is no step limit, the navigation skips the
+///     voxel boundaries between equal materials, and the TSPSVoxelTraversal
+///     scorers split the energy deposit and track length of each step over
+///     the voxels it crosses, which also adds a "TrackLength" scorer.
 //
 //
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -60,6 +73,7 @@
 
 #include <map>
 #include <set>
+#include <vector>
 
 class G4Box;
 class G4Tubs;
@@ -67,6 +81,7 @@ class G4Sphere;
 class G4LogicalVolume;
 class G4VPhysicalVolume;
 class G4Material;
+class G4UserLimits;
 
 class TSDetectorConstruction : public G4VUserDetectorConstruction
 {
@@ -88,6 +103,7 @@ class TSDetectorConstruction : public G4VUserDetectorConstruction
     return fScoringVolumes;
   }
   inline const G4String& GetMFDName() const { return fMfdName; }
+  inline G4bool IsTrackLengthScoring() const { return fTrackLengthScoring; }
   inline G4int GetTotalTargets() const
   {
     return fTargetSections.x() * fTargetSections.y() * fTargetSections.z();
@@ -96,6 +112,7 @@ class TSDetectorConstruction : public G4VUserDetectorConstruction
  protected:
   virtual MaterialCollection_t ConstructMaterials();
   virtual G4VPhysicalVolume* ConstructWorld(const MaterialCollection_t&);
+  virtual void ConstructVoxels(const MaterialCollection_t&, G4UserLimits*);
   virtual void ConstructSDandField();
 
  private:
@@ -109,6 +126,9 @@ class TSDetectorConstruction : public G4VUserDetectorConstruction
   G4ThreeVector fTargetDim;
   G4ThreeVector fTargetSections;
   G4String fMfdName;
+  G4bool fVoxelGeometry;
+  G4bool fTrackLengthScoring;
+  std::vector<size_t> fMaterialIndices;
 };
 
 #endif
@@ -0,0 +1,111 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file parallel/ThreadsafeScorers/include/TSPSVoxelTraversal.hh
+/// \brief Definition of the TSPSVoxelTraversal class
+//
+//
+//
+//
+/// TSPSVoxelTraversal is a primitive scorer for the voxels of the
+///     G4PhantomParameterisation target (see TSDetectorConstruction) that
+///     does not need the steps to end at every voxel boundary. The chord
+///     of each step, from the pre- to the post-step point, is followed
+///     through the voxel grid (Amanatides & Woo traversal) starting from
+///     the voxel of the pre-step point, and the score is split over the
+///     voxels crossed in proportion to the length of the chord in each.
+/// Two quantities are scored:
+///     kEnergyDeposit  the total energy deposit of the step. Neutral
+///                     particles have no continuous loss, so their deposit
+///                     is local to the post-step point and goes to the
+///                     last voxel only
+///     kTrackLength    the step length, i.e. the true path length, so the
+///                     multiple scattering of charged particles is
+///                     apportioned along the chord
+/// Both are weighted with the pre-step point weight, as G4PSEnergyDeposit
+///     and G4PSTrackLength.
+/// With this scorer the voxels of equal material are skipped by the
+///     navigation and the G4StepLimiter is not used (TS_TRACK_LENGTH_SCORING
+///     in TSDetectorConstruction), so a step can cross many voxels.
+//
+//
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#ifndef tspsvoxeltraversal_hh
+#define tspsvoxeltraversal_hh 1
+
+#include "globals.hh"
+#include "G4VPrimitiveScorer.hh"
+#include "G4THitsMap.hh"
+#include "G4ThreeVector.hh"
+
+#include <utility>
+#include <vector>
+
+class TSPSVoxelTraversal : public G4VPrimitiveScorer
+{
+ public:
+  enum Quantity
+  {
+    kEnergyDeposit,
+    kTrackLength
+  };
+
+  // (voxel index, fraction of the chord)
+  typedef std::vector<std::pair<G4int, G4double>> Segments_t;
+
+ public:
+  TSPSVoxelTraversal(const G4String& name, Quantity quantity, G4int nx,
+                     G4int ny, G4int nz, const G4ThreeVector& voxel_size);
+  virtual ~TSPSVoxelTraversal();
+
+ public:
+  virtual void Initialize(G4HCofThisEvent*);
+  virtual void clear();
+  virtual void PrintAll();
+
+  // Fractions of the segment from 'start' to 'end' in each voxel of a grid
+  //  of n[0] x n[1] x n[2] voxels, in crossing order. The points are in
+  //  units of voxels from the low corner of the grid, and the segment
+  //  starts in voxel 'first' (index i + j * nx + k * nx * ny), which is
+  //  trusted over 'start' when the latter is on a voxel face.
+  static void Traverse(const G4int n[3], G4int first,
+                       const G4ThreeVector& start, const G4ThreeVector& end,
+                       Segments_t& segments);
+
+ protected:
+  virtual G4bool ProcessHits(G4Step*, G4TouchableHistory*);
+
+ private:
+  Quantity fQuantity;
+  G4int fNumVoxels[3];
+  G4ThreeVector fVoxelSize;
+  G4int fHCID;
+  G4THitsMap<G4double>* fEvtMap;
+  Segments_t fSegments;
+};
+
+#endif
@@ -46,6 +46,30 @@
 ///     accumulated by the thread-local hits maps and atomic hits maps. The
 ///     differences w.r.t. this hits maps are computed in
 ///     TSRunAction::EndOfRunAction
+/// The thread-local containers of the workers are not summed one worker
+///     at a time in Merge(): Merge() only takes them over, and Reduce() sums
+///     them pairwise on the G4TaskRunManager thread pool, so the reduction
+///     takes log2(# of workers) levels.
+/// The scores can be saved as a TSSnapshot: with TS_SNAPSHOT=<prefix>, the
+///     master writes <prefix>_run<#>.tssnap at the end of each run, and
+///     with TS_CHECKPOINT_EVENTS=<N> each worker also writes its own
+///     <prefix>_run<#>_t<thread>.tssnap every N events. TS_RESUME=<file>
+///     starts the first run from a snapshot.
+/// With TS_SEED set, the master seeds each run with a seed drawn from a job
+///     engine seeded with TS_SEED, which overrides /random/setSeeds and
+///     /random/resetEngineFrom. The snapshots record both seeds and the
+///     state of the job engine, which a resumed job restores, so that it
+///     draws new run seeds instead of replaying the histories of the
+///     snapshot. Without TS_SEED, the master engine is left to the run
+///     manager and the snapshots record its state at the start of the run,
+///     identified by GetEngineId() in place of the run seed.
+/// With TS_COMPENSATED_SUMS=ON, the global atomic scores are kept in a
+///     G4TAtomicHitsArray of G4atomic_compensated, whose sums do not depend
+///     on the order in which the threads add.
+/// With TS_ATOMIC_SHARDS=ON, the global atomic scores are kept in one
+///     G4TAtomicHitsArray per socket (see TSAffinity), allocated by the
+///     first worker of that socket, and summed by Reduce(). This requires
+///     TS_NUMA_EXPERIMENTAL=ON at configuration.
 //
 //
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -60,9 +84,12 @@
 #include "G4Event.hh"
 #include "G4THitsMap.hh"
 #include "G4TAtomicHitsMap.hh"
+#include "G4TAtomicHitsArray.hh"
+#include "G4atomic_compensated.hh"
 #include "G4THitsVector.hh"
 #include "G4StatAnalysis.hh"
-#include "G4ConvergenceTester.hh"
+#include "TSConvergenceStats.hh"
+#include "TSSnapshot.hh"
 
 #include <vector>
 
@@ -77,6 +104,8 @@ class TSRun : public G4Run
 {
  public:
   typedef std::map<G4int, G4double> MutexHitsMap_t;
+  typedef G4TAtomicHitsArray<G4double, G4atomic_compensated<G4double>>
+    CompensatedHitsArray_t;
 
  public:
   TSRun(const G4String&);
@@ -90,22 +119,63 @@ class TSRun : public G4Run
   // - Get HitsMap of this RUN.
   G4THitsMap<G4double>* GetHitsMap(const G4String& collname) const;
   G4TAtomicHitsMap<G4double>* GetAtomicHitsMap(const G4String&) const;
+  G4TAtomicHitsArray<G4double>* GetAtomicHitsArray(const G4String&) const;
+  CompensatedHitsArray_t* GetCompensatedHitsArray(const G4String&) const;
   MutexHitsMap_t* GetMutexHitsMap(const G4String&) const;
   G4StatContainer<G4StatAnalysis>* GetStatMap(const G4String& collname) const;
-  G4StatContainer<G4ConvergenceTester>* GetConvMap(const G4String&) const;
+  G4StatContainer<TSConvergenceStats>* GetConvMap(const G4String&) const;
 
   void ConstructMFD(const G4String&);
 
   virtual void Merge(const G4Run*);
+  // sum the worker containers taken over in Merge() (master only)
+  void Reduce() const;
+
+  // copy of the scores of this run
+  TSSnapshot GetSnapshot() const;
+  // add a snapshot to the scores of this run (master only)
+  void AddSnapshot(const TSSnapshot&);
+  // write the snapshot of the end of the run, if TS_SNAPSHOT is set
+  void WriteSnapshot() const;
+
+  // TS_SEED, the seed of the job, 0 if the engine is not reseeded
+  static G4long GetJobSeed();
+  // run identifier of an engine state, when the engine is not reseeded
+  static G4long GetEngineId(const std::vector<unsigned long>&);
+
+ private:
+  struct Partial_t
+  {
+    std::vector<G4THitsMap<G4double>*> fRunMaps;
+    std::vector<G4StatContainer<G4StatAnalysis>*> fStatMaps;
+    std::vector<G4StatContainer<TSConvergenceStats>*> fConvMaps;
+  };
+
+  static void Add(Partial_t&, const Partial_t&, size_t);
+  static void Delete(Partial_t&);
+  G4String GetSnapshotPath(G4int) const;
 
  private:
   std::vector<G4String> fCollNames;
   std::vector<G4int> fCollIDs;
   std::vector<G4THitsMap<G4double>*> fRunMaps;
   std::vector<G4StatContainer<G4StatAnalysis>*> fStatMaps;
+  std::vector<G4StatContainer<TSConvergenceStats>*> fConvMaps;
+  mutable std::vector<Partial_t> fPartials;
   static std::vector<G4TAtomicHitsMap<G4double>*> fAtomicRunMaps;
+  static std::vector<G4TAtomicHitsArray<G4double>*> fAtomicRunArrays;
+  static std::vector<CompensatedHitsArray_t*> fCompensatedRunArrays;
+  // [collection][socket]
+  static std::vector<std::vector<G4TAtomicHitsArray<G4double>*>> fAtomicShards;
+  // shards of the socket of this worker
+  std::vector<G4TAtomicHitsArray<G4double>*> fShards;
   static std::map<G4String, MutexHitsMap_t> fMutexRunMaps;
-  static std::vector<G4StatContainer<G4ConvergenceTester>*> fConvMaps;
+  // sources of the snapshot this run started from
+  std::vector<TSSnapshot::Source_t> fResumedSources;
+  // seed of the current run and state of the job engine after drawing it,
+  // set by the master before the workers start
+  static G4long fRunSeed;
+  static std::vector<unsigned long> fEngineState;
 };
 
 #endif
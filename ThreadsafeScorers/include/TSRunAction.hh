@@ -67,6 +67,7 @@ class TSRunAction : public G4UserRunAction
   TSDetectorConstruction* fDetector;
   G4String fName;
   TypeCompare_t fTypeCompare;
+  G4Timer* fTimer;
 };
 
 #endif
@@ -0,0 +1,128 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file parallel/ThreadsafeScorers/include/TSSnapshot.hh
+/// \brief Definition of the TSSnapshot class
+//
+//
+//
+//
+/// TSSnapshot is a copy of the scores of a TSRun that can be written to
+///     and read from a binary file, and summed with other snapshots. It is
+///     used to checkpoint the workers during a run, to resume a run from a
+///     previous one and, with ts_scorers_merge, to sum the results of
+///     independent jobs.
+/// Each section (one per primitive scorer) holds the thread-local hits map,
+///     G4StatAnalysis and TSConvergenceStats values, the global atomic and
+///     "mutex" values, keyed by copy number. Summing snapshots uses the
+///     same operations as TSRun::Merge, so summing the snapshots of N jobs
+///     gives the result of one job with the workers of all of them.
+/// The header lists the sources of the histories, i.e. the seed of the job
+///     (TS_SEED), the seed of the run drawn from it and the worker of a
+///     checkpoint, so that summing the same histories twice can be refused
+///     (see Overlaps), and the state of the random engine the job draws the
+///     seeds of its runs from, so that a resumed job continues it.
+/// The file is written in the byte order and with the sizeof of the
+///     G4StatAnalysis of the writing build, which are checked when reading:
+///     G4StatAnalysis has no setters for its sums, so it is stored as its
+///     object representation.
+//
+//
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#ifndef tssnapshot_hh
+#define tssnapshot_hh 1
+
+#include "globals.hh"
+#include "G4StatAnalysis.hh"
+#include "TSConvergenceStats.hh"
+
+#include <map>
+#include <vector>
+
+class TSSnapshot
+{
+ public:
+  typedef std::map<G4int, G4double> ValueMap_t;
+
+  struct Section_t
+  {
+    G4String fName;
+    ValueMap_t fRunValues;
+    std::map<G4int, G4StatAnalysis> fStats;
+    std::map<G4int, TSConvergenceStats> fConv;
+    ValueMap_t fAtomicValues;
+    ValueMap_t fMutexValues;
+
+    Section_t& operator+=(const Section_t&);
+  };
+
+  struct Source_t
+  {
+    G4long fJobSeed = 0;
+    G4long fRunSeed = 0;
+    // worker of a checkpoint, -1 for all the workers of the run
+    G4int fThread = -1;
+  };
+
+ public:
+  TSSnapshot() = default;
+  ~TSSnapshot() = default;
+
+  // write to a temporary file renamed to the path on success
+  G4bool Write(const G4String&) const;
+  // replace the contents with those of the file, false on failure
+  G4bool Read(const G4String&);
+
+  // sum the sections with the same name, append the others; the engine
+  // state is kept only if both snapshots have the same
+  TSSnapshot& operator+=(const TSSnapshot&);
+  // true if both hold histories of the same run and worker
+  G4bool Overlaps(const TSSnapshot&) const;
+
+  Section_t& GetSection(const G4String&);
+  const std::vector<Section_t>& GetSections() const { return fSections; }
+  G4long GetNumberOfEvents() const { return fEvents; }
+  void SetNumberOfEvents(G4long val) { fEvents = val; }
+  const std::vector<Source_t>& GetSources() const { return fSources; }
+  void AddSource(const Source_t& val) { fSources.push_back(val); }
+  const std::vector<unsigned long>& GetEngineState() const
+  {
+    return fEngineState;
+  }
+  void SetEngineState(const std::vector<unsigned long>& val)
+  {
+    fEngineState = val;
+  }
+
+ private:
+  G4long fEvents = 0;
+  std::vector<Source_t> fSources;
+  std::vector<unsigned long> fEngineState;
+  std::vector<Section_t> fSections;
+};
+
+#endif
@@ -31,13 +31,16 @@
 //
 /// Standard ActionInitialization class creating a RunAction instance for the
 ///     master thread and RunAction and PrimaryGeneratorAction instances for
-///     the worker threads
+///     the worker threads. The worker threads are pinned to CPUs (see
+///     TSAffinity) before their actions, and so their thread-local scorers,
+///     are allocated.
 //
 //
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 #include "TSActionInitialization.hh"
+#include "TSAffinity.hh"
 #include "TSDetectorConstruction.hh"
 #include "TSPrimaryGeneratorAction.hh"
 #include "TSRunAction.hh"
@@ -72,6 +75,9 @@ void TSActionInitialization::BuildForMaster() const
 
 void TSActionInitialization::Build() const
 {
+  if(G4Threading::IsWorkerThread())
+    TSAffinity::Pin(G4Threading::G4GetThreadId());
+
   SetUserAction(new TSPrimaryGeneratorAction);
   SetUserAction(new TSRunAction);
 }
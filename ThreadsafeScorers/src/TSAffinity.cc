@@ -0,0 +1,216 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file parallel/ThreadsafeScorers/src/TSAffinity.cc
+/// \brief Implementation of the TSAffinity class
+//
+//
+//
+//
+/// See TSAffinity.hh
+//
+//
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#include "TSAffinity.hh"
+
+#include "G4EnvironmentUtils.hh"
+#include "G4AutoLock.hh"
+
+#include <algorithm>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <string>
+
+#if defined(__linux__)
+#  include <pthread.h>
+#  include <sched.h>
+#endif
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4ThreadLocal G4int TSAffinity::fSocket = -1;
+G4bool TSAffinity::fVerbose             = true;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+namespace
+{
+  G4int read_topology(G4int cpu, const std::string& name)
+  {
+    std::stringstream ss;
+    ss << "/sys/devices/system/cpu/cpu" << cpu << "/topology/" << name;
+    std::ifstream ifs(ss.str());
+    G4int value = 0;
+    if(!(ifs >> value))
+      return 0;
+    return value;
+  }
+}  // namespace
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+TSAffinity::Policy TSAffinity::GetPolicy()
+{
+  static Policy policy = []() {
+#if defined(TS_NUMA)
+    std::string value = G4GetEnv<std::string>(
+      "TS_AFFINITY", "none", "Worker thread affinity: none, compact, scatter");
+    if(value == "compact")
+      return kCompact;
+    if(value == "scatter")
+      return kScatter;
+    if(value != "none")
+      G4Exception("TSAffinity", "TS_AFFINITY", JustWarning,
+                  G4String("unknown policy " + value + ", using none").c_str());
+#endif
+    return kNone;
+  }();
+  return policy;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+const std::vector<TSAffinity::Cpu>& TSAffinity::GetCpus()
+{
+  static std::vector<Cpu> cpus = []() {
+    std::vector<Cpu> value;
+#if defined(__linux__)
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    if(sched_getaffinity(0, sizeof(mask), &mask) == 0)
+    {
+      for(G4int i = 0; i < CPU_SETSIZE; ++i)
+        if(CPU_ISSET(i, &mask))
+          value.push_back({ i, read_topology(i, "physical_package_id"),
+                            read_topology(i, "core_id") });
+    }
+#endif
+    std::sort(value.begin(), value.end(), [](const Cpu& lhs, const Cpu& rhs) {
+      if(lhs.fSocket != rhs.fSocket)
+        return lhs.fSocket < rhs.fSocket;
+      if(lhs.fCore != rhs.fCore)
+        return lhs.fCore < rhs.fCore;
+      return lhs.fId < rhs.fId;
+    });
+    return value;
+  }();
+  return cpus;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int TSAffinity::GetNumberOfSockets()
+{
+  static G4int nsockets = []() {
+    std::set<G4int> sockets;
+    for(const auto& itr : GetCpus())
+      sockets.insert(itr.fSocket);
+    return std::max<G4int>(1, sockets.size());
+  }();
+  return nsockets;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int TSAffinity::Pin(G4int thread)
+{
+  const auto& cpus = GetCpus();
+  Policy policy    = GetPolicy();
+  if(policy == kNone || cpus.empty() || thread < 0)
+    return -1;
+
+  // socket indices are dense in [0, # of sockets) below, whatever the ids
+  std::vector<std::vector<Cpu>> sockets;
+  for(const auto& itr : cpus)
+  {
+    if(sockets.empty() || sockets.back().front().fSocket != itr.fSocket)
+      sockets.push_back({});
+    sockets.back().push_back(itr);
+  }
+
+  G4int socket = 0;
+  Cpu cpu      = cpus.at(thread % cpus.size());
+  if(policy == kCompact)
+  {
+    for(socket = 0; sockets.at(socket).front().fSocket != cpu.fSocket;)
+      ++socket;
+  }
+  else
+  {
+    socket                  = thread % sockets.size();
+    const auto& socket_cpus = sockets.at(socket);
+    cpu = socket_cpus.at((thread / sockets.size()) % socket_cpus.size());
+  }
+
+#if defined(__linux__)
+  cpu_set_t mask;
+  CPU_ZERO(&mask);
+  CPU_SET(cpu.fId, &mask);
+  if(pthread_setaffinity_np(pthread_self(), sizeof(mask), &mask) != 0)
+    return -1;
+#endif
+
+  fSocket = socket;
+  if(!fVerbose)
+    return cpu.fId;
+
+  static G4Mutex mtx = G4MUTEX_INITIALIZER;
+  G4AutoLock lock(&mtx);
+  G4cout << "TSAffinity: thread " << thread << " pinned to CPU " << cpu.fId
+         << " (socket " << socket << ")" << G4endl;
+  return cpu.fId;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int TSAffinity::GetSocket()
+{
+  if(fSocket >= 0)
+    return fSocket;
+
+#if defined(__linux__)
+  // unpinned thread: socket of the CPU it currently runs on
+  G4int id      = sched_getcpu();
+  G4int socket  = 0;
+  G4int current = -1;
+  for(const auto& itr : GetCpus())
+  {
+    if(itr.fSocket != current)
+    {
+      if(current >= 0)
+        ++socket;
+      current = itr.fSocket;
+    }
+    if(itr.fId == id)
+      return socket;
+  }
+#endif
+  return 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,134 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file parallel/ThreadsafeScorers/src/TSContention.cc
+/// \brief Implementation of the TSContention class
+//
+//
+//
+//
+/// The counters of the threads live in a std::deque, which never moves its
+///     elements, so each thread keeps a pointer to its own entry for the
+///     life of the process, including the threads that have exited.
+//
+//
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#include "TSContention.hh"
+
+#include "G4Threading.hh"
+
+#include <deque>
+#include <iomanip>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4ThreadLocal TSContention::Counters_t* TSContention::fLocal = nullptr;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+namespace
+{
+  G4Mutex& registry_mutex()
+  {
+    static G4Mutex mtx = G4MUTEX_INITIALIZER;
+    return mtx;
+  }
+
+  std::deque<TSContention::Counters_t>& registry()
+  {
+    static std::deque<TSContention::Counters_t> counters;
+    return counters;
+  }
+}  // namespace
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+TSContention::Counters_t* TSContention::Register()
+{
+  G4AutoLock lock(&registry_mutex());
+  registry().emplace_back();
+  registry().back().fThread = G4Threading::G4GetThreadId();
+  return &registry().back();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TSContention::Report(std::ostream& os)
+{
+  if(!Enabled)
+    return;
+
+  G4AutoLock lock(&registry_mutex());
+
+  auto print = [&os](const G4String& label, const std::uint64_t* values) {
+    os << "    " << std::setw(8) << label << std::setw(12) << values[kLocks]
+       << std::setw(10) << values[kLockWaits] << std::setw(12)
+       << values[kLockWaitNs] * 1.0e-6 << std::setw(12)
+       << values[kLockHoldNs] * 1.0e-6 << std::setw(12)
+       << values[kCasRetries] << std::setw(12) << values[kInsertions]
+       << std::setw(14) << values[kBytesMerged] / 1024.0 << "\n";
+  };
+
+  os << "TSContention: scorer synchronization of this run\n"
+     << "    " << std::setw(8) << "thread" << std::setw(12) << "locks"
+     << std::setw(10) << "waited" << std::setw(12) << "wait [ms]"
+     << std::setw(12) << "hold [ms]" << std::setw(12) << "CAS retries"
+     << std::setw(12) << "insertions" << std::setw(14) << "merged [kB]"
+     << "\n";
+  os << std::setprecision(4);
+
+  std::uint64_t total[kCounters] = {};
+  for(auto& itr : registry())
+  {
+    std::uint64_t values[kCounters] = {};
+    G4bool any                      = false;
+    for(G4int i = 0; i < kCounters; ++i)
+    {
+      values[i] = itr.fValues[i].exchange(0, std::memory_order_relaxed);
+      total[i] += values[i];
+      any = any || values[i] > 0;
+    }
+    if(any)
+      print((itr.fThread < 0) ? G4String("master")
+                              : G4String(std::to_string(itr.fThread)),
+            values);
+  }
+  print("total", total);
+  os << std::flush;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TSContention::Reset()
+{
+  G4AutoLock lock(&registry_mutex());
+  for(auto& itr : registry())
+    for(auto& value : itr.fValues)
+      value.store(0, std::memory_order_relaxed);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
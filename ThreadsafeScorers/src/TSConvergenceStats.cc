@@ -0,0 +1,562 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file parallel/ThreadsafeScorers/src/TSConvergenceStats.cc
+/// \brief Implementation of the TSConvergenceStats class
+//
+//
+//
+//
+/// See TSConvergenceStats.hh. The statistics follow G4ConvergenceTester
+///     (and the MCNP statistical checks it implements):
+///     R     = sd / (mean * sqrt(N))
+///     SHIFT = sum((x - mean)^3) / (2 * var * N)
+///     VOV   = sum((x - mean)^4) / sum((x - mean)^2)^2 - 1 / N
+///     FOM   = 1 / (R^2 * T), T the user time of the process in seconds
+///     SLOPE = 1 + 1 / k, k the shape of a generalized Pareto distribution
+///             fitted to the largest scores by maximum likelihood
+//
+//
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#include "TSConvergenceStats.hh"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <functional>
+#include <iomanip>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4ThreadLocal G4int TSConvergenceStats::fCurrentEvent = -1;
+G4Timer TSConvergenceStats::fTimer;
+size_t TSConvergenceStats::fTailCapacity = TSConvergenceStats::LargestCapacity;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TSConvergenceStats::Moments::Add(G4double x)
+{
+  G4double n1      = n;
+  n                = n1 + 1.0;
+  G4double delta   = x - mean;
+  G4double delta_n = delta / n;
+  G4double d_n2    = delta_n * delta_n;
+  G4double term1   = delta * delta_n * n1;
+  mean += delta_n;
+  m4 += term1 * d_n2 * (n * n - 3.0 * n + 3.0) + 6.0 * d_n2 * m2 -
+        4.0 * delta_n * m3;
+  m3 += term1 * delta_n * (n - 2.0) - 3.0 * delta_n * m2;
+  m2 += term1;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TSConvergenceStats::Moments::Merge(const Moments& rhs)
+{
+  if(rhs.n == 0.0)
+    return;
+  if(n == 0.0)
+  {
+    *this = rhs;
+    return;
+  }
+
+  G4double na = n;
+  G4double nb = rhs.n;
+  G4double nt = na + nb;
+  G4double d  = rhs.mean - mean;
+  G4double d2 = d * d;
+
+  G4double m2t = m2 + rhs.m2 + d2 * na * nb / nt;
+  G4double m3t = m3 + rhs.m3 + d2 * d * na * nb * (na - nb) / (nt * nt) +
+                 3.0 * d * (na * rhs.m2 - nb * m2) / nt;
+  G4double m4t = m4 + rhs.m4 +
+                 d2 * d2 * na * nb * (na * na - na * nb + nb * nb) /
+                   (nt * nt * nt) +
+                 6.0 * d2 * (na * na * rhs.m2 + nb * nb * m2) / (nt * nt) +
+                 4.0 * d * (na * rhs.m3 - nb * m3) / nt;
+
+  n    = nt;
+  mean = mean + d * nb / nt;
+  m2   = m2t;
+  m3   = m3t;
+  m4   = m4t;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double TSConvergenceStats::Moments::Variance() const
+{
+  return (n > 1.0) ? m2 / (n - 1.0) : 0.0;
+}
+
+G4double TSConvergenceStats::Moments::R() const
+{
+  return (mean != 0.0 && n > 0.0) ? std::sqrt(Variance() / n) / mean : 0.0;
+}
+
+G4double TSConvergenceStats::Moments::Shift() const
+{
+  G4double var = Variance();
+  return (var > 0.0) ? m3 / (2.0 * var * n) : 0.0;
+}
+
+G4double TSConvergenceStats::Moments::VOV() const
+{
+  return (m2 > 0.0) ? m4 / (m2 * m2) - 1.0 / n : 0.0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+TSConvergenceStats::TSConvergenceStats() {}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TSConvergenceStats::SetCurrentEvent(G4int evt) { fCurrentEvent = evt; }
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TSConvergenceStats::StartTimer() { fTimer.Start(); }
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+size_t TSConvergenceStats::DetailBytes(size_t tail)
+{
+  // up to 2 * HistoryPoints snapshots and HistoryPoints merged points
+  return 3 * HistoryPoints * sizeof(Moments) + tail * sizeof(G4double);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TSConvergenceStats::SetBudget(G4double bytes, size_t instances)
+{
+  G4double share = bytes / std::max<size_t>(instances, 1);
+  G4double tail  = (share - DetailBytes(0)) / sizeof(G4double);
+  fTailCapacity  = (tail < SmallestTail)
+                    ? 0
+                    : std::min<size_t>(LargestCapacity, tail);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TSConvergenceStats::AddScore(G4double x)
+{
+  fMoments.Add(x);
+
+  if(x != 0.0)
+    ++fNonZero;
+  if(fMoments.n == 1.0 || x > fLargest)
+  {
+    fLargest    = x;
+    fLargestEvt = fCurrentEvent;
+  }
+
+  if(fTailCapacity == 0)
+    return;
+
+  // keep the largest scores in a min-heap
+  if(fTail.size() < fTailCapacity)
+  {
+    fTail.push_back(x);
+    std::push_heap(fTail.begin(), fTail.end(), std::greater<G4double>());
+  }
+  else if(x > fTail.front())
+  {
+    std::pop_heap(fTail.begin(), fTail.end(), std::greater<G4double>());
+    fTail.back() = x;
+    std::push_heap(fTail.begin(), fTail.end(), std::greater<G4double>());
+  }
+
+  // chart snapshot every fBatch scores, thinned by two when full
+  if(static_cast<G4long>(fMoments.n) % fBatch == 0)
+  {
+    fSnapshots.push_back(fMoments);
+    if(fSnapshots.size() == 2 * HistoryPoints)
+    {
+      for(size_t i = 0; i < HistoryPoints; ++i)
+        fSnapshots[i] = fSnapshots[2 * i + 1];
+      fSnapshots.resize(HistoryPoints);
+      fBatch *= 2;
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+TSConvergenceStats& TSConvergenceStats::operator+=(
+  const TSConvergenceStats& rhs)
+{
+  if(rhs.fMoments.n == 0.0)
+    return *this;
+
+  // chart points at the same fractions of each instance's scores
+  if(fTailCapacity > 0)
+  {
+    std::vector<Moments> chart = rhs.Chart();
+    if(fMoments.n > 0.0)
+    {
+      std::vector<Moments> mine = Chart();
+      for(G4int i = 0; i < HistoryPoints; ++i)
+        chart[i].Merge(mine[i]);
+    }
+    fMergedChart = chart;
+    fSnapshots.clear();
+  }
+
+  if(fMoments.n == 0.0 || rhs.fLargest > fLargest)
+  {
+    fLargest    = rhs.fLargest;
+    fLargestEvt = rhs.fLargestEvt;
+  }
+  for(auto itr : rhs.fTail)
+  {
+    if(fTailCapacity == 0)
+      break;
+    if(fTail.size() < fTailCapacity)
+    {
+      fTail.push_back(itr);
+      std::push_heap(fTail.begin(), fTail.end(), std::greater<G4double>());
+    }
+    else if(itr > fTail.front())
+    {
+      std::pop_heap(fTail.begin(), fTail.end(), std::greater<G4double>());
+      fTail.back() = itr;
+      std::push_heap(fTail.begin(), fTail.end(), std::greater<G4double>());
+    }
+  }
+
+  fMoments.Merge(rhs.fMoments);
+  fNonZero += rhs.fNonZero;
+  return *this;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TSConvergenceStats::Write(std::ostream& os) const
+{
+  auto write_moments = [&](const std::vector<Moments>& v) {
+    G4long n = v.size();
+    os.write(reinterpret_cast<const char*>(&n), sizeof(n));
+    os.write(reinterpret_cast<const char*>(v.data()), n * sizeof(Moments));
+  };
+
+  os.write(reinterpret_cast<const char*>(&fMoments), sizeof(Moments));
+  os.write(reinterpret_cast<const char*>(&fNonZero), sizeof(fNonZero));
+  os.write(reinterpret_cast<const char*>(&fLargest), sizeof(fLargest));
+  os.write(reinterpret_cast<const char*>(&fLargestEvt), sizeof(fLargestEvt));
+  os.write(reinterpret_cast<const char*>(&fBatch), sizeof(fBatch));
+  write_moments(fSnapshots);
+  write_moments(fMergedChart);
+  G4long n = fTail.size();
+  os.write(reinterpret_cast<const char*>(&n), sizeof(n));
+  os.write(reinterpret_cast<const char*>(fTail.data()),
+           n * sizeof(G4double));
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TSConvergenceStats::Read(std::istream& is)
+{
+  // sizes are bounded by the thinning of the chart and LargestCapacity
+  auto read_size = [&](size_t max) {
+    G4long n = 0;
+    is.read(reinterpret_cast<char*>(&n), sizeof(n));
+    if(n < 0 || static_cast<size_t>(n) > max)
+    {
+      is.setstate(std::ios::failbit);
+      n = 0;
+    }
+    return static_cast<size_t>(n);
+  };
+  auto read_moments = [&](std::vector<Moments>& v) {
+    v.resize(read_size(2 * HistoryPoints));
+    is.read(reinterpret_cast<char*>(v.data()), v.size() * sizeof(Moments));
+  };
+
+  is.read(reinterpret_cast<char*>(&fMoments), sizeof(Moments));
+  is.read(reinterpret_cast<char*>(&fNonZero), sizeof(fNonZero));
+  is.read(reinterpret_cast<char*>(&fLargest), sizeof(fLargest));
+  is.read(reinterpret_cast<char*>(&fLargestEvt), sizeof(fLargestEvt));
+  is.read(reinterpret_cast<char*>(&fBatch), sizeof(fBatch));
+  read_moments(fSnapshots);
+  read_moments(fMergedChart);
+  fTail.resize(read_size(LargestCapacity));
+  is.read(reinterpret_cast<char*>(fTail.data()),
+          fTail.size() * sizeof(G4double));
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double TSConvergenceStats::GetEfficiency() const
+{
+  return (fMoments.n > 0.0) ? fNonZero / fMoments.n : 0.0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::vector<TSConvergenceStats::Moments> TSConvergenceStats::Chart() const
+{
+  if(!fMergedChart.empty())
+    return fMergedChart;
+
+  // snapshot i holds the moments of the first (i + 1) * fBatch scores
+  std::vector<Moments> chart(HistoryPoints);
+  for(G4int k = 0; k < HistoryPoints; ++k)
+  {
+    if(k + 1 == HistoryPoints)
+    {
+      chart[k] = fMoments;
+      continue;
+    }
+    G4double target = (k + 1) * fMoments.n / HistoryPoints;
+    G4long idx      = std::lround(target / fBatch) - 1;
+    if(idx >= 0 && !fSnapshots.empty())
+      chart[k] =
+        fSnapshots[std::min<size_t>(idx, fSnapshots.size() - 1)];
+  }
+  return chart;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double TSConvergenceStats::Slope() const
+{
+  // largest 5% of the non-zero scores
+  std::vector<G4double> tail = fTail;
+  std::sort(tail.begin(), tail.end(), std::greater<G4double>());
+  size_t m = std::min<size_t>(tail.size(), 0.05 * fNonZero);
+  if(m < 20)
+    return 0.0;
+  tail.resize(m);
+
+  // excesses over the smallest of them
+  G4double u     = tail.back();
+  G4double ysum  = 0.0;
+  for(auto& itr : tail)
+  {
+    itr -= u;
+    ysum += itr;
+  }
+  if(ysum <= 0.0)
+    return 10.0;
+
+  // log-likelihood of a generalized Pareto distribution of scale a and
+  // shape k > 0
+  auto loglik = [&](G4double a, G4double k) {
+    G4double sum = 0.0;
+    for(auto y : tail)
+      sum += std::log1p(k * y / a);
+    return -static_cast<G4double>(m) * std::log(a) - (1.0 / k + 1.0) * sum;
+  };
+
+  // golden-section search of the best scale for a given shape
+  auto best_scale = [&](G4double k) {
+    G4double lo = std::log(ysum / m) - 10.0;
+    G4double hi = std::log(ysum / m) + 10.0;
+    const G4double g = 0.5 * (std::sqrt(5.0) - 1.0);
+    for(G4int i = 0; i < 100; ++i)
+    {
+      G4double x1 = hi - g * (hi - lo);
+      G4double x2 = lo + g * (hi - lo);
+      if(loglik(std::exp(x1), k) < loglik(std::exp(x2), k))
+        lo = x1;
+      else
+        hi = x2;
+    }
+    G4double a = std::exp(0.5 * (lo + hi));
+    return std::make_pair(a, loglik(a, k));
+  };
+
+  G4double best_k = 0.0;
+  G4double best_l = -DBL_MAX;
+  for(G4int i = 0; i <= 200; ++i)
+  {
+    G4double k = std::pow(10.0, -3.0 + 4.0 * i / 200.0);
+    G4double l = best_scale(k).second;
+    if(l > best_l)
+    {
+      best_l = l;
+      best_k = k;
+    }
+  }
+
+  return std::min(10.0, 1.0 + 1.0 / best_k);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TSConvergenceStats::ShowResult(std::ostream& out) const
+{
+  fTimer.Stop();
+  G4double time = fTimer.GetUserElapsed();
+
+  auto fom = [&](const Moments& mom, G4double frac) {
+    G4double r = mom.R();
+    return (r != 0.0 && time * frac > 0.0) ? 1.0 / (r * r) / (time * frac)
+                                           : 0.0;
+  };
+
+  G4double mean  = fMoments.mean;
+  G4double var   = fMoments.Variance();
+  G4double r     = fMoments.R();
+  G4double shift = fMoments.Shift();
+  G4double fom0  = fom(fMoments, 1.0);
+
+  // if the largest score happened once more
+  Moments affected = fMoments;
+  affected.Add(fLargest);
+  G4double fom1 = fom(affected, 1.0);
+
+  out << std::setw(20) << "EFFICIENCY = " << std::setw(13) << GetEfficiency()
+      << G4endl;
+  out << std::setw(20) << "MEAN = " << std::setw(13) << mean << G4endl;
+  out << std::setw(20) << "VAR = " << std::setw(13) << var << G4endl;
+  out << std::setw(20) << "SD = " << std::setw(13) << std::sqrt(var)
+      << G4endl;
+  out << std::setw(20) << "R = " << std::setw(13) << r << G4endl;
+  out << std::setw(20) << "SHIFT = " << std::setw(13) << shift << G4endl;
+  out << std::setw(20) << "VOV = " << std::setw(13) << fMoments.VOV()
+      << G4endl;
+  out << std::setw(20) << "FOM = " << std::setw(13) << fom0 << G4endl;
+
+  out << std::setw(20) << "THE LARGEST SCORE = " << std::setw(13) << fLargest
+      << " and it happened at " << fLargestEvt << "th event" << G4endl;
+
+  auto affected_line = [&](const char* name, G4double value,
+                           G4double original) {
+    out << std::setw(20) << name << std::setw(13) << value;
+    if(original != 0.0)
+      out << " and its ratio to original is " << value / original;
+    out << G4endl;
+  };
+  affected_line("Affected Mean = ", affected.mean, mean);
+  affected_line("Affected VAR = ", affected.Variance(), var);
+  affected_line("Affected R = ", affected.R(), r);
+  affected_line("Affected SHIFT = ", affected.Shift(), shift);
+  affected_line("Affected FOM = ", fom1, fom0);
+
+  if(fTailCapacity == 0)
+  {
+    out << "The chart and largest scores are not kept within the memory "
+           "budget, so convergence tests are not done."
+        << G4endl;
+    return;
+  }
+
+  if(fMoments.n < 2 * HistoryPoints)
+  {
+    out << "Number of events of this run is too small to do convergence "
+           "tests."
+        << G4endl;
+    return;
+  }
+
+  // statistical checks over the last half of the chart
+  std::vector<Moments> chart = Chart();
+  std::vector<G4double> logn, means, rs, vovs, foms;
+  for(G4int k = HistoryPoints / 2; k < HistoryPoints; ++k)
+  {
+    const Moments& mom = chart[k];
+    logn.push_back(std::log(std::max(mom.n, 1.0)));
+    means.push_back(mom.mean);
+    rs.push_back(mom.R());
+    vovs.push_back(mom.VOV());
+    foms.push_back(fom(mom, (k + 1.0) / HistoryPoints));
+  }
+
+  auto monotonic = [](const std::vector<G4double>& v, G4int sign) {
+    for(size_t i = 1; i < v.size(); ++i)
+      if(sign * (v[i] - v[i - 1]) > 0.0)
+        return false;
+    return true;
+  };
+  auto log_slope = [&](const std::vector<G4double>& v) {
+    G4double sx = 0.0, sy = 0.0, sxx = 0.0, sxy = 0.0;
+    G4int n = 0;
+    for(size_t i = 0; i < v.size(); ++i)
+    {
+      if(v[i] <= 0.0)
+        continue;
+      G4double y = std::log(v[i]);
+      sx += logn[i];
+      sy += y;
+      sxx += logn[i] * logn[i];
+      sxy += logn[i] * y;
+      ++n;
+    }
+    G4double den = n * sxx - sx * sx;
+    return (n > 2 && den > 0.0) ? (n * sxy - sx * sy) / den : 0.0;
+  };
+
+  G4int noPass  = 0;
+  G4int noTotal = 0;
+  auto check    = [&](G4bool pass, const G4String& yes, const G4String& no) {
+    ++noTotal;
+    if(pass)
+      ++noPass;
+    out << (pass ? yes : no) << G4endl;
+  };
+
+  check(!monotonic(means, 1) && !monotonic(means, -1),
+        "MEAN distribution is RANDOM",
+        "MEAN distribution is not RANDOM");
+  check(r < 0.1, "r is less than 0.1",
+        "r is NOT less than 0.1");
+  check(monotonic(rs, -1), "r is monotonically decreasing",
+        "r is NOT monotonically decreasing");
+  G4double r_slope = log_slope(rs);
+  check(std::fabs(r_slope + 0.5) < 0.1, "r is decreasing as 1/sqrt(N)",
+        "r is NOT decreasing as 1/sqrt(N)");
+  check(fMoments.VOV() < 0.1, "VOV is less than 0.1",
+        "VOV is NOT less than 0.1");
+  check(monotonic(vovs, -1), "VOV is monotonically decreasing",
+        "VOV is NOT monotonically decreasing");
+  G4double vov_slope = log_slope(vovs);
+  check(std::fabs(vov_slope + 1.0) < 0.2, "VOV is decreasing as 1/N",
+        "VOV is NOT decreasing as 1/N");
+  G4double fom_mean = 0.0;
+  for(auto itr : foms)
+    fom_mean += itr / foms.size();
+  G4bool fom_const = fom_mean > 0.0;
+  for(auto itr : foms)
+    if(std::fabs(itr - fom_mean) > 0.1 * fom_mean)
+      fom_const = false;
+  check(fom_const, "FOM is statistically constant",
+        "FOM is NOT statistically constant");
+  check(!monotonic(foms, 1) && !monotonic(foms, -1),
+        "FOM distribution is RANDOM", "FOM distribution is not RANDOM");
+
+  G4double slope = Slope();
+  out << std::setw(20) << "SLOPE = " << std::setw(13) << slope << G4endl;
+  check(slope >= 3.0, "SLOPE is large enough", "SLOPE is not large enough");
+
+  out << "This result passes " << noPass << " / " << noTotal
+      << " Convergence Test." << G4endl;
+  out << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -46,6 +46,19 @@
 ///     The energy deposit is to (possibly) show the round-off error seen
 ///     with thread-local hits maps. The # of steps scorer is to verify
 ///     the thread-safe and thread-local hits maps provide the same results.
+/// The number of sections per dimension is read from TS_TARGET_SECTIONS
+///     (default = 5). Each section is a separate placement by default; with
+///     TS_VOXEL_GEOMETRY=ON the sections are instead the voxels of a single
+///     G4PhantomParameterisation navigated with G4RegularNavigation, which
+///     keeps construction and navigation cheap for grids of millions of
+///     sections (e.g. 200 x 200 x 200). The scoring index is the voxel
+///     index in both cases.
+/// The steps are limited to a tenth of a section so that the scores land in
+///     the right section. With TS_TRACK_LENGTH_SCORING=ON (which implies
+///     TS_VOXEL_GEOMETRY) there is no step limit, the navigation skips the
+///     voxel boundaries between equal materials, and the TSPSVoxelTraversal
+///     scorers split the energy deposit and track length of each step over
+///     the voxels it crosses, which also adds a "TrackLength" scorer.
 //
 //
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -60,15 +73,19 @@
 #include "G4Material.hh"
 #include "G4NistManager.hh"
 #include "G4PVPlacement.hh"
+#include "G4PVParameterised.hh"
+#include "G4PhantomParameterisation.hh"
 #include "G4VisAttributes.hh"
 #include "G4Colour.hh"
 #include "G4UnitsTable.hh"
 #include "G4UserLimits.hh"
+#include "G4EnvironmentUtils.hh"
 
 #include "G4SDManager.hh"
 #include "G4MultiFunctionalDetector.hh"
 #include "G4PSEnergyDeposit.hh"
 #include "G4PSNofStep.hh"
+#include "TSPSVoxelTraversal.hh"
 
 using namespace CLHEP;
 
@@ -94,8 +111,22 @@ TSDetectorConstruction::TSDetectorConstruction()
   , fTargetDim(G4ThreeVector(0.5 * m, 0.5 * m, 0.5 * m))
   , fTargetSections(G4ThreeVector(5, 5, 5))
   , fMfdName("Target_MFD")
+  , fVoxelGeometry(false)
+  , fTrackLengthScoring(false)
 {
   fgInstance = this;
+
+  G4int sections = G4GetEnv<G4int>("TS_TARGET_SECTIONS", 5,
+                                   "Number of target sections per dimension");
+  fTargetSections = G4ThreeVector(sections, sections, sections);
+  fVoxelGeometry  = G4GetEnv<G4bool>(
+    "TS_VOXEL_GEOMETRY", false,
+    "Target sections as voxels of a G4PhantomParameterisation");
+  fTrackLengthScoring = G4GetEnv<G4bool>(
+    "TS_TRACK_LENGTH_SCORING", false,
+    "Voxel scores split along the steps, without step limits");
+  if(fTrackLengthScoring)
+    fVoxelGeometry = true;
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -129,8 +160,11 @@ TSDetectorConstruction::ConstructMaterials()
 G4VPhysicalVolume* TSDetectorConstruction::ConstructWorld(
   const MaterialCollection_t& materials)
 {
+  // the scorers split the steps over the voxels themselves
   G4UserLimits* steplimit =
-    new G4UserLimits(0.1 * (fTargetDim.z() / fTargetSections.z()));
+    (fTrackLengthScoring)
+      ? nullptr
+      : new G4UserLimits(0.1 * (fTargetDim.z() / fTargetSections.z()));
   G4bool check_overlap = false;
 
   G4Box* world_solid = new G4Box("World", 0.5 * fWorldDim.x(),
@@ -172,6 +206,12 @@ G4VPhysicalVolume* TSDetectorConstruction::ConstructWorld(
 
   world_log->SetVisAttributes(white);
 
+  if(fVoxelGeometry)
+  {
+    ConstructVoxels(materials, steplimit);
+    return fWorldPhys;
+  }
+
   for(G4int k = 0; k < nz; ++k)
     for(G4int j = 0; j < ny; ++j)
       for(G4int i = 0; i < nx; ++i)
@@ -183,7 +223,8 @@ G4VPhysicalVolume* TSDetectorConstruction::ConstructWorld(
           0.5 * sy + static_cast<G4double>(j) * sy - 0.5 * fWorldDim.y();
         G4double dz =
           0.5 * sz + static_cast<G4double>(k) * sz - 0.5 * fWorldDim.z();
-        G4ThreeVector td = G4ThreeVector(dx, dy, -dz);
+        // k counts from -z, as the voxels of ConstructVoxels
+        G4ThreeVector td = G4ThreeVector(dx, dy, dz);
         // make unique name
         std::stringstream ss_name;
         ss_name << "Target_" << i << "_" << j << "_" << k;
@@ -248,6 +289,80 @@ G4VPhysicalVolume* TSDetectorConstruction::ConstructWorld(
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+void TSDetectorConstruction::ConstructVoxels(
+  const MaterialCollection_t& materials, G4UserLimits* steplimit)
+{
+  G4int nz = fTargetSections.z();
+  G4int ny = fTargetSections.y();
+  G4int nx = fTargetSections.x();
+
+  // spacing between sections
+  G4double sx = fTargetDim.x() / fTargetSections.x();
+  G4double sy = fTargetDim.y() / fTargetSections.y();
+  G4double sz = fTargetDim.z() / fTargetSections.z();
+
+  // material of each voxel, by index (0 = casing, 1 = target). The voxel
+  //  index is i + j * nx + k * nx * ny, with i, j and k counting from -x,
+  //  -y and -z, as the copy number of the sections
+  std::vector<G4Material*> voxel_materials = {
+    materials.find("Casing")->second, materials.find("Target")->second
+  };
+  fMaterialIndices.assign(GetTotalTargets(), 0);
+  for(G4int k = 0; k < nz; ++k)
+    for(G4int j = 0; j < ny; ++j)
+      for(G4int i = 0; i < nx; ++i)
+      {
+        if(j == 0 || j + 1 == ny || i == 0 || i + 1 == nx ||
+           (nz > 1 && (k == 0 || k + 1 == nz)))
+          continue;
+        fMaterialIndices[k * nx * ny + j * nx + i] = 1;
+      }
+
+  G4PhantomParameterisation* param = new G4PhantomParameterisation();
+  param->SetVoxelDimensions(0.5 * sx, 0.5 * sy, 0.5 * sz);
+  param->SetNoVoxels(nx, ny, nz);
+  param->SetMaterials(voxel_materials);
+  param->SetMaterialIndices(fMaterialIndices.data());
+  // every voxel is scored, so steps have to stop at every voxel boundary,
+  //  unless the scorers follow the steps through the voxels
+  param->SetSkipEqualMaterials(fTrackLengthScoring);
+
+  // container of the voxels, filling the target
+  G4Box* cont_solid = new G4Box("Target", 0.5 * fTargetDim.x(),
+                                0.5 * fTargetDim.y(), 0.5 * fTargetDim.z());
+  G4LogicalVolume* cont_log = new G4LogicalVolume(
+    cont_solid, materials.find("Casing")->second, "Target");
+  G4VPhysicalVolume* cont_phys =
+    new G4PVPlacement(0, G4ThreeVector(0.), "Target", cont_log, fWorldPhys,
+                      false, 0, false);
+  param->BuildContainerSolid(cont_phys);
+  param->CheckVoxelsFillContainer(cont_solid->GetXHalfLength(),
+                                  cont_solid->GetYHalfLength(),
+                                  cont_solid->GetZHalfLength());
+
+  G4Box* voxel_solid = new G4Box("Voxel", 0.5 * sx, 0.5 * sy, 0.5 * sz);
+  G4LogicalVolume* voxel_log = new G4LogicalVolume(
+    voxel_solid, materials.find("Casing")->second, "Voxel");
+  voxel_log->SetUserLimits(steplimit);
+
+  G4VisAttributes* green = new G4VisAttributes(G4Color(0., 1., 0., 0.25));
+  green->SetVisibility(true);
+  green->SetForceSolid(true);
+  voxel_log->SetVisAttributes(green);
+  cont_log->SetVisAttributes(G4VisAttributes::GetInvisible());
+
+  // copy number of each voxel is its index, as seen by the scorers
+  G4PVParameterised* voxel_phys =
+    new G4PVParameterised("Voxel", voxel_log, cont_log, kUndefined,
+                          param->GetNoVoxels(), param);
+  // navigate the voxels with G4RegularNavigation instead of smart voxels
+  voxel_phys->SetRegularStructureId(1);
+
+  fScoringVolumes.insert(voxel_log);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
 void TSDetectorConstruction::ConstructSDandField()
 {
   //------------------------------------------------//
@@ -256,10 +371,27 @@ void TSDetectorConstruction::ConstructSDandField()
   // Define MultiFunctionalDetector with name.
   G4MultiFunctionalDetector* MFDet = new G4MultiFunctionalDetector(fMfdName);
   G4SDManager::GetSDMpointer()->AddNewDetector(MFDet);
-  G4VPrimitiveScorer* edep = new G4PSEnergyDeposit("EnergyDeposit");
-  MFDet->RegisterPrimitive(edep);
-  G4VPrimitiveScorer* nstep = new G4PSNofStep("NumberOfSteps");
-  MFDet->RegisterPrimitive(nstep);
+  if(fTrackLengthScoring)
+  {
+    G4ThreeVector voxel(fTargetDim.x() / fTargetSections.x(),
+                        fTargetDim.y() / fTargetSections.y(),
+                        fTargetDim.z() / fTargetSections.z());
+    G4int nx = fTargetSections.x();
+    G4int ny = fTargetSections.y();
+    G4int nz = fTargetSections.z();
+    MFDet->RegisterPrimitive(new TSPSVoxelTraversal(
+      "EnergyDeposit", TSPSVoxelTraversal::kEnergyDeposit, nx, ny, nz, voxel));
+    MFDet->RegisterPrimitive(new G4PSNofStep("NumberOfSteps"));
+    MFDet->RegisterPrimitive(new TSPSVoxelTraversal(
+      "TrackLength", TSPSVoxelTraversal::kTrackLength, nx, ny, nz, voxel));
+  }
+  else
+  {
+    G4VPrimitiveScorer* edep = new G4PSEnergyDeposit("EnergyDeposit");
+    MFDet->RegisterPrimitive(edep);
+    G4VPrimitiveScorer* nstep = new G4PSNofStep("NumberOfSteps");
+    MFDet->RegisterPrimitive(nstep);
+  }
 
   // add scoring volumes
   for(auto ite : fScoringVolumes)
@@ -0,0 +1,218 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file parallel/ThreadsafeScorers/src/TSPSVoxelTraversal.cc
+/// \brief Implementation of the TSPSVoxelTraversal class
+//
+//
+//
+//
+/// See TSPSVoxelTraversal.hh
+//
+//
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#include "TSPSVoxelTraversal.hh"
+
+#include "G4Step.hh"
+#include "G4VTouchable.hh"
+#include "G4NavigationHistory.hh"
+#include "G4AffineTransform.hh"
+#include "G4HCofThisEvent.hh"
+#include "G4MultiFunctionalDetector.hh"
+#include "G4UnitsTable.hh"
+
+#include <algorithm>
+#include <cfloat>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+TSPSVoxelTraversal::TSPSVoxelTraversal(const G4String& name,
+                                       Quantity quantity, G4int nx,
+                                       G4int ny, G4int nz,
+                                       const G4ThreeVector& voxel_size)
+  : G4VPrimitiveScorer(name)
+  , fQuantity(quantity)
+  , fNumVoxels{ nx, ny, nz }
+  , fVoxelSize(voxel_size)
+  , fHCID(-1)
+  , fEvtMap(nullptr)
+{
+  if(fQuantity == kEnergyDeposit)
+    CheckAndSetUnit("MeV", "Energy");
+  else
+    CheckAndSetUnit("mm", "Length");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+TSPSVoxelTraversal::~TSPSVoxelTraversal() {}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TSPSVoxelTraversal::Initialize(G4HCofThisEvent* HCE)
+{
+  fEvtMap = new G4THitsMap<G4double>(detector->GetName(), GetName());
+  if(fHCID < 0)
+    fHCID = GetCollectionID(0);
+  HCE->AddHitsCollection(fHCID, (G4VHitsCollection*) fEvtMap);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TSPSVoxelTraversal::clear() { fEvtMap->clear(); }
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TSPSVoxelTraversal::PrintAll()
+{
+  G4cout << " MultiFunctionalDet  " << detector->GetName() << G4endl;
+  G4cout << " PrimitiveScorer " << GetName() << G4endl;
+  G4cout << " Number of entries " << fEvtMap->entries() << G4endl;
+  for(const auto& itr : *fEvtMap->GetMap())
+  {
+    G4cout << "  copy no.: " << itr.first << "  "
+           << ((fQuantity == kEnergyDeposit) ? "energy deposit"
+                                             : "track length")
+           << ": " << *(itr.second) / GetUnitValue() << " [" << GetUnit()
+           << "]" << G4endl;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool TSPSVoxelTraversal::ProcessHits(G4Step* aStep, G4TouchableHistory*)
+{
+  G4double value = (fQuantity == kEnergyDeposit)
+                     ? aStep->GetTotalEnergyDeposit()
+                     : aStep->GetStepLength();
+  if(value == 0.)
+    return false;
+  value *= aStep->GetPreStepPoint()->GetWeight();
+
+  // the navigation history ends in the voxel of the pre-step point, whose
+  //  (unrotated) frame is centred on that voxel
+  G4StepPoint* pre              = aStep->GetPreStepPoint();
+  const G4AffineTransform& tloc =
+    pre->GetTouchable()->GetHistory()->GetTopTransform();
+  G4ThreeVector start = tloc.TransformPoint(pre->GetPosition());
+  G4ThreeVector end =
+    tloc.TransformPoint(aStep->GetPostStepPoint()->GetPosition());
+
+  // to units of voxels from the low corner of the grid
+  G4int first   = GetIndex(aStep);
+  G4int cell[3] = { first % fNumVoxels[0],
+                    (first / fNumVoxels[0]) % fNumVoxels[1],
+                    first / (fNumVoxels[0] * fNumVoxels[1]) };
+  for(G4int i = 0; i < 3; ++i)
+  {
+    start[i] = cell[i] + 0.5 + start[i] / fVoxelSize[i];
+    end[i]   = cell[i] + 0.5 + end[i] / fVoxelSize[i];
+  }
+
+  Traverse(fNumVoxels, first, start, end, fSegments);
+
+  if(fQuantity == kEnergyDeposit &&
+     aStep->GetTrack()->GetDefinition()->GetPDGCharge() == 0.)
+  {
+    fEvtMap->add(fSegments.back().first, value);
+    return true;
+  }
+
+  for(const auto& itr : fSegments)
+  {
+    G4double part = value * itr.second;
+    fEvtMap->add(itr.first, part);
+  }
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TSPSVoxelTraversal::Traverse(const G4int n[3], G4int first,
+                                  const G4ThreeVector& start,
+                                  const G4ThreeVector& end,
+                                  Segments_t& segments)
+{
+  segments.clear();
+
+  G4int cell[3] = { first % n[0], (first / n[0]) % n[1],
+                    first / (n[0] * n[1]) };
+  G4int step[3]       = { 0, 0, 0 };
+  G4double tmax[3]    = { DBL_MAX, DBL_MAX, DBL_MAX };
+  G4double tdelta[3]  = { DBL_MAX, DBL_MAX, DBL_MAX };
+  G4ThreeVector delta = end - start;
+
+  // fraction of the segment at which it leaves the voxel along each axis
+  for(G4int i = 0; i < 3; ++i)
+  {
+    if(delta[i] > 0.)
+    {
+      step[i]   = 1;
+      tmax[i]   = (cell[i] + 1 - start[i]) / delta[i];
+      tdelta[i] = 1. / delta[i];
+    }
+    else if(delta[i] < 0.)
+    {
+      step[i]   = -1;
+      tmax[i]   = (cell[i] - start[i]) / delta[i];
+      tdelta[i] = -1. / delta[i];
+    }
+    // a start on (or by rounding, past) a face of the first voxel
+    tmax[i] = std::max(tmax[i], 0.);
+  }
+
+  G4double t = 0.;
+  while(t < 1.)
+  {
+    G4int axis  = (tmax[0] < tmax[1]) ? ((tmax[0] < tmax[2]) ? 0 : 2)
+                                      : ((tmax[1] < tmax[2]) ? 1 : 2);
+    G4int index = cell[0] + n[0] * (cell[1] + n[1] * cell[2]);
+    G4double next = std::min(tmax[axis], 1.);
+    if(next > t)
+      segments.push_back(std::make_pair(index, next - t));
+    t = next;
+    if(t >= 1.)
+      break;
+
+    cell[axis] += step[axis];
+    if(cell[axis] < 0 || cell[axis] >= n[axis])
+    {
+      // leaving the grid before the end point, by rounding: the rest of
+      //  the segment stays in the last voxel
+      if(segments.empty())
+        segments.push_back(std::make_pair(index, 0.));
+      segments.back().second += 1. - t;
+      break;
+    }
+    tmax[axis] += tdelta[axis];
+  }
+
+  if(segments.empty())
+    segments.push_back(std::make_pair(first, 1.));
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -67,6 +67,7 @@
 #include "G4PhysicsListHelper.hh"
 
 #include "G4StepLimiter.hh"
+#include "TSDetectorConstruction.hh"
 
 // Constructors
 #include "G4EmStandardPhysics_option3.hh"
@@ -128,6 +129,11 @@ void TSPhysicsList::ConstructProcess()
     c->ConstructProcess();
   }
 
+  // the track-length scorers do not need the steps to end in each section
+  TSDetectorConstruction* detector = TSDetectorConstruction::Instance();
+  if(detector && detector->IsTrackLengthScoring())
+    return;
+
   std::set<G4String> step_limit_particles;
   // standard particles
   step_limit_particles.insert("e-");
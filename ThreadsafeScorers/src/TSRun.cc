@@ -34,7 +34,7 @@
 ///     2) a global atomic hits map
 ///     3) a global "mutex" hits map
 ///     4) a global G4StatAnalysis hits deque
-///     5) a global G4ConvergenceTester hits deque
+///     5) a thread-local TSConvergenceStats hits deque
 ///
 /// The thread-local hits map is the same as you will find in many other
 ///     examples.
@@ -48,20 +48,60 @@
 ///     (3) destruction -- it should only be cleared by the master thread since
 ///         there is only one instance.
 ///
+/// By default the global atomic scores are kept in a dense
+///     G4TAtomicHitsArray indexed by copy number, which needs neither a
+///     lookup nor a lock per add. Setting TS_ATOMIC_HITS_MAP=ON switches
+///     back to the G4TAtomicHitsMap, and TS_COMPENSATED_SUMS=ON to a
+///     G4TAtomicHitsArray of G4atomic_compensated, whose sums are within
+///     about one rounding of the exact sum whatever the order of the
+///     additions. With TS_ATOMIC_SHARDS=ON, each socket (see TSAffinity)
+///     gets its own G4TAtomicHitsArray, allocated by the first worker
+///     running there so that its pages are local to that socket; the
+///     workers only contend with the workers of the same socket and
+///     Reduce() sums the shards into the global array. TS_ATOMIC_SHARDS is
+///     only read when configured with TS_NUMA_EXPERIMENTAL=ON.
+///
 /// The "mutex" hits map is also included as reference for checking the results
 ///     accumulated by the thread-local hits maps and atomic hits maps. The
 ///     differences w.r.t. this hits maps are computed in
 ///     TSRunAction::EndOfRunAction
 ///
-/// The "G4StatAnalysis" and "G4ConvergenceTester" hits deques are
+/// The thread-local containers are not summed in Merge(), which the run
+///     manager calls for one worker at a time under a lock: Merge() only
+///     takes them over from the worker run. Reduce() then sums them as a
+///     binary tree, level by level, with the pairs of a level (and their
+///     collections) summed as concurrent tasks on the G4TaskRunManager
+///     thread pool, so the end-of-run time grows with log2(# of workers).
+///     Without a thread pool the same tree is summed serially.
+///
+/// With TS_CONTENTION_COUNTERS=ON at configuration, the lock of the "mutex"
+///     hits map, the new keys of the run-level maps and the bytes summed by
+///     Reduce() are counted per thread by TSContention.
+///
+/// Snapshots (see TSSnapshot) are controlled by environment variables:
+///     TS_SNAPSHOT=<prefix>     master writes <prefix>_run<#>.tssnap at the
+///                              end of each run
+///     TS_CHECKPOINT_EVENTS=<N> workers write <prefix>_run<#>_t<thread>.tssnap
+///                              every N of their events, removed once the
+///                              snapshot of the end of the run is written
+///     TS_RESUME=<file>         the first run starts from this snapshot
+///     A checkpoint holds the thread-local containers of one worker; its
+///     atomic and mutex values are the worker's contribution to the global
+///     containers, i.e. the same sums as its thread-local hits map.
+///
+/// The "G4StatAnalysis" and "TSConvergenceStats" hits deques are
 ///     memory-efficient version of the standard G4THitsMap. While maps are
 ///     ideal for scoring at the G4Event-level, where sparsity w.r.t. indices
 ///     is common; at the G4Run-level, these data structures require much
-///     less memory overhead. Due to a lack of
-///     G4ConvergenceTester::operator+=(G4ConvergenceTester), the static version
-///     of G4ConvergenceTester is the only valid way to use G4ConvergenceTester
-///     in a scoring container. This is not the case for G4StatAnalysis, which
-///     can be used in lieu of G4double.
+///     less memory overhead. G4ConvergenceTester lacks
+///     operator+=(G4ConvergenceTester) and was used as a single global
+///     instance per section behind a mutex at every event. TSConvergenceStats
+///     keeps mergeable moments, a thinned fluctuation chart and the largest
+///     scores instead, so it is filled thread-locally like G4StatAnalysis
+///     and summed in Merge(). Its chart and largest scores share
+///     TS_CONVERGENCE_BUDGET MB per thread (default 64) among the sections
+///     of all collections, so large grids keep fewer largest scores or only
+///     the moments.
 ///
 //
 //
@@ -74,15 +114,82 @@
 #include "G4MultiFunctionalDetector.hh"
 #include "G4VPrimitiveScorer.hh"
 #include "G4TiMemory.hh"
+#include "G4EnvironmentUtils.hh"
+#include "G4RunManager.hh"
+#include "G4TaskRunManager.hh"
+#include "G4TaskGroup.hh"
+#include "Randomize.hh"
+#include "CLHEP/Random/MixMaxRng.h"
+
+#include <cstdint>
+#include <cstdio>
+#include "TSAffinity.hh"
+#include "TSContention.hh"
 #include "TSDetectorConstruction.hh"
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 std::vector<G4TAtomicHitsMap<G4double>*> TSRun::fAtomicRunMaps;
 
+std::vector<G4TAtomicHitsArray<G4double>*> TSRun::fAtomicRunArrays;
+
+std::vector<TSRun::CompensatedHitsArray_t*> TSRun::fCompensatedRunArrays;
+
+std::vector<std::vector<G4TAtomicHitsArray<G4double>*>> TSRun::fAtomicShards;
+
 std::map<G4String, TSRun::MutexHitsMap_t> TSRun::fMutexRunMaps;
 
-std::vector<G4StatContainer<G4ConvergenceTester>*> TSRun::fConvMaps;
+G4long TSRun::fRunSeed = 0;
+
+std::vector<unsigned long> TSRun::fEngineState;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+namespace
+{
+  const std::string& snapshot_prefix()
+  {
+    static std::string value = G4GetEnv<std::string>(
+      "TS_SNAPSHOT", "", "Prefix of the TSRun snapshot files");
+    return value;
+  }
+
+  G4int checkpoint_events()
+  {
+    static G4int value = G4GetEnv<G4int>(
+      "TS_CHECKPOINT_EVENTS", 0, "Events between worker TSRun checkpoints");
+    return value;
+  }
+
+  G4double convergence_budget()
+  {
+    static G4double value = G4GetEnv<G4double>(
+      "TS_CONVERGENCE_BUDGET", 64.0,
+      "MB per thread for the TSConvergenceStats charts and largest scores");
+    return value;
+  }
+}  // namespace
+
+G4long TSRun::GetJobSeed()
+{
+  static G4long value = G4GetEnv<G4long>(
+    "TS_SEED", 0L, "Seed of the TSRun job (0: the engine is not reseeded)");
+  return value;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4long TSRun::GetEngineId(const std::vector<unsigned long>& state)
+{
+  // FNV-1a of the state words, positive and non-zero
+  std::uint64_t hash = 14695981039346656037ULL;
+  for(auto word : state)
+  {
+    hash ^= static_cast<std::uint64_t>(word);
+    hash *= 1099511628211ULL;
+  }
+  return static_cast<G4long>(hash >> 1) + 1;
+}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
@@ -90,6 +197,74 @@ TSRun::TSRun(const G4String& mfd_name)
   : G4Run()
 {
   ConstructMFD(mfd_name);
+  if(!G4Threading::IsWorkerThread())
+  {
+    TSConvergenceStats::StartTimer();
+
+    // draws the seed of each run of the job, with TS_SEED set
+    static CLHEP::MixMaxRng engine(GetJobSeed());
+    G4bool seeded = (GetJobSeed() != 0);
+
+    // the first run continues from the snapshot, if any
+    static G4bool resumed = false;
+    std::string resume    = G4GetEnv<std::string>(
+      "TS_RESUME", "", "TSRun snapshot the first run starts from");
+    if(!resumed && !resume.empty())
+    {
+      TSSnapshot snapshot;
+      if(!snapshot.Read(resume))
+        G4Exception("TSRun", "TS_RESUME", FatalException,
+                    G4String("cannot resume from " + resume).c_str());
+
+      // continue the job of the snapshot, or start one that cannot repeat
+      // its run seeds. Without TS_SEED the engine is the run manager's, and
+      // must not be in a state a run of the snapshot started from.
+      G4bool restore = seeded && !snapshot.GetEngineState().empty();
+      for(const auto& itr : snapshot.GetSources())
+        restore = restore && itr.fJobSeed != 0;
+      if(restore)
+      {
+        if(!engine.get(snapshot.GetEngineState()))
+          G4Exception("TSRun", "TS_RESUME", FatalException,
+                      G4String("bad engine state in " + resume).c_str());
+      }
+      else
+      {
+        G4long engine_id = GetEngineId(G4Random::getTheEngine()->put());
+        for(const auto& itr : snapshot.GetSources())
+          if(seeded ? itr.fJobSeed == GetJobSeed()
+                    : itr.fRunSeed == engine_id)
+            G4Exception("TSRun", "TS_SEED", FatalException,
+                        G4String(resume + " has the histories this job would "
+                                          "start from, set a TS_SEED of its "
+                                          "own or reset the engine")
+                          .c_str());
+      }
+
+      AddSnapshot(snapshot);
+      fResumedSources = snapshot.GetSources();
+      numberOfEvent += snapshot.GetNumberOfEvents();
+      G4cout << "TSRun: resumed " << snapshot.GetNumberOfEvents()
+             << " events from " << resume << G4endl;
+    }
+    resumed = true;
+
+    // with TS_SEED, the master engine draws the seeds of the events from
+    // the run seed. Otherwise it is left as /random/setSeeds or
+    // /random/resetEngineFrom set it, and the run is identified by its
+    // state.
+    if(seeded)
+    {
+      fRunSeed = static_cast<G4long>(engine.flat() * 1.0e15) + 1;
+      G4Random::setTheSeed(fRunSeed);
+      fEngineState = engine.put();
+    }
+    else
+    {
+      fEngineState = G4Random::getTheEngine()->put();
+      fRunSeed     = GetEngineId(fEngineState);
+    }
+  }
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -100,17 +275,32 @@ TSRun::~TSRun()
   for(unsigned i = 0; i < fRunMaps.size(); ++i)
     delete fRunMaps[i];
 
+  for(auto& itr : fConvMaps)
+    delete itr;
+
+  for(auto& itr : fPartials)
+    Delete(itr);
+
   if(!G4Threading::IsWorkerThread())
   {
     for(unsigned i = 0; i < fAtomicRunMaps.size(); ++i)
       delete fAtomicRunMaps[i];
 
-    for(auto& itr : fConvMaps)
+    for(auto& itr : fAtomicRunArrays)
+      delete itr;
+
+    for(auto& itr : fCompensatedRunArrays)
       delete itr;
 
+    for(auto& itr : fAtomicShards)
+      for(auto& shard : itr)
+        delete shard;
+
     fAtomicRunMaps.clear();
+    fAtomicRunArrays.clear();
+    fCompensatedRunArrays.clear();
+    fAtomicShards.clear();
     fMutexRunMaps.clear();
-    fConvMaps.clear();
   }
 }
 
@@ -126,6 +316,25 @@ void TSRun::ConstructMFD(const G4String& mfdName)
   //=================================================
   G4MultiFunctionalDetector* mfd =
     (G4MultiFunctionalDetector*) (SDman->FindSensitiveDetector(mfdName));
+  G4bool atomic_map    = false;
+  G4bool compensated   = false;
+  G4bool atomic_shards = false;
+  if(!G4Threading::IsWorkerThread())
+  {
+    atomic_map = G4GetEnv<G4bool>(
+      "TS_ATOMIC_HITS_MAP", false,
+      "Global atomic scoring in G4TAtomicHitsMap instead of "
+      "G4TAtomicHitsArray");
+    compensated = !atomic_map && G4GetEnv<G4bool>(
+      "TS_COMPENSATED_SUMS", false,
+      "Global atomic scoring in a G4TAtomicHitsArray of "
+      "G4atomic_compensated");
+#if defined(TS_NUMA)
+    atomic_shards = !atomic_map && !compensated && G4GetEnv<G4bool>(
+      "TS_ATOMIC_SHARDS", false,
+      "Global atomic scoring in one G4TAtomicHitsArray per socket");
+#endif
+  }
   //
   if(mfd)
   {
@@ -155,14 +364,39 @@ void TSRun::ConstructMFD(const G4String& mfdName)
         fStatMaps.push_back(new G4StatContainer<G4StatAnalysis>(
           mfdName, collectionName,
           TSDetectorConstruction::Instance()->GetTotalTargets()));
+        fConvMaps.push_back(new G4StatContainer<TSConvergenceStats>(
+          mfdName, collectionName,
+          TSDetectorConstruction::Instance()->GetTotalTargets()));
         if(!G4Threading::IsWorkerThread())
         {
-          fAtomicRunMaps.push_back(
-            new G4TAtomicHitsMap<G4double>(mfdName, collectionName));
+          if(atomic_map)
+            fAtomicRunMaps.push_back(
+              new G4TAtomicHitsMap<G4double>(mfdName, collectionName));
+          else if(compensated)
+            fCompensatedRunArrays.push_back(new CompensatedHitsArray_t(
+              mfdName, collectionName,
+              TSDetectorConstruction::Instance()->GetTotalTargets()));
+          else
+            fAtomicRunArrays.push_back(new G4TAtomicHitsArray<G4double>(
+              mfdName, collectionName,
+              TSDetectorConstruction::Instance()->GetTotalTargets()));
+          if(atomic_shards)
+            fAtomicShards.push_back(std::vector<G4TAtomicHitsArray<G4double>*>(
+              TSAffinity::GetNumberOfSockets(), nullptr));
           fMutexRunMaps[fCollNames[collectionID]].clear();
-          fConvMaps.push_back(new G4StatContainer<G4ConvergenceTester>(
-            mfdName, collectionName,
-            TSDetectorConstruction::Instance()->GetTotalTargets()));
+        }
+        else if(fShards.size() < fAtomicShards.size())
+        {
+          // the first worker of a socket allocates, and so first touches,
+          // the shard of that socket
+          static G4Mutex mtx = G4MUTEX_INITIALIZER;
+          G4AutoLock lock(&mtx);
+          auto& shard = fAtomicShards[fShards.size()][TSAffinity::GetSocket()];
+          if(!shard)
+            shard = new G4TAtomicHitsArray<G4double>(
+              mfdName, collectionName,
+              TSDetectorConstruction::Instance()->GetTotalTargets());
+          fShards.push_back(shard);
         }
       }
       else
@@ -172,6 +406,21 @@ void TSRun::ConstructMFD(const G4String& mfdName)
       }
     }
   }
+
+  if(!G4Threading::IsWorkerThread())
+  {
+    // the workers construct their runs after the master
+    TSConvergenceStats::SetBudget(
+      convergence_budget() * 1024 * 1024,
+      fConvMaps.size() * TSDetectorConstruction::Instance()->GetTotalTargets());
+    size_t tail = TSConvergenceStats::GetTailCapacity();
+    if(tail < TSConvergenceStats::LargestCapacity)
+      G4cout << "TSRun: TS_CONVERGENCE_BUDGET keeps "
+             << ((tail > 0) ? std::to_string(tail) +
+                                " largest scores per section"
+                            : std::string("only the moments of the scores"))
+             << G4endl;
+  }
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -190,6 +439,8 @@ void TSRun::RecordEvent(const G4Event* aEvent)
   if(!HCE)
     return;
 
+  TSConvergenceStats::SetCurrentEvent(aEvent->GetEventID());
+
   for(unsigned i = 0; i < fCollIDs.size(); ++i)
   {
     G4int fCollID = fCollIDs.at(i);
@@ -208,6 +459,7 @@ void TSRun::RecordEvent(const G4Event* aEvent)
       //=== Sum up HitsMap of this event to HitsMap of RUN.===
       {
         G4USER_SCOPED_PROFILE("ThreadLocal");
+        TS_CONTENTION_INSERTIONS(ins, *fRunMaps[fCollID]);
         *fRunMaps[fCollID] += *EvtMap;
       }
       //=== Sum up HitsMap of this event to StatMap of RUN.===
@@ -216,46 +468,289 @@ void TSRun::RecordEvent(const G4Event* aEvent)
         // G4StatAnalysis map
         *fStatMaps[fCollID] += *EvtMap;
       }
+      //=== Sum up HitsMap of this event to ConvMap of RUN.===
+      {
+        G4USER_SCOPED_PROFILE("ThreadLocal/TSConvergenceStats");
+        // TSConvergenceStats map
+        *fConvMaps[fCollID] += *EvtMap;
+      }
       //=== Sum up HitsMap of this event to atomic HitsMap of RUN.===
       {
         G4USER_SCOPED_PROFILE("Global/Atomic");
-        *fAtomicRunMaps[fCollID] += *EvtMap;
+        if(!fShards.empty())
+          *fShards[fCollID] += *EvtMap;
+        else if(!fAtomicRunArrays.empty())
+          *fAtomicRunArrays[fCollID] += *EvtMap;
+        else if(!fCompensatedRunArrays.empty())
+          *fCompensatedRunArrays[fCollID] += *EvtMap;
+        else
+          *fAtomicRunMaps[fCollID] += *EvtMap;
       }
       //=== Sum up HitsMap of this event to MutexMap of RUN.===
       {
         G4USER_SCOPED_PROFILE("Global/Mutex");
         // mutex run map
         static G4Mutex mtx = G4MUTEX_INITIALIZER;
-        G4AutoLock lock(&mtx);
+        TS_CONTENTION_LOCK(lock, &mtx);
+        MutexHitsMap_t& mutex_map = fMutexRunMaps[fCollNames[fCollID]];
+        TS_CONTENTION_INSERTIONS(ins, mutex_map);
         for(const auto& itr : *EvtMap)
-          fMutexRunMaps[fCollNames[fCollID]][itr.first] += *itr.second;
-      }
-      //=== Sum up HitsMap of this event to MutexMap of RUN.===
-      {
-        G4USER_SCOPED_PROFILE("Global/Mutex/G4ConvergenceTester");
-        // G4ConvergenceTester run map
-        static G4Mutex mtx = G4MUTEX_INITIALIZER;
-        G4AutoLock lock(&mtx);
-        *fConvMaps[fCollID] += *EvtMap;
+          mutex_map[itr.first] += *itr.second;
       }
     }
   }
+
+  //=== Checkpoint the thread-local containers.===
+  G4int nckpt = checkpoint_events();
+  if(nckpt > 0 && !snapshot_prefix().empty() && numberOfEvent % nckpt == 0)
+  {
+    G4USER_SCOPED_PROFILE("Checkpoint");
+    GetSnapshot().Write(GetSnapshotPath(G4Threading::G4GetThreadId()));
+  }
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-// Merge hits map from threads
+// Take over the hits maps of the threads, summed in Reduce()
 void TSRun::Merge(const G4Run* aTSRun)
 {
-  const TSRun* localTSRun = static_cast<const TSRun*>(aTSRun);
+  // the worker run is done with its containers, which are moved here
+  // instead of summed, to keep the time spent under the merge lock short
+  TSRun* localTSRun = const_cast<TSRun*>(static_cast<const TSRun*>(aTSRun));
 
-  for(unsigned i = 0; i < fRunMaps.size(); ++i)
+  Partial_t partial;
+  std::swap(partial.fRunMaps, localTSRun->fRunMaps);
+  std::swap(partial.fStatMaps, localTSRun->fStatMaps);
+  std::swap(partial.fConvMaps, localTSRun->fConvMaps);
+  fPartials.push_back(std::move(partial));
+
+  G4Run::Merge(aTSRun);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TSRun::Reduce() const
+{
+  G4USER_SCOPED_PROFILE("Reduce");
+
+  // per-socket shards of the atomic scores into the global arrays
+  for(size_t i = 0; i < fAtomicShards.size(); ++i)
   {
-    *fRunMaps[i] += *localTSRun->fRunMaps[i];
-    *fStatMaps[i] += *localTSRun->fStatMaps[i];
+    G4TAtomicHitsArray<G4double>* total = fAtomicRunArrays.at(i);
+    for(auto& shard : fAtomicShards[i])
+    {
+      if(!shard)
+        continue;
+      TS_CONTENTION_ADD(kBytesMerged, shard->size() * sizeof(G4double));
+      shard->for_each(
+        [total](G4int key, G4double value) { total->add(key, value); });
+      delete shard;
+      shard = nullptr;
+    }
   }
 
-  G4Run::Merge(aTSRun);
+  if(fPartials.empty())
+    return;
+
+  // do not directly call G4TaskManager::GetInstance() as this will generate
+  // an instance
+  auto tm = dynamic_cast<G4TaskRunManager*>(G4RunManager::GetRunManager());
+  auto tp = (tm) ? tm->GetThreadPool() : nullptr;
+
+  size_t ncoll = fCollIDs.size();
+  size_t nlevel = 0;
+  // level 'stride': partial i += partial i + stride, for i % (2 * stride) == 0
+  for(size_t stride = 1; stride < fPartials.size(); stride *= 2, ++nlevel)
+  {
+    auto add = [this, stride](size_t i, size_t icoll) {
+      Add(fPartials[i], fPartials[i + stride], icoll);
+    };
+    if(tp)
+    {
+      G4TaskGroup<void> tg(tp);
+      for(size_t i = 0; i + stride < fPartials.size(); i += 2 * stride)
+        for(size_t j = 0; j < ncoll; ++j)
+          tg.exec(add, i, j);
+      tg.join();
+    }
+    else
+    {
+      for(size_t i = 0; i + stride < fPartials.size(); i += 2 * stride)
+        for(size_t j = 0; j < ncoll; ++j)
+          add(i, j);
+    }
+  }
+
+  // root of the tree into the containers of this run
+  Partial_t master;
+  master.fRunMaps  = fRunMaps;
+  master.fStatMaps = fStatMaps;
+  master.fConvMaps = fConvMaps;
+  for(size_t j = 0; j < ncoll; ++j)
+    Add(master, fPartials.front(), j);
+
+  if(G4RunManager::GetRunManager()->GetVerboseLevel() > 1)
+    G4cout << "TSRun: reduced " << fPartials.size() << " worker runs in "
+           << nlevel << " levels" << G4endl;
+
+  for(auto& itr : fPartials)
+    Delete(itr);
+  fPartials.clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TSRun::Add(Partial_t& lhs, const Partial_t& rhs, size_t icoll)
+{
+  TS_CONTENTION_ADD(
+    kBytesMerged,
+    rhs.fRunMaps[icoll]->size() * (sizeof(G4int) + sizeof(G4double)) +
+      rhs.fStatMaps[icoll]->size() * sizeof(G4StatAnalysis) +
+      rhs.fConvMaps[icoll]->size() * sizeof(TSConvergenceStats));
+  *lhs.fRunMaps[icoll] += *rhs.fRunMaps[icoll];
+  *lhs.fStatMaps[icoll] += *rhs.fStatMaps[icoll];
+  *lhs.fConvMaps[icoll] += *rhs.fConvMaps[icoll];
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TSRun::Delete(Partial_t& partial)
+{
+  for(auto& itr : partial.fRunMaps)
+    delete itr;
+  for(auto& itr : partial.fStatMaps)
+    delete itr;
+  for(auto& itr : partial.fConvMaps)
+    delete itr;
+  partial.fRunMaps.clear();
+  partial.fStatMaps.clear();
+  partial.fConvMaps.clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+TSSnapshot TSRun::GetSnapshot() const
+{
+  TSSnapshot snapshot;
+  snapshot.SetNumberOfEvents(numberOfEvent);
+  G4bool worker = G4Threading::IsWorkerThread();
+
+  for(const auto& itr : fResumedSources)
+    snapshot.AddSource(itr);
+  snapshot.AddSource(
+    { GetJobSeed(), fRunSeed, worker ? G4Threading::G4GetThreadId() : -1 });
+  snapshot.SetEngineState(fEngineState);
+
+  for(unsigned i = 0; i < fCollNames.size() && i < fRunMaps.size(); ++i)
+  {
+    TSSnapshot::Section_t& sec = snapshot.GetSection(fCollNames[i]);
+
+    for(const auto& itr : *fRunMaps[i]->GetMap())
+      sec.fRunValues[itr.first] = *itr.second;
+
+    for(auto itr = fStatMaps[i]->begin(); itr != fStatMaps[i]->end(); ++itr)
+      if(*itr)
+        sec.fStats[fStatMaps[i]->GetIndex(itr)] = **itr;
+
+    for(auto itr = fConvMaps[i]->begin(); itr != fConvMaps[i]->end(); ++itr)
+      if(*itr)
+        sec.fConv[fConvMaps[i]->GetIndex(itr)] = **itr;
+
+    if(worker)
+    {
+      // the worker's share of the global containers
+      sec.fAtomicValues = sec.fRunValues;
+      sec.fMutexValues  = sec.fRunValues;
+      continue;
+    }
+
+    if(i < fAtomicRunArrays.size())
+      fAtomicRunArrays[i]->for_each([&](G4int key, G4double value) {
+        sec.fAtomicValues[key] = value;
+      });
+    else if(i < fCompensatedRunArrays.size())
+      fCompensatedRunArrays[i]->for_each([&](G4int key, G4double value) {
+        sec.fAtomicValues[key] = value;
+      });
+    else if(i < fAtomicRunMaps.size())
+      for(const auto& itr : *fAtomicRunMaps[i]->GetMap())
+        sec.fAtomicValues[itr.first] = *itr.second;
+
+    auto mitr = fMutexRunMaps.find(fCollNames[i]);
+    if(mitr != fMutexRunMaps.end())
+      sec.fMutexValues = mitr->second;
+  }
+
+  return snapshot;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TSRun::AddSnapshot(const TSSnapshot& snapshot)
+{
+  for(const auto& sec : snapshot.GetSections())
+  {
+    unsigned i = 0;
+    while(i < fCollNames.size() && fCollNames[i] != sec.fName)
+      ++i;
+    if(i == fCollNames.size())
+    {
+      G4Exception("TSRun", sec.fName.c_str(), JustWarning,
+                  "AddSnapshot skipped a section with no collection");
+      continue;
+    }
+
+    for(auto itr : sec.fRunValues)
+      fRunMaps[i]->add(itr.first, itr.second);
+    for(auto itr : sec.fStats)
+      fStatMaps[i]->add(itr.first, itr.second);
+    for(auto itr : sec.fConv)
+      fConvMaps[i]->add(itr.first, itr.second);
+    for(auto itr : sec.fAtomicValues)
+    {
+      if(i < fAtomicRunArrays.size())
+        fAtomicRunArrays[i]->add(itr.first, itr.second);
+      else if(i < fCompensatedRunArrays.size())
+        fCompensatedRunArrays[i]->add(itr.first, itr.second);
+      else if(i < fAtomicRunMaps.size())
+        fAtomicRunMaps[i]->add(itr.first, itr.second);
+    }
+    for(auto itr : sec.fMutexValues)
+      fMutexRunMaps[fCollNames[i]][itr.first] += itr.second;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TSRun::WriteSnapshot() const
+{
+  if(snapshot_prefix().empty())
+    return;
+
+  G4String path = GetSnapshotPath(-1);
+  if(!GetSnapshot().Write(path))
+    return;
+  G4cout << "TSRun: wrote " << numberOfEvent << " events to " << path
+         << G4endl;
+
+  // the worker checkpoints are superseded
+  G4int nthreads = G4RunManager::GetRunManager()->GetNumberOfThreads();
+  for(G4int i = 0; i < nthreads; ++i)
+    std::remove(GetSnapshotPath(i).c_str());
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+// <prefix>_run<#>.tssnap for the master, <prefix>_run<#>_t<#>.tssnap for
+// the checkpoints of the workers
+G4String TSRun::GetSnapshotPath(G4int thread) const
+{
+  std::stringstream ss;
+  ss << snapshot_prefix() << "_run" << GetRunID();
+  if(thread >= 0)
+    ss << "_t" << thread;
+  ss << ".tssnap";
+  return ss.str();
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -286,12 +781,53 @@ G4TAtomicHitsMap<G4double>* TSRun::GetAtomicHitsMap(
 {
   for(unsigned i = 0; i < fCollNames.size(); ++i)
   {
-    if(collName == fCollNames[i])
+    if(collName == fCollNames[i] && i < fAtomicRunMaps.size())
       return fAtomicRunMaps[i];
   }
 
-  G4Exception("TSRun", collName.c_str(), JustWarning,
-              "GetHitsMap failed to locate the requested AtomicHitsMap");
+  if(fAtomicRunArrays.empty() && fCompensatedRunArrays.empty())
+    G4Exception("TSRun", collName.c_str(), JustWarning,
+                "GetHitsMap failed to locate the requested AtomicHitsMap");
+  return nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+// Access AtomicHitsArray.
+// by full description of collection name, that is
+// <MultiFunctional Detector Name>/<Primitive Scorer Name>
+G4TAtomicHitsArray<G4double>* TSRun::GetAtomicHitsArray(
+  const G4String& collName) const
+{
+  for(unsigned i = 0; i < fCollNames.size(); ++i)
+  {
+    if(collName == fCollNames[i] && i < fAtomicRunArrays.size())
+      return fAtomicRunArrays[i];
+  }
+
+  if(fAtomicRunMaps.empty() && fCompensatedRunArrays.empty())
+    G4Exception("TSRun", collName.c_str(), JustWarning,
+                "GetHitsMap failed to locate the requested AtomicHitsArray");
+  return nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+// Access the compensated AtomicHitsArray.
+// by full description of collection name, that is
+// <MultiFunctional Detector Name>/<Primitive Scorer Name>
+TSRun::CompensatedHitsArray_t* TSRun::GetCompensatedHitsArray(
+  const G4String& collName) const
+{
+  for(unsigned i = 0; i < fCollNames.size(); ++i)
+  {
+    if(collName == fCollNames[i] && i < fCompensatedRunArrays.size())
+      return fCompensatedRunArrays[i];
+  }
+
+  if(fAtomicRunMaps.empty() && fAtomicRunArrays.empty())
+    G4Exception("TSRun", collName.c_str(), JustWarning,
+                "GetHitsMap failed to locate the requested AtomicHitsArray");
   return nullptr;
 }
 
@@ -331,7 +867,7 @@ G4StatContainer<G4StatAnalysis>* TSRun::GetStatMap(
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-G4StatContainer<G4ConvergenceTester>* TSRun::GetConvMap(
+G4StatContainer<TSConvergenceStats>* TSRun::GetConvMap(
   const G4String& collName) const
 {
   for(unsigned i = 0; i < fCollNames.size(); ++i)
@@ -341,6 +877,6 @@ G4StatContainer<G4ConvergenceTester>* TSRun::GetConvMap(
   }
 
   G4Exception("TSRun", collName.c_str(), JustWarning,
-              "GetHitsMap failed to locate the requested AtomicHitsMap");
+              "GetConvMap failed to locate the requested ConvMap");
   return nullptr;
 }
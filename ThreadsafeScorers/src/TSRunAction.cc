@@ -43,6 +43,7 @@
 #include "G4TaskRunManager.hh"
 
 #include "TSRun.hh"
+#include "TSContention.hh"
 #include "TSDetectorConstruction.hh"
 #include "G4StatAnalysis.hh"
 
@@ -51,11 +52,12 @@
 TSRunAction::TSRunAction()
   : fDetector(TSDetectorConstruction::Instance())
   , fName(fDetector->GetMFDName())
+  , fTimer(new G4Timer)
 {}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-TSRunAction::~TSRunAction() {}
+TSRunAction::~TSRunAction() { delete fTimer; }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
@@ -69,7 +71,10 @@ void TSRunAction::BeginOfRunAction(const G4Run* aRun)
   // G4RunManager::GetRunManager()->SetPrintProgress(
   //  (evts_to_process > 1000) ? evts_to_process / 1000 : 1);
   if(IsMaster() && aRun != nullptr)
+  {
     G4PrintEnv();
+    fTimer->Start();
+  }
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -92,6 +97,24 @@ void TSRunAction::EndOfRunAction(const G4Run* aRun)
 
     //- TSRun object.
     const TSRun* tsRun = static_cast<const TSRun*>(aRun);
+    //--- Sum the thread-local containers of the workers.
+    tsRun->Reduce();
+    tsRun->WriteSnapshot();
+    //--- Lock, CAS and merge counters of the run (TS_CONTENTION_COUNTERS).
+    TSContention::Report(G4cout);
+    //--- Time of the run and number of steps in the target.
+    fTimer->Stop();
+    G4double nsteps = 0.;
+    G4THitsMap<G4double>* stepmap =
+      tsRun->GetHitsMap(fName + "/NumberOfSteps");
+    if(stepmap)
+      for(auto itr = stepmap->begin(); itr != stepmap->end(); itr++)
+        nsteps += *itr->second;
+    G4cout << "TSRunAction: " << aRun->GetNumberOfEvent() << " events in "
+           << fTimer->GetRealElapsed() << " s, " << nsteps
+           << " steps in the target ("
+           << nsteps / std::max(aRun->GetNumberOfEvent(), 1)
+           << " per event)" << G4endl;
     //--- Dump all scored quantities involved in TSRun.
 
     //---------------------------------------------
@@ -101,6 +124,11 @@ void TSRunAction::EndOfRunAction(const G4Run* aRun)
     std::vector<G4String> fnames{ "mfd_tl", "mfd_tg" };
     std::vector<G4double> units{ CLHEP::eV, CLHEP::keV, 1, 1 };
     std::vector<G4String> unitstr{ "keV", "steps" };
+    if(fDetector->IsTrackLengthScoring())
+    {
+      primScorerNames.push_back("TrackLength");
+      unitstr.push_back("mm");
+    }
 
     //----------------------------------------------------------------------//
     // lambda to print double value
@@ -117,7 +145,7 @@ void TSRunAction::EndOfRunAction(const G4Run* aRun)
     //----------------------------------------------------------------------//
     // lambda to print statistics
     auto stat_print = [](std::ostream& fout, G4int first, G4StatAnalysis* stat,
-                         G4ConvergenceTester* conv, G4double unit1,
+                         TSConvergenceStats* conv, G4double unit1,
                          G4double unit2, G4String unit2str) {
       if(!stat || !conv)
         return;
@@ -133,7 +161,7 @@ void TSRunAction::EndOfRunAction(const G4Run* aRun)
       std::stringstream ss;
       ss << "    " << std::setw(10) << first << "    " << std::setw(15)
          << std::setprecision(6) << std::fixed << psecond << " " << unit2str;
-      // skip print of ConvergenceTester to stdout
+      // skip print of TSConvergenceStats to stdout
       G4cout << ss.str() << G4endl;
     };
     //----------------------------------------------------------------------//
@@ -155,7 +183,7 @@ void TSRunAction::EndOfRunAction(const G4Run* aRun)
             tsRun->GetHitsMap(fName + "/" + primScorerNames.at(i));
           G4StatContainer<G4StatAnalysis>* statmap =
             tsRun->GetStatMap(fName + "/" + primScorerNames.at(i));
-          G4StatContainer<G4ConvergenceTester>* convmap =
+          G4StatContainer<TSConvergenceStats>* convmap =
             tsRun->GetConvMap(fName + "/" + primScorerNames.at(i));
 
           if(hitmap && hitmap->size() != 0)
@@ -185,7 +213,7 @@ void TSRunAction::EndOfRunAction(const G4Run* aRun)
             {
               G4int _f                = statmap->GetIndex(itr);
               G4StatAnalysis* _s      = statmap->GetObject(itr);
-              G4ConvergenceTester* _c = convmap->GetObject(_f);
+              TSConvergenceStats* _c  = convmap->GetObject(_f);
               stat_print(statout, _f, _s, _c, units.at(i), units.at(i + 1),
                          unitstr.at(i));
             }
@@ -216,18 +244,33 @@ void TSRunAction::EndOfRunAction(const G4Run* aRun)
         }
         else
         {
+          auto record = [&](G4int id, G4double value) {
+            IDs.insert(id);
+            std::get<1>(fTypeCompare[primScorerNames.at(i)][id]) =
+              value / units.at(i);
+            print(fileout, id, value, units.at(i), units.at(i + 1),
+                  unitstr.at(i));
+          };
+
+          G4TAtomicHitsArray<G4double>* hitarray =
+            tsRun->GetAtomicHitsArray(fName + "/" + primScorerNames.at(i));
+          TSRun::CompensatedHitsArray_t* comparray =
+            tsRun->GetCompensatedHitsArray(fName + "/" +
+                                           primScorerNames.at(i));
           G4TAtomicHitsMap<G4double>* hitmap =
             tsRun->GetAtomicHitsMap(fName + "/" + primScorerNames.at(i));
-          if(hitmap && hitmap->size() != 0)
+          if(hitarray && hitarray->size() != 0)
+          {
+            hitarray->for_each(record);
+          }
+          else if(comparray && comparray->size() != 0)
+          {
+            comparray->for_each(record);
+          }
+          else if(hitmap && hitmap->size() != 0)
           {
             for(auto itr = hitmap->begin(); itr != hitmap->end(); itr++)
-            {
-              IDs.insert(itr->first);
-              std::get<1>(fTypeCompare[primScorerNames.at(i)][itr->first]) =
-                *itr->second / units.at(i);
-              print(fileout, itr->first, *itr->second, units.at(i),
-                    units.at(i + 1), unitstr.at(i));
-            }
+              record(itr->first, *itr->second);
           }
           else
           {
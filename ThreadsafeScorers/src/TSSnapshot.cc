@@ -0,0 +1,366 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file parallel/ThreadsafeScorers/src/TSSnapshot.cc
+/// \brief Implementation of the TSSnapshot class
+//
+//
+//
+//
+/// File layout (native byte order):
+///     "TSSNAP" magic, version, byte-order mark, sizeof(G4StatAnalysis),
+///     number of events, the sources as a count followed by (job seed, run
+///     seed, thread) triplets, the engine state as a count followed by its
+///     words, number of sections, then per section its name and
+///     the run, stat, convergence, atomic and mutex entries, each as a
+///     count followed by (copy number, value) pairs.
+//
+//
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#include "TSSnapshot.hh"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+namespace
+{
+  const char magic[8]            = "TSSNAP";
+  const std::uint32_t version    = 2;
+  const std::uint32_t byte_order = 0x01020304;
+
+  static_assert(std::is_trivially_copyable<G4StatAnalysis>::value,
+                "G4StatAnalysis is stored as its object representation");
+
+  // smallest stored size of a source, a section and the entries
+  const std::uint64_t source_bytes  = 8 + 8 + 4;
+  const std::uint64_t section_bytes = 8 + 5 * 8;
+  const std::uint64_t value_bytes   = 4 + sizeof(G4double);
+  const std::uint64_t stat_bytes    = 4 + sizeof(G4StatAnalysis);
+  const std::uint64_t conv_bytes    = 4 + 3 * sizeof(G4long);
+
+  template <typename T>
+  void write_pod(std::ostream& os, const T& val)
+  {
+    os.write(reinterpret_cast<const char*>(&val), sizeof(T));
+  }
+
+  template <typename T>
+  void read_pod(std::istream& is, T& val)
+  {
+    is.read(reinterpret_cast<char*>(&val), sizeof(T));
+  }
+
+  // reads a count of entries of at least entry_bytes each, and fails the
+  // stream if they cannot fit in what is left of a file of size bytes
+  std::uint64_t read_count(std::istream& is, std::uint64_t size,
+                           std::uint64_t entry_bytes)
+  {
+    std::uint64_t n = 0;
+    read_pod(is, n);
+    std::streamoff pos = is.tellg();
+    if(!is || pos < 0 || n > (size - pos) / entry_bytes)
+    {
+      is.setstate(std::ios::failbit);
+      return 0;
+    }
+    return n;
+  }
+
+  void write_values(std::ostream& os, const TSSnapshot::ValueMap_t& values)
+  {
+    write_pod(os, static_cast<std::uint64_t>(values.size()));
+    for(const auto& itr : values)
+    {
+      write_pod(os, static_cast<std::int32_t>(itr.first));
+      write_pod(os, itr.second);
+    }
+  }
+
+  void read_values(std::istream& is, std::uint64_t size,
+                   TSSnapshot::ValueMap_t& values)
+  {
+    std::uint64_t n = read_count(is, size, value_bytes);
+    for(std::uint64_t i = 0; i < n; ++i)
+    {
+      std::int32_t key = 0;
+      G4double val     = 0.0;
+      read_pod(is, key);
+      read_pod(is, val);
+      if(!is)
+        return;
+      values[key] = val;
+    }
+  }
+
+  void add_values(TSSnapshot::ValueMap_t& lhs,
+                  const TSSnapshot::ValueMap_t& rhs)
+  {
+    for(const auto& itr : rhs)
+      lhs[itr.first] += itr.second;
+  }
+}  // namespace
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+TSSnapshot::Section_t& TSSnapshot::Section_t::operator+=(const Section_t& rhs)
+{
+  add_values(fRunValues, rhs.fRunValues);
+  for(const auto& itr : rhs.fStats)
+    fStats[itr.first] += itr.second;
+  for(const auto& itr : rhs.fConv)
+    fConv[itr.first] += itr.second;
+  add_values(fAtomicValues, rhs.fAtomicValues);
+  add_values(fMutexValues, rhs.fMutexValues);
+  return *this;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+TSSnapshot::Section_t& TSSnapshot::GetSection(const G4String& name)
+{
+  for(auto& itr : fSections)
+    if(itr.fName == name)
+      return itr;
+  fSections.push_back(Section_t());
+  fSections.back().fName = name;
+  return fSections.back();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+TSSnapshot& TSSnapshot::operator+=(const TSSnapshot& rhs)
+{
+  if(fSources.empty() && fEvents == 0)
+    fEngineState = rhs.fEngineState;
+  else if(fEngineState != rhs.fEngineState)
+    fEngineState.clear();
+  fSources.insert(fSources.end(), rhs.fSources.begin(), rhs.fSources.end());
+  fEvents += rhs.fEvents;
+  for(const auto& itr : rhs.fSections)
+    GetSection(itr.fName) += itr;
+  return *this;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool TSSnapshot::Overlaps(const TSSnapshot& rhs) const
+{
+  // the checkpoints of the workers of a run are distinct histories, but a
+  // run overlaps all of its checkpoints
+  for(const auto& lhs_src : fSources)
+    for(const auto& rhs_src : rhs.fSources)
+      if(lhs_src.fRunSeed == rhs_src.fRunSeed &&
+         (lhs_src.fThread == rhs_src.fThread || lhs_src.fThread < 0 ||
+          rhs_src.fThread < 0))
+        return true;
+  return false;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool TSSnapshot::Write(const G4String& path) const
+{
+  G4String tmp = path + ".tmp";
+  std::ofstream os(tmp, std::ios::binary | std::ios::trunc);
+  if(!os)
+  {
+    G4Exception("TSSnapshot", "000", JustWarning,
+                G4String("cannot open " + tmp + " for writing").c_str());
+    return false;
+  }
+
+  os.write(magic, sizeof(magic));
+  write_pod(os, version);
+  write_pod(os, byte_order);
+  write_pod(os, static_cast<std::uint32_t>(sizeof(G4StatAnalysis)));
+  write_pod(os, static_cast<std::int64_t>(fEvents));
+  write_pod(os, static_cast<std::uint64_t>(fSources.size()));
+  for(const auto& itr : fSources)
+  {
+    write_pod(os, static_cast<std::int64_t>(itr.fJobSeed));
+    write_pod(os, static_cast<std::int64_t>(itr.fRunSeed));
+    write_pod(os, static_cast<std::int32_t>(itr.fThread));
+  }
+  write_pod(os, static_cast<std::uint64_t>(fEngineState.size()));
+  for(auto itr : fEngineState)
+    write_pod(os, static_cast<std::uint64_t>(itr));
+  write_pod(os, static_cast<std::uint64_t>(fSections.size()));
+
+  for(const auto& sec : fSections)
+  {
+    write_pod(os, static_cast<std::uint64_t>(sec.fName.length()));
+    os.write(sec.fName.data(), sec.fName.length());
+
+    write_values(os, sec.fRunValues);
+
+    write_pod(os, static_cast<std::uint64_t>(sec.fStats.size()));
+    for(const auto& itr : sec.fStats)
+    {
+      write_pod(os, static_cast<std::int32_t>(itr.first));
+      os.write(reinterpret_cast<const char*>(&itr.second),
+               sizeof(G4StatAnalysis));
+    }
+
+    write_pod(os, static_cast<std::uint64_t>(sec.fConv.size()));
+    for(const auto& itr : sec.fConv)
+    {
+      write_pod(os, static_cast<std::int32_t>(itr.first));
+      itr.second.Write(os);
+    }
+
+    write_values(os, sec.fAtomicValues);
+    write_values(os, sec.fMutexValues);
+  }
+
+  os.close();
+  if(!os || std::rename(tmp.c_str(), path.c_str()) != 0)
+  {
+    G4Exception("TSSnapshot", "001", JustWarning,
+                G4String("failed writing " + path).c_str());
+    return false;
+  }
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool TSSnapshot::Read(const G4String& path)
+{
+  fEvents = 0;
+  fSources.clear();
+  fEngineState.clear();
+  fSections.clear();
+
+  std::ifstream is(path, std::ios::binary);
+  auto fail = [&](const G4String& msg) {
+    G4Exception("TSSnapshot", "002", JustWarning,
+                G4String(path + ": " + msg).c_str());
+    fEvents = 0;
+    fSources.clear();
+    fEngineState.clear();
+    fSections.clear();
+    return false;
+  };
+
+  if(!is)
+    return fail("cannot open for reading");
+
+  // the counts read below are bounded by the size of the file
+  is.seekg(0, std::ios::end);
+  std::streamoff file_size = is.tellg();
+  is.seekg(0, std::ios::beg);
+  if(!is || file_size < 0)
+    return fail("cannot determine the size");
+  std::uint64_t size = static_cast<std::uint64_t>(file_size);
+
+  char file_magic[sizeof(magic)];
+  std::uint32_t file_version = 0, file_order = 0, file_stat_size = 0;
+  is.read(file_magic, sizeof(file_magic));
+  read_pod(is, file_version);
+  read_pod(is, file_order);
+  read_pod(is, file_stat_size);
+  if(!is || std::memcmp(file_magic, magic, sizeof(magic)) != 0)
+    return fail("not a TSSnapshot file");
+  if(file_version != version)
+    return fail("unsupported version " + std::to_string(file_version));
+  if(file_order != byte_order)
+    return fail("written with another byte order");
+  if(file_stat_size != sizeof(G4StatAnalysis))
+    return fail("written with another G4StatAnalysis layout");
+
+  std::int64_t events = 0;
+  read_pod(is, events);
+  fEvents = events;
+  std::uint64_t nsource = read_count(is, size, source_bytes);
+  for(std::uint64_t i = 0; i < nsource && is; ++i)
+  {
+    std::int64_t job_seed = 0, run_seed = 0;
+    std::int32_t thread   = 0;
+    read_pod(is, job_seed);
+    read_pod(is, run_seed);
+    read_pod(is, thread);
+    if(is)
+      fSources.push_back({ job_seed, run_seed, thread });
+  }
+  std::uint64_t nword = read_count(is, size, 8);
+  for(std::uint64_t i = 0; i < nword && is; ++i)
+  {
+    std::uint64_t word = 0;
+    read_pod(is, word);
+    if(is)
+      fEngineState.push_back(word);
+  }
+  std::uint64_t nsection = read_count(is, size, section_bytes);
+
+  for(std::uint64_t s = 0; s < nsection && is; ++s)
+  {
+    std::uint64_t len = read_count(is, size, 1);
+    std::string name(len, '\0');
+    is.read(&name[0], len);
+    if(!is)
+      break;
+    Section_t& sec = GetSection(name);
+
+    read_values(is, size, sec.fRunValues);
+
+    std::uint64_t n = read_count(is, size, stat_bytes);
+    for(std::uint64_t i = 0; i < n && is; ++i)
+    {
+      std::int32_t key = 0;
+      G4StatAnalysis stat;
+      read_pod(is, key);
+      is.read(reinterpret_cast<char*>(&stat), sizeof(G4StatAnalysis));
+      if(is)
+        sec.fStats[key] = stat;
+    }
+
+    n = read_count(is, size, conv_bytes);
+    for(std::uint64_t i = 0; i < n && is; ++i)
+    {
+      std::int32_t key = 0;
+      TSConvergenceStats conv;
+      read_pod(is, key);
+      conv.Read(is);
+      if(is)
+        sec.fConv[key] = conv;
+    }
+
+    read_values(is, size, sec.fAtomicValues);
+    read_values(is, size, sec.fMutexValues);
+  }
+
+  if(!is)
+    return fail("truncated");
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -56,6 +56,8 @@
 #include "TSDetectorConstruction.hh"
 #include "TSPhysicsList.hh"
 
+#include "EventDispatchTuner.hh"
+
 #include "G4TiMemory.hh"
 #include "G4UIExecutive.hh"
 #include "G4UImanager.hh"
@@ -74,6 +76,8 @@ void message(G4RunManager* runmanager)
   if(man)
   {
     man->SetNumberOfThreads(G4Threading::G4GetNumberOfCores());
+    // event modulo and task grain size tuned from measured event times
+    man->SetUserInitialization(new EventDispatchTuner("ts_scorers"));
     G4cout << "\n\n\t--> Running in multithreaded mode with "
            << man->GetNumberOfThreads() << " threads\n\n"
            << G4endl;
@@ -101,7 +105,8 @@ int main(int argc, char** argv)
   if(macro.empty())
     ui = new G4UIExecutive(argc, argv);
 
-  // Set the random seed
+  // Set the random seed; with TS_SEED set, TSRun reseeds each run from the
+  // sequence of TS_SEED instead
   CLHEP::HepRandom::setTheSeed(1245214UL);
 
 #if defined(GEANT4_USE_TIMEMORY)
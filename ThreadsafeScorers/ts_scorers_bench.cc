@@ -0,0 +1,666 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file parallel/ThreadsafeScorers/ts_scorers_bench.cc
+/// \brief Contention benchmark of the ThreadsafeScorers accumulation types
+//
+//
+//
+//
+/// ts_scorers_bench replays synthetic event hits maps through each of the
+///     run-level accumulation strategies of TSRun::RecordEvent, without any
+///     transport, and reports the throughput and the memory of the run-level
+///     containers for every combination of thread count, number of target
+///     sections and hits per event:
+///
+///     thread_local    G4THitsMap per thread, summed on the master at the end
+///     stat_local      G4StatContainer<G4StatAnalysis> per thread, summed
+///     conv_local      G4StatContainer<TSConvergenceStats> per thread, summed
+///     atomic_map      one G4TAtomicHitsMap shared by the threads
+///     atomic_array    one G4TAtomicHitsArray shared by the threads
+///     atomic_shard    one G4TAtomicHitsArray per socket, summed at the end
+///                     (only with TS_NUMA_EXPERIMENTAL=ON)
+///     compensated     one G4TAtomicHitsArray of G4atomic_compensated
+///     mutex           one std::map guarded by a mutex
+///     conv_mutex      one G4StatContainer<G4ConvergenceTester>, mutex
+///
+/// Usage: ts_scorers_bench [options]
+///     -t 1,2,4            thread counts (default: powers of 2 up to cores)
+///     -s 3,5,10,20        target sections per dimension (default: 3,5,10,20)
+///     -n 1,10,100         hits per event (default: 1,10,100)
+///     -e events           events per configuration (default: 100000)
+///     -x strategy,...     strategies to run (default: all)
+///     --csv file          write the results as CSV (default: stdout)
+///     --json file         write the results as JSON
+///
+/// Throughput is in hits per second, including the end-of-run merge of the
+///     thread-local strategies, where a hit is an entry of an event hits map:
+///     hits of an event that fall on the same target are one entry, so with
+///     few targets fewer than hits_per_event are added per event. Memory is
+///     the estimated footprint of the run-level containers summed over the
+///     threads. Each configuration runs in its own child process, whose peak
+///     RSS is reported alongside; it includes the small, constant footprint
+///     of the benchmark process at the fork.
+/// The atomic map is filled with every key before the timed loop, since
+///     G4TAtomicHitsMap does not support concurrent insertion of new keys.
+/// When configured with TS_CONTENTION_COUNTERS=ON, the lock, CAS and
+///     insertion counters of each configuration are printed to stderr.
+/// The threads are pinned by the TS_AFFINITY policy (see TSAffinity), which
+///     is reported with the results instead of per thread, and allocate
+///     their events and thread-local containers themselves, after pinning.
+///     Without TS_NUMA_EXPERIMENTAL=ON the policy is always none.
+//
+//
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#include "G4Types.hh"
+#include "G4Threading.hh"
+#include "G4AutoLock.hh"
+#include "G4THitsMap.hh"
+#include "G4TAtomicHitsMap.hh"
+#include "G4TAtomicHitsArray.hh"
+#include "G4atomic_compensated.hh"
+#include "G4StatAnalysis.hh"
+#include "G4ConvergenceTester.hh"
+#include "TSAffinity.hh"
+#include "TSContention.hh"
+#include "TSRun.hh"
+
+#include <sys/resource.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+namespace
+{
+  typedef G4THitsMap<G4double> EventMap_t;
+
+  struct Config
+  {
+    G4int threads;
+    G4int sections;
+    G4int hits;
+    G4long events;
+  };
+
+  struct Result
+  {
+    std::string strategy;
+    Config config;
+    G4double seconds;
+    G4long hits;
+    G4double throughput;
+    size_t bytes;
+    long peak_rss_kb;
+  };
+
+  const char* policy_name()
+  {
+    switch(TSAffinity::GetPolicy())
+    {
+      case TSAffinity::kCompact:
+        return "compact";
+      case TSAffinity::kScatter:
+        return "scatter";
+      default:
+        return "none";
+    }
+  }
+
+  // approximate heap footprint of a std::map node holding _Tp
+  template <typename _Tp>
+  constexpr size_t map_node_bytes()
+  {
+    return 4 * sizeof(void*) + sizeof(std::pair<const G4int, _Tp>);
+  }
+
+  //--------------------------------------------------------------------------//
+  // pre-generated event maps per thread, so the timed loop does not include
+  // the random number generation
+  std::vector<EventMap_t*> make_events(const Config& cfg, G4int tid)
+  {
+    static const G4int pool = 64;
+    G4int targets           = cfg.sections * cfg.sections * cfg.sections;
+    std::mt19937_64 rng(1245214UL + tid);
+    std::uniform_int_distribution<G4int> key(0, targets - 1);
+    std::exponential_distribution<G4double> edep(1.0);
+
+    std::vector<EventMap_t*> events;
+    for(G4int i = 0; i < pool; ++i)
+    {
+      auto evt = new EventMap_t("Target_MFD", "EnergyDeposit");
+      for(G4int j = 0; j < cfg.hits; ++j)
+      {
+        G4double value = edep(rng);
+        evt->add(key(rng), value);
+      }
+      events.push_back(evt);
+    }
+    return events;
+  }
+
+  // entries of the event hits maps processed by the last run_threads call
+  G4long hits_added = 0;
+
+  //--------------------------------------------------------------------------//
+  // runs func(tid, event) for the events of this configuration split over
+  // the threads, and returns the wall time from the release of the threads
+  // until they have all finished. Each thread is pinned, then calls
+  // init(tid) and generates its events before the timed loop.
+  G4double run_threads(const Config& cfg,
+                       const std::function<void(G4int, EventMap_t&)>& func,
+                       const std::function<void(G4int)>& init = nullptr)
+  {
+    std::vector<std::vector<EventMap_t*>> events(cfg.threads);
+    std::vector<G4long> added(cfg.threads, 0);
+
+    std::atomic<G4int> ready(0);
+    std::atomic<G4bool> go(false);
+    std::vector<std::thread> threads;
+    for(G4int i = 0; i < cfg.threads; ++i)
+    {
+      G4long nevt = cfg.events / cfg.threads + (i < cfg.events % cfg.threads);
+      threads.emplace_back([&, i, nevt]() {
+        G4Threading::G4SetThreadId(i);
+        TSAffinity::Pin(i);
+        if(init)
+          init(i);
+        events.at(i) = make_events(cfg, i);
+        for(G4long n = 0; n < nevt; ++n)
+          added[i] += events[i][n % events[i].size()]->size();
+        ++ready;
+        while(!go.load(std::memory_order_acquire))
+          std::this_thread::yield();
+        auto& pool = events.at(i);
+        for(G4long n = 0; n < nevt; ++n)
+          func(i, *pool[n % pool.size()]);
+      });
+    }
+
+    while(ready.load() < cfg.threads)
+      std::this_thread::yield();
+    auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    for(auto& itr : threads)
+      itr.join();
+    std::chrono::duration<G4double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+    for(auto& itr : events)
+      for(auto& evt : itr)
+        delete evt;
+    hits_added = 0;
+    for(auto& itr : added)
+      hits_added += itr;
+    return elapsed.count();
+  }
+
+  //--------------------------------------------------------------------------//
+  // returns the wall time and sets the container footprint
+  typedef std::function<G4double(const Config&, size_t&)> Strategy_t;
+
+  G4double thread_local_maps(const Config& cfg, size_t& bytes)
+  {
+    std::vector<EventMap_t*> maps(cfg.threads, nullptr);
+    G4double seconds = run_threads(
+      cfg, [&](G4int tid, EventMap_t& evt) { *maps[tid] += evt; },
+      [&](G4int tid) {
+        maps[tid] = new EventMap_t("Target_MFD", "EnergyDeposit");
+      });
+
+    // merge on the "master", as G4Run::Merge does
+    auto start = std::chrono::steady_clock::now();
+    EventMap_t master("Target_MFD", "EnergyDeposit");
+    for(auto& itr : maps)
+      master += *itr;
+    std::chrono::duration<G4double> merge =
+      std::chrono::steady_clock::now() - start;
+
+    bytes = 0;
+    for(auto& itr : maps)
+    {
+      bytes += itr->size() * (map_node_bytes<G4double*>() + sizeof(G4double));
+      delete itr;
+    }
+    return seconds + merge.count();
+  }
+
+  // heap memory of a run-level statistics object, at most
+  template <typename T>
+  size_t heap_bytes()
+  {
+    return 0;
+  }
+
+  template <>
+  size_t heap_bytes<TSConvergenceStats>()
+  {
+    // chart snapshots and largest scores, within the default budget
+    size_t tail = TSConvergenceStats::GetTailCapacity();
+    return (tail > 0) ? TSConvergenceStats::DetailBytes(tail) : 0;
+  }
+
+  template <typename T>
+  G4double thread_local_stats(const Config& cfg, size_t& bytes)
+  {
+    G4int targets = cfg.sections * cfg.sections * cfg.sections;
+    std::vector<G4StatContainer<T>*> maps(cfg.threads, nullptr);
+    G4double seconds = run_threads(
+      cfg, [&](G4int tid, EventMap_t& evt) { *maps[tid] += evt; },
+      [&](G4int tid) {
+        maps[tid] =
+          new G4StatContainer<T>("Target_MFD", "EnergyDeposit", targets);
+      });
+
+    auto start = std::chrono::steady_clock::now();
+    G4StatContainer<T> master("Target_MFD", "EnergyDeposit", targets);
+    for(auto& itr : maps)
+      master += *itr;
+    std::chrono::duration<G4double> merge =
+      std::chrono::steady_clock::now() - start;
+
+    bytes = 0;
+    for(auto& itr : maps)
+    {
+      for(auto sitr = itr->begin(); sitr != itr->end(); ++sitr)
+        bytes +=
+          sizeof(T*) + ((*sitr) ? sizeof(T) + heap_bytes<T>() : 0);
+      delete itr;
+    }
+    return seconds + merge.count();
+  }
+
+  G4double atomic_map(const Config& cfg, size_t& bytes)
+  {
+    G4int targets = cfg.sections * cfg.sections * cfg.sections;
+    G4TAtomicHitsMap<G4double> map("Target_MFD", "EnergyDeposit");
+    for(G4int i = 0; i < targets; ++i)
+    {
+      G4double zero = 0.0;
+      map.set(i, zero);
+    }
+    G4double seconds =
+      run_threads(cfg, [&](G4int, EventMap_t& evt) { map += evt; });
+    bytes = map.size() * (map_node_bytes<G4atomic<G4double>*>() +
+                          sizeof(G4atomic<G4double>));
+    return seconds;
+  }
+
+  G4double atomic_array(const Config& cfg, size_t& bytes)
+  {
+    G4int targets = cfg.sections * cfg.sections * cfg.sections;
+    G4TAtomicHitsArray<G4double> array("Target_MFD", "EnergyDeposit",
+                                       targets);
+    G4double seconds =
+      run_threads(cfg, [&](G4int, EventMap_t& evt) { array += evt; });
+    size_t stride = (array.padded())
+                      ? G4TAtomicHitsArray<G4double>::CacheLineSize
+                      : sizeof(std::atomic<G4double>);
+    bytes = targets * stride;
+    return seconds;
+  }
+
+#if defined(TS_NUMA)
+  G4double atomic_shards(const Config& cfg, size_t& bytes)
+  {
+    G4int targets = cfg.sections * cfg.sections * cfg.sections;
+    std::vector<G4TAtomicHitsArray<G4double>*> shards(
+      TSAffinity::GetNumberOfSockets(), nullptr);
+    std::vector<G4TAtomicHitsArray<G4double>*> local(cfg.threads, nullptr);
+    G4Mutex mtx;
+    G4double seconds = run_threads(
+      cfg, [&](G4int tid, EventMap_t& evt) { *local[tid] += evt; },
+      [&](G4int tid) {
+        // the first thread of a socket allocates its shard
+        G4AutoLock lock(&mtx);
+        auto& shard = shards.at(TSAffinity::GetSocket());
+        if(!shard)
+          shard = new G4TAtomicHitsArray<G4double>("Target_MFD",
+                                                   "EnergyDeposit", targets);
+        local[tid] = shard;
+      });
+
+    // sum of the shards, as TSRun::Reduce does
+    auto start = std::chrono::steady_clock::now();
+    G4TAtomicHitsArray<G4double> total("Target_MFD", "EnergyDeposit",
+                                       targets);
+    for(auto& itr : shards)
+      if(itr)
+        itr->for_each(
+          [&](G4int key, G4double value) { total.add(key, value); });
+    std::chrono::duration<G4double> merge =
+      std::chrono::steady_clock::now() - start;
+
+    size_t stride = (total.padded())
+                      ? G4TAtomicHitsArray<G4double>::CacheLineSize
+                      : sizeof(std::atomic<G4double>);
+    bytes = 0;
+    for(auto& itr : shards)
+    {
+      if(itr)
+        bytes += targets * stride;
+      delete itr;
+    }
+    return seconds + merge.count();
+  }
+#endif
+
+  G4double compensated_array(const Config& cfg, size_t& bytes)
+  {
+    typedef G4atomic_compensated<G4double> Acc_t;
+    G4int targets = cfg.sections * cfg.sections * cfg.sections;
+    G4TAtomicHitsArray<G4double, Acc_t> array("Target_MFD", "EnergyDeposit",
+                                              targets);
+    G4double seconds =
+      run_threads(cfg, [&](G4int, EventMap_t& evt) { array += evt; });
+    size_t stride = (array.padded())
+                      ? G4TAtomicHitsArray<G4double, Acc_t>::CacheLineSize
+                      : sizeof(Acc_t);
+    bytes = targets * stride;
+    return seconds;
+  }
+
+  G4double mutex_map(const Config& cfg, size_t& bytes)
+  {
+    std::map<G4int, G4double> map;
+    G4Mutex mtx;
+    G4double seconds = run_threads(cfg, [&](G4int, EventMap_t& evt) {
+      G4AutoLock lock(&mtx);
+      for(const auto& itr : evt)
+        map[itr.first] += *itr.second;
+    });
+    bytes = map.size() * map_node_bytes<G4double>();
+    return seconds;
+  }
+
+  G4double mutex_conv(const Config& cfg, size_t& bytes)
+  {
+    G4int targets = cfg.sections * cfg.sections * cfg.sections;
+    G4StatContainer<G4ConvergenceTester> map("Target_MFD", "EnergyDeposit",
+                                             targets);
+    G4Mutex mtx;
+    G4double seconds = run_threads(cfg, [&](G4int, EventMap_t& evt) {
+      G4AutoLock lock(&mtx);
+      map += evt;
+    });
+    // the tester keeps every score, so its memory grows with the events
+    bytes = 0;
+    for(auto itr = map.begin(); itr != map.end(); ++itr)
+      bytes += sizeof(G4ConvergenceTester*) +
+               ((*itr) ? sizeof(G4ConvergenceTester) : 0);
+    bytes += hits_added * sizeof(G4double);
+    return seconds;
+  }
+
+  //--------------------------------------------------------------------------//
+  // runs a strategy in a child process, so that the peak RSS of each
+  // configuration is its own rather than the peak of the configurations
+  // before it. Returns false if the child failed.
+  G4bool run_isolated(const Strategy_t& strategy, Result& r)
+  {
+    struct Output
+    {
+      G4double seconds;
+      size_t bytes;
+      G4long hits;
+    };
+
+    G4int fds[2];
+    if(pipe(fds) != 0)
+      return false;
+    std::cout.flush();
+    pid_t pid = fork();
+    if(pid < 0)
+      return false;
+    if(pid == 0)
+    {
+      close(fds[0]);
+      Output out{ 0.0, 0, 0 };
+      out.seconds = strategy(r.config, out.bytes);
+      out.hits    = hits_added;
+      TSContention::Report(std::cerr);
+      G4bool ok = write(fds[1], &out, sizeof(out)) == sizeof(out);
+      _exit(ok ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
+    close(fds[1]);
+    Output out{ 0.0, 0, 0 };
+    G4bool ok = read(fds[0], &out, sizeof(out)) == sizeof(out);
+    close(fds[0]);
+    G4int status = 0;
+    struct rusage usage;
+    ok = (wait4(pid, &status, 0, &usage) == pid) && ok && WIFEXITED(status) &&
+         WEXITSTATUS(status) == EXIT_SUCCESS;
+    if(!ok)
+      return false;
+
+    r.seconds     = out.seconds;
+    r.bytes       = out.bytes;
+    r.hits        = out.hits;
+    r.throughput  = out.hits / out.seconds;
+    r.peak_rss_kb = usage.ru_maxrss;
+    return true;
+  }
+
+  std::vector<G4int> parse_list(const std::string& arg)
+  {
+    std::vector<G4int> values;
+    std::stringstream ss(arg);
+    std::string item;
+    while(std::getline(ss, item, ','))
+      values.push_back(std::stoi(item));
+    return values;
+  }
+
+  std::vector<std::string> split(const std::string& arg)
+  {
+    std::vector<std::string> values;
+    std::stringstream ss(arg);
+    std::string item;
+    while(std::getline(ss, item, ','))
+      values.push_back(item);
+    return values;
+  }
+
+  void write_csv(std::ostream& os, const std::vector<Result>& results)
+  {
+    os << "strategy,threads,sections,targets,hits_per_event,events,seconds,"
+          "hits,hits_per_second,bytes,peak_rss_kb,affinity,sockets\n";
+    for(const auto& r : results)
+      os << r.strategy << "," << r.config.threads << "," << r.config.sections
+         << ","
+         << r.config.sections * r.config.sections * r.config.sections << ","
+         << r.config.hits << "," << r.config.events << "," << r.seconds << ","
+         << r.hits << "," << r.throughput << "," << r.bytes << ","
+         << r.peak_rss_kb << ","
+         << policy_name() << "," << TSAffinity::GetNumberOfSockets() << "\n";
+  }
+
+  void write_json(std::ostream& os, const std::vector<Result>& results)
+  {
+    os << "[\n";
+    for(size_t i = 0; i < results.size(); ++i)
+    {
+      const auto& r = results.at(i);
+      os << "  { \"strategy\": \"" << r.strategy
+         << "\", \"threads\": " << r.config.threads
+         << ", \"sections\": " << r.config.sections << ", \"targets\": "
+         << r.config.sections * r.config.sections * r.config.sections
+         << ", \"hits_per_event\": " << r.config.hits
+         << ", \"events\": " << r.config.events
+         << ", \"seconds\": " << r.seconds << ", \"hits\": " << r.hits
+         << ", \"hits_per_second\": " << r.throughput
+         << ", \"bytes\": " << r.bytes
+         << ", \"peak_rss_kb\": " << r.peak_rss_kb
+         << ", \"affinity\": \"" << policy_name()
+         << "\", \"sockets\": " << TSAffinity::GetNumberOfSockets() << " }"
+         << ((i + 1 < results.size()) ? "," : "") << "\n";
+    }
+    os << "]\n";
+  }
+}  // namespace
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+int main(int argc, char** argv)
+{
+  std::vector<G4int> threads;
+  for(G4int n = 1; n < G4Threading::G4GetNumberOfCores(); n *= 2)
+    threads.push_back(n);
+  threads.push_back(G4Threading::G4GetNumberOfCores());
+  std::vector<G4int> sections{ 3, 5, 10, 20 };
+  std::vector<G4int> hits{ 1, 10, 100 };
+  G4long events = 100000;
+  std::string csv, json;
+
+  std::vector<std::pair<std::string, Strategy_t>> strategies{
+    { "thread_local", thread_local_maps },
+    { "stat_local", thread_local_stats<G4StatAnalysis> },
+    { "conv_local", thread_local_stats<TSConvergenceStats> },
+    { "atomic_map", atomic_map },
+    { "atomic_array", atomic_array },
+#if defined(TS_NUMA)
+    { "atomic_shard", atomic_shards },
+#endif
+    { "compensated", compensated_array },
+    { "mutex", mutex_map },
+    { "conv_mutex", mutex_conv }
+  };
+  std::vector<std::string> selected;
+
+  // std::stoi and std::stol throw std::invalid_argument and
+  // std::out_of_range on values that are not numbers
+  try
+  {
+    for(G4int i = 1; i < argc; ++i)
+    {
+      std::string arg = argv[i];
+      auto next       = [&]() -> std::string {
+        if(++i >= argc)
+          throw std::invalid_argument("missing value after " + arg);
+        return argv[i];
+      };
+      if(arg == "-t")
+        threads = parse_list(next());
+      else if(arg == "-s")
+        sections = parse_list(next());
+      else if(arg == "-n")
+        hits = parse_list(next());
+      else if(arg == "-e")
+        events = std::stol(next());
+      else if(arg == "-x")
+        selected = split(next());
+      else if(arg == "--csv")
+        csv = next();
+      else if(arg == "--json")
+        json = next();
+      else
+        throw std::invalid_argument("unknown option " + arg);
+    }
+    for(const auto& list : { threads, sections, hits })
+      for(auto value : list)
+        if(value <= 0)
+          throw std::invalid_argument("counts must be positive");
+    if(events <= 0)
+      throw std::invalid_argument("events must be positive");
+  }
+  catch(const std::logic_error& e)
+  {
+    std::cerr << argv[0] << ": " << e.what() << "\n"
+              << "usage: " << argv[0] << " [-t threads,...] "
+              << "[-s sections,...] [-n hits,...] [-e events] "
+              << "[-x strategy,...] [--csv file] [--json file]" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // the CSV may go to stdout
+  TSAffinity::SetVerbose(false);
+
+  std::vector<Result> results;
+  for(const auto& strategy : strategies)
+  {
+    if(!selected.empty() &&
+       std::find(selected.begin(), selected.end(), strategy.first) ==
+         selected.end())
+      continue;
+    for(auto nsec : sections)
+      for(auto nhit : hits)
+        for(auto nthr : threads)
+        {
+          Result r{ strategy.first, { nthr, nsec, nhit, events }, 0.0, 0, 0.0,
+                    0, 0 };
+          if(!run_isolated(strategy.second, r))
+          {
+            std::cerr << "  " << std::setw(12) << r.strategy << "  threads "
+                      << std::setw(3) << nthr << "  targets " << std::setw(6)
+                      << nsec * nsec * nsec << "  hits/event " << std::setw(4)
+                      << nhit << "  failed" << std::endl;
+            continue;
+          }
+          results.push_back(r);
+          std::cerr << "  " << std::setw(12) << r.strategy << "  threads "
+                    << std::setw(3) << nthr << "  targets " << std::setw(6)
+                    << nsec * nsec * nsec << "  hits/event " << std::setw(4)
+                    << nhit << "  " << std::setw(12) << r.throughput
+                    << " hits/s" << std::endl;
+        }
+  }
+
+  if(csv.empty())
+    write_csv(std::cout, results);
+  else
+  {
+    std::ofstream out(csv);
+    write_csv(out, results);
+  }
+  if(!json.empty())
+  {
+    std::ofstream out(json);
+    write_json(out, results);
+  }
+
+  return EXIT_SUCCESS;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,243 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file parallel/ThreadsafeScorers/ts_scorers_merge.cc
+/// \brief Sum of TSRun snapshots from independent jobs
+//
+//
+//
+//
+/// ts_scorers_merge sums the TSSnapshot files written by ts_scorers (see
+///     TS_SNAPSHOT and TS_CHECKPOINT_EVENTS in TSRun) by independent jobs,
+///     e.g. on several nodes, into one snapshot, and prints the number of
+///     events and the totals of each section. The result can be merged
+///     again, or used to start a new run with TS_RESUME.
+///
+/// Usage: ts_scorers_merge [-o output.tssnap] input.tssnap...
+///        ts_scorers_merge --compare reference.tssnap test.tssnap
+///
+/// The snapshots are summed in the order given, with the operations of
+///     TSRun::Merge, so the sums only differ from the ones of a single job
+///     by the order of the floating-point additions. An input that holds
+///     histories of the same run and worker as a previous one (see
+///     TSSnapshot::Overlaps), e.g. the snapshots of two jobs run with the
+///     same TS_SEED, or a run and one of its checkpoints, is refused.
+/// With --compare, the sections common to both snapshots are compared per
+///     event: the ratio of the totals and, for each copy number, the
+///     difference in units of the combined statistical error of the
+///     G4StatAnalysis entries. E.g. to validate a scoring mode against the
+///     reference one, about 95% of the copy numbers should agree within 2
+///     sigma and chi2/ndf should be close to 1.
+//
+//
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#include "globals.hh"
+#include "TSSnapshot.hh"
+
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+namespace
+{
+  int compare(const std::string& ref_file, const std::string& test_file)
+  {
+    TSSnapshot ref, test;
+    if(!ref.Read(ref_file) || !test.Read(test_file))
+      return EXIT_FAILURE;
+
+    G4double nref  = std::max<G4long>(ref.GetNumberOfEvents(), 1);
+    G4double ntest = std::max<G4long>(test.GetNumberOfEvents(), 1);
+    std::cout << "reference: " << ref_file << ", " << ref.GetNumberOfEvents()
+              << " events\n"
+              << "test:      " << test_file << ", "
+              << test.GetNumberOfEvents() << " events" << std::endl;
+
+    for(const auto& tsec : test.GetSections())
+    {
+      const TSSnapshot::Section_t* rsec = nullptr;
+      for(const auto& itr : ref.GetSections())
+        if(itr.fName == tsec.fName)
+          rsec = &itr;
+      if(!rsec)
+      {
+        std::cout << "  " << tsec.fName << ": not in the reference"
+                  << std::endl;
+        continue;
+      }
+
+      // per-event value and statistical error of a copy number
+      auto lookup = [](const TSSnapshot::Section_t& sec, G4int key,
+                       G4double nevt, G4double& err) {
+        auto vitr = sec.fRunValues.find(key);
+        auto sitr = sec.fStats.find(key);
+        G4double value =
+          (vitr != sec.fRunValues.end()) ? vitr->second / nevt : 0.0;
+        err = (sitr != sec.fStats.end())
+                ? std::fabs(value) * sitr->second.GetRelativeError()
+                : 0.0;
+        return value;
+      };
+
+      std::set<G4int> keys;
+      G4double rtotal = 0.0, ttotal = 0.0;
+      for(const auto& itr : rsec->fRunValues)
+      {
+        keys.insert(itr.first);
+        rtotal += itr.second / nref;
+      }
+      for(const auto& itr : tsec.fRunValues)
+      {
+        keys.insert(itr.first);
+        ttotal += itr.second / ntest;
+      }
+
+      G4int ncomp = 0, nwithin = 0, worst_key = -1;
+      G4double chi2 = 0.0, worst = 0.0;
+      for(auto key : keys)
+      {
+        G4double rerr = 0.0, terr = 0.0;
+        G4double rval  = lookup(*rsec, key, nref, rerr);
+        G4double tval  = lookup(tsec, key, ntest, terr);
+        G4double sigma = std::sqrt(rerr * rerr + terr * terr);
+        if(!(sigma > 0.0))
+          continue;
+        G4double z = (tval - rval) / sigma;
+        ++ncomp;
+        chi2 += z * z;
+        if(std::fabs(z) < 2.0)
+          ++nwithin;
+        if(std::fabs(z) > worst)
+        {
+          worst     = std::fabs(z);
+          worst_key = key;
+        }
+      }
+
+      std::cout << "  " << tsec.fName << "\n"
+                << std::setprecision(6) << "    per event     reference "
+                << rtotal << ", test " << ttotal << ", ratio "
+                << ((rtotal != 0.0) ? ttotal / rtotal : 0.0) << "\n"
+                << "    copy numbers  " << ncomp << " compared";
+      if(ncomp > 0)
+        std::cout << ", " << (100.0 * nwithin) / ncomp
+                  << "% within 2 sigma, chi2/ndf " << chi2 / ncomp
+                  << ", max |diff|/sigma " << worst << " (copy number "
+                  << worst_key << ")";
+      std::cout << std::endl;
+    }
+    return EXIT_SUCCESS;
+  }
+}  // namespace
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+int main(int argc, char** argv)
+{
+  std::string output;
+  std::vector<std::string> inputs;
+
+  auto usage = [&]() {
+    std::cerr << "usage: " << argv[0] << " [-o output.tssnap] input.tssnap..."
+              << "\n       " << argv[0]
+              << " --compare reference.tssnap test.tssnap" << std::endl;
+    return EXIT_FAILURE;
+  };
+
+  for(G4int i = 1; i < argc; ++i)
+  {
+    std::string arg = argv[i];
+    if(arg == "--compare" && i == 1 && argc == 4)
+      return compare(argv[2], argv[3]);
+    else if(arg == "-o" && i + 1 < argc)
+      output = argv[++i];
+    else if(!arg.empty() && arg[0] != '-')
+      inputs.push_back(arg);
+    else
+      return usage();
+  }
+
+  if(inputs.empty())
+    return usage();
+
+  TSSnapshot total;
+  for(const auto& itr : inputs)
+  {
+    TSSnapshot snapshot;
+    if(!snapshot.Read(itr))
+      return EXIT_FAILURE;
+    std::cout << itr << ": " << snapshot.GetNumberOfEvents() << " events";
+    for(const auto& src : snapshot.GetSources())
+    {
+      std::cout << ", seed " << src.fJobSeed << " run " << src.fRunSeed;
+      if(src.fThread >= 0)
+        std::cout << " thread " << src.fThread;
+    }
+    std::cout << std::endl;
+    if(total.Overlaps(snapshot))
+    {
+      std::cerr << itr << ": same histories as a previous input, e.g. a "
+                << "job run with the same TS_SEED" << std::endl;
+      return EXIT_FAILURE;
+    }
+    total += snapshot;
+  }
+
+  auto sum = [](const TSSnapshot::ValueMap_t& values) {
+    G4double val = 0.0;
+    for(const auto& itr : values)
+      val += itr.second;
+    return val;
+  };
+
+  std::cout << "total: " << total.GetNumberOfEvents() << " events"
+            << std::endl;
+  for(const auto& sec : total.GetSections())
+  {
+    std::cout << "  " << sec.fName << "\n"
+              << std::setprecision(12) << "    entries       "
+              << sec.fRunValues.size() << "\n"
+              << "    thread-local  " << sum(sec.fRunValues) << "\n"
+              << "    atomic        " << sum(sec.fAtomicValues) << "\n"
+              << "    mutex         " << sum(sec.fMutexValues) << "\n"
+              << "    statistics    " << sec.fStats.size() << " entries, "
+              << sec.fConv.size() << " convergence entries" << std::endl;
+  }
+
+  if(!output.empty() && !total.Write(output))
+    return EXIT_FAILURE;
+
+  return EXIT_SUCCESS;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,176 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file parallel/ThreadsafeScorers/ts_scorers_test.cc
+/// \brief Checks of the ThreadsafeScorers classes that need no transport
+//
+//
+//
+//
+/// ts_scorers_test runs the named checks, or all of them without arguments,
+///     and fails if any of them fails. They are registered with CTest.
+//
+//
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#include "G4Types.hh"
+#include "G4LogicalVolume.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4VPVParameterisation.hh"
+#include "TSConvergenceStats.hh"
+#include "TSDetectorConstruction.hh"
+
+#include <cfloat>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+namespace
+{
+  //--------------------------------------------------------------------------//
+  // the tail slope of generalized Pareto scores of shape xi is 1 + 1 / xi,
+  // in one instance and in four merged ones
+  G4bool convergence_slope()
+  {
+    G4bool pass = true;
+    for(G4double xi : { 0.5, 0.25, 1.0 })
+    {
+      std::mt19937_64 rng(1245214UL);
+      std::uniform_real_distribution<G4double> uniform(0.0, 1.0);
+      auto score = [&]() {
+        return (std::pow(1.0 - uniform(rng), -xi) - 1.0) / xi;
+      };
+
+      TSConvergenceStats single;
+      std::vector<TSConvergenceStats> parts(4);
+      for(G4int i = 0; i < 100000; ++i)
+      {
+        single += score();
+        parts[i % parts.size()] += score();
+      }
+      TSConvergenceStats merged;
+      for(auto& itr : parts)
+        merged += itr;
+
+      // the standard error of the slope is about 0.2 at xi = 0.5
+      G4double expected = 1.0 + 1.0 / xi;
+      for(auto slope : { single.GetSlope(), merged.GetSlope() })
+      {
+        G4bool ok = std::fabs(slope - expected) < 0.25 * expected;
+        pass      = pass && ok;
+        std::cerr << "  slope of a Pareto tail of shape " << xi << ": "
+                  << slope << " (expected " << expected << ") "
+                  << (ok ? "ok" : "FAILED") << std::endl;
+      }
+    }
+    return pass;
+  }
+
+  //--------------------------------------------------------------------------//
+  // center of the target section of a copy number, placed or parameterised
+  G4ThreeVector find_section(G4VPhysicalVolume* world, G4int copy)
+  {
+    G4LogicalVolume* world_log = world->GetLogicalVolume();
+    for(size_t i = 0; i < world_log->GetNoDaughters(); ++i)
+    {
+      G4VPhysicalVolume* daughter = world_log->GetDaughter(i);
+      G4LogicalVolume* daughter_log = daughter->GetLogicalVolume();
+      if(daughter_log->GetNoDaughters() > 0)
+      {
+        // container of the voxels
+        G4VPhysicalVolume* voxel     = daughter_log->GetDaughter(0);
+        G4VPVParameterisation* param = voxel->GetParameterisation();
+        param->ComputeTransformation(copy, voxel);
+        return daughter->GetTranslation() + voxel->GetTranslation();
+      }
+      if(daughter->GetCopyNo() == copy)
+        return daughter->GetTranslation();
+    }
+    return G4ThreeVector(DBL_MAX, DBL_MAX, DBL_MAX);
+  }
+
+  //--------------------------------------------------------------------------//
+  // the sections and the voxels number the targets alike: the section
+  // (i, j, k) = (2, 1, 0) of a 3 x 3 x 3 target, which no reflection of the
+  // target maps onto itself, is in the same place in both geometries, at -z
+  G4bool voxel_numbering()
+  {
+    setenv("TS_TARGET_SECTIONS", "3", 1);
+    G4int copy = 2 + 1 * 3 + 0 * 3 * 3;
+
+    std::vector<G4ThreeVector> centers;
+    for(auto voxels : { "OFF", "ON" })
+    {
+      setenv("TS_VOXEL_GEOMETRY", voxels, 1);
+      TSDetectorConstruction detector;
+      centers.push_back(find_section(detector.Construct(), copy));
+    }
+
+    G4bool pass = (centers.at(0) - centers.at(1)).mag() < 1.0e-9 &&
+                  centers.at(0).x() > 0.0 && std::fabs(centers.at(0).y()) < 1.0e-9 &&
+                  centers.at(0).z() < 0.0;
+    std::cerr << "  copy " << copy << ": section at " << centers.at(0)
+              << ", voxel at " << centers.at(1) << " "
+              << (pass ? "ok" : "FAILED") << std::endl;
+    return pass;
+  }
+}  // namespace
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+int main(int argc, char** argv)
+{
+  std::map<std::string, std::function<G4bool()>> checks{
+    { "convergence_slope", convergence_slope },
+    { "voxel_numbering", voxel_numbering }
+  };
+
+  std::vector<std::string> selected(argv + 1, argv + argc);
+  if(selected.empty())
+    for(const auto& itr : checks)
+      selected.push_back(itr.first);
+
+  G4bool pass = true;
+  for(const auto& name : selected)
+  {
+    auto itr = checks.find(name);
+    if(itr == checks.end())
+    {
+      std::cerr << argv[0] << ": unknown check " << name << std::endl;
+      return EXIT_FAILURE;
+    }
+    std::cerr << name << std::endl;
+    pass = itr->second() && pass;
+  }
+  return pass ? EXIT_SUCCESS : EXIT_FAILURE;
+}
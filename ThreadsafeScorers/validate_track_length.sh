@@ -0,0 +1,30 @@
+#!/bin/sh
+#
+# Validates TS_TRACK_LENGTH_SCORING against the step-limited scoring: runs
+# the macro once in each mode on the same voxel grid, compares the scores
+# of their snapshots with ts_scorers_merge --compare and prints the run
+# time and the steps in the target per event of each mode. The two runs
+# use different TS_SEEDs, so that their scores are independent samples, as
+# the chi2 of the comparison assumes.
+#
+# Usage, from the build directory:
+#   ./validate_track_length.sh [macro [sections per dimension]]
+# (default run.mac and 200). The logs are kept in ref.log and tl.log.
+#
+set -e
+
+macro=${1:-run.mac}
+export TS_TARGET_SECTIONS=${2:-200}
+export TS_VOXEL_GEOMETRY=ON
+
+TS_SEED=1 TS_SNAPSHOT=ref ./ts_scorers "$macro" > ref.log 2>&1
+TS_SEED=2 TS_SNAPSHOT=tl TS_TRACK_LENGTH_SCORING=ON \
+  ./ts_scorers "$macro" > tl.log 2>&1
+
+./ts_scorers_merge --compare ref_run0.tssnap tl_run0.tssnap
+for mode in ref tl
+do
+  printf '%-4s' "$mode"
+  grep '^TSRunAction: .* events in ' $mode.log | tail -n 1 |
+    sed 's/^TSRunAction: //'
+done
@@ -29,12 +29,21 @@
 
 #include "DetectorConstruction.hh"
 #include "ActionInitialization.hh"
+#include "ScanDriver.hh"
+#include "EigenvalueDriver.hh"
+#include "NeutronPhysicsList.hh"
+#include "PhysicsTableCache.hh"
+#include "StackingAction.hh"
+#include "FastNeutronModel.hh"
+#include "EventDispatchTuner.hh"
 
 #include "G4RunManagerFactory.hh"
+#include "G4MTRunManager.hh"
 #include "G4SteppingVerbose.hh"
 #include "G4UImanager.hh"
 #include "QGSP_BIC_HP.hh"
 #include "G4StepLimiterPhysics.hh"
+#include "G4FastSimulationPhysics.hh"
 
 #include "G4VisExecutive.hh"
 #include "G4UIExecutive.hh"
@@ -66,29 +75,64 @@ int main(int argc, char **argv)
   G4int precision = 4;
   G4SteppingVerbose::UseBestUnit(precision);
 
-  // Construct the default run manager
-  // Tasking run maneger does not work, but I don't know the reason
+  // Construct the run manager: MT unless G4RUN_MANAGER_TYPE names another
+  // type (Serial, MT, Tasking, ...)
   //
+  auto runManagerType =
+    getenv("G4RUN_MANAGER_TYPE") ? G4RunManagerType::Default : G4RunManagerType::MT;
   auto runManager =
-    G4RunManagerFactory::CreateRunManager(G4RunManagerType::MT);
+    G4RunManagerFactory::CreateRunManager(runManagerType);
   runManager->SetNumberOfThreads(G4Threading::G4GetNumberOfCores());
 
   // Set mandatory initialization classes
   //
   // Detector construction
-  runManager->SetUserInitialization(new DetectorConstruction());
+  auto detectorConstruction = new DetectorConstruction();
+  runManager->SetUserInitialization(detectorConstruction);
 
-  // Physics list
-  auto physicsList = new QGSP_BIC_HP;
-  physicsList->SetVerboseLevel(1);
+  // Physics list: QGSP_BIC_HP, or the trimmed neutron-only list with
+  // USPHERE_PHYSICS=neutron, which has no EM physics and so always kills
+  // non-neutron secondaries
+  //
+  G4VModularPhysicsList *physicsList;
+  if(!strcasecmp(getenv("USPHERE_PHYSICS") ? : "", "neutron")) {
+    physicsList = new NeutronPhysicsList;
+    StackingAction::RequireNeutronOnly();
+  }
+  else {
+    physicsList = new QGSP_BIC_HP;
+    physicsList->SetVerboseLevel(1);
+  }
   auto stepLimiterPhysics = new G4StepLimiterPhysics;
   stepLimiterPhysics->SetApplyToAll(true);
   physicsList->RegisterPhysics(stepLimiterPhysics);
+  // Fast neutron transport (/det/fastNeutron), only with
+  // USPHERE_FAST_NEUTRON=1 so other runs carry no fast simulation process
+  if(atoi(getenv("USPHERE_FAST_NEUTRON") ? : "0")) {
+    auto fastSimulationPhysics = new G4FastSimulationPhysics;
+    fastSimulationPhysics->ActivateFastSimulation("neutron");
+    physicsList->RegisterPhysics(fastSimulationPhysics);
+    FastNeutronModel::SetAvailable(true);
+  }
   runManager->SetUserInitialization(physicsList);
 
+  // Physics tables stored once and retrieved by later launches
+  auto physicsTableCache = new PhysicsTableCache(physicsList);
+
   // User action initialization
   runManager->SetUserInitialization(new ActionInitialization());
 
+  // Event modulo tuned from the event times of the previous runs
+  if(dynamic_cast<G4MTRunManager *>(runManager)) {
+    runManager->SetUserInitialization(new EventDispatchTuner("USphere"));
+  }
+
+  // Geometry scans driven from macros
+  auto scanDriver = new ScanDriver(detectorConstruction);
+
+  // k-eigenvalue calculations driven from macros
+  auto eigenvalueDriver = new EigenvalueDriver(detectorConstruction);
+
   // Initialize visualization with the default graphics system
   auto visManager = new G4VisExecutive(argc, argv);
   // Constructors can also take optional arguments:
@@ -124,7 +168,10 @@ int main(int argc, char **argv)
   // owned and deleted by the run manager, so they should not be deleted
   // in the main() program !
 
+  delete eigenvalueDriver;
+  delete scanDriver;
   delete visManager;
+  delete physicsTableCache;
   delete runManager;
 }
 
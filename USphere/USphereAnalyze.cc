@@ -0,0 +1,234 @@
+// Stream a USphere output file and fit the neutron population growth rate.
+//
+// Usage: USphereAnalyze [options] USphere-<radius>.root
+//   -j threads              number of threads (default: all cores)
+//   -t lo hi                global time fit window in ns (default: 400 1000)
+//   -g lo hi                generation fit window (default: 54 156)
+//   --time-bins n           time bins over [0, 1250) ns (default: 50)
+//   --generation-bins n     generation bins over [0, 300) (default: 50)
+//
+// Trees are processed cluster by cluster on a thread pool, so memory does
+// not grow with the file size. Histogram-mode files are rebinned directly.
+
+#include "GrowthRateFit.hh"
+
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <TFile.h>
+#include <TTree.h>
+#include <TBranch.h>
+#include <TH1D.h>
+#include <TParameter.h>
+#include <TROOT.h>
+#include <TTreeReader.h>
+#include <TTreeReaderArray.h>
+#include <ROOT/TThreadedObject.hxx>
+#include <ROOT/TTreeProcessorMT.hxx>
+
+using namespace std;
+
+namespace {
+
+struct Axis
+{
+  int bins;
+  double max;
+  double window[2];
+};
+
+struct LogLinearFitResult
+{
+  bool valid = false;
+  double slope = 0.0;
+  double slopeError = 0.0;
+};
+
+// Least-squares line through the logarithm of the non-empty bins, with the
+// error estimated from the correlation coefficient as plot.py does.
+LogLinearFitResult LogLinearFit(const vector<double> &counts, double width, double lo, double hi)
+{
+  LogLinearFitResult result;
+  vector<double> x, y;
+  for(size_t i = 0; i < counts.size(); ++i) {
+    double low = i * width;
+    if(low < lo - 1e-9 * width || low + width > hi + 1e-9 * width || counts[i] <= 0.0) continue;
+    x.push_back(low + 0.5 * width);
+    y.push_back(log(counts[i]));
+  }
+  size_t n = x.size();
+  if(n < 3) return result;
+  double mx = 0.0, my = 0.0;
+  for(size_t i = 0; i < n; ++i) { mx += x[i]; my += y[i]; }
+  mx /= n; my /= n;
+  double sxx = 0.0, sxy = 0.0, syy = 0.0;
+  for(size_t i = 0; i < n; ++i) {
+    sxx += (x[i] - mx) * (x[i] - mx);
+    sxy += (x[i] - mx) * (y[i] - my);
+    syy += (y[i] - my) * (y[i] - my);
+  }
+  if(sxx <= 0.0 || syy <= 0.0) return result;
+  double r = sxy / sqrt(sxx * syy);
+  result.valid = true;
+  result.slope = sxy / sxx;
+  result.slopeError = fabs(result.slope) * sqrt((1.0 / (r * r) - 1.0) / (n - 2));
+  return result;
+}
+
+void Report(const string &name, const vector<double> &counts, const Axis &axis)
+{
+  double width = axis.max / axis.bins;
+  cout << name << " window [" << axis.window[0] << ", " << axis.window[1] << ")" << endl;
+  LogLinearFitResult line = LogLinearFit(counts, width, axis.window[0], axis.window[1]);
+  if(line.valid) {
+    cout << "  log-linear: k = " << line.slope << " (" << line.slopeError << ")" << endl;
+    cout << "  log-linear: exp(k) = " << exp(line.slope) << " (" << exp(line.slope) * line.slopeError << ")" << endl;
+  }
+  else cout << "  log-linear: no valid fit" << endl;
+  B1::GrowthRateFitResult fit = B1::GrowthRateFit(counts, 0.0, width, axis.window[0], axis.window[1]);
+  if(fit.valid) {
+    cout << "  Poisson ML: k = " << fit.slope << " (" << fit.slopeError << ")" << endl;
+    cout << "  Poisson ML: exp(k) = " << exp(fit.slope) << " (" << exp(fit.slope) * fit.slopeError << ")" << endl;
+  }
+  else cout << "  Poisson ML: no valid fit" << endl;
+}
+
+vector<double> Contents(const TH1D &histogram)
+{
+  vector<double> counts(histogram.GetNbinsX());
+  for(int i = 0; i < histogram.GetNbinsX(); ++i) counts[i] = histogram.GetBinContent(i + 1);
+  return counts;
+}
+
+// Fill both histograms from every entry; element types follow the file.
+template<class Generation, class Time>
+long long Process(const string &path, bool weighted, ROOT::TThreadedObject<TH1D> &time,
+                  ROOT::TThreadedObject<TH1D> &generation)
+{
+  atomic<long long> events(0);
+  ROOT::TTreeProcessorMT processor(path, "tree");
+  processor.Process([&](TTreeReader &reader) {
+    TTreeReaderArray<Generation> generations(reader, "NeutronGeneration");
+    TTreeReaderArray<Time> times(reader, "NeutronGlobalTime");
+    unique_ptr<TTreeReaderArray<double>> weights;
+    if(weighted) weights = make_unique<TTreeReaderArray<double>>(reader, "NeutronWeight");
+    auto localTime = time.Get();
+    auto localGeneration = generation.Get();
+    long long localEvents = 0;
+    while(reader.Next()) {
+      for(size_t i = 0; i < times.GetSize(); ++i) {
+        double weight = weights ? (*weights)[i] : 1.0;
+        localTime->Fill(times[i], weight);
+        localGeneration->Fill(generations[i], weight);
+      }
+      ++localEvents;
+    }
+    events += localEvents;
+  });
+  return events;
+}
+
+void Usage(const char *program)
+{
+  cerr << "usage: " << program << " [-j threads] [-t lo hi] [-g lo hi] "
+       << "[--time-bins n] [--generation-bins n] file.root" << endl;
+}
+
+int Run(int argc, char **argv)
+{
+  unsigned threads = 0;
+  Axis timeAxis = { 50, 1250.0, { 400.0, 1000.0 } };
+  Axis generationAxis = { 50, 300.0, { 54.0, 156.0 } };
+  string path;
+  for(int i = 1; i < argc; ++i) {
+    string arg = argv[i];
+    auto next = [&]() -> double {
+      if(++i >= argc) throw invalid_argument("missing value after " + arg);
+      return stod(argv[i]);
+    };
+    if(arg == "-j") threads = next();
+    else if(arg == "-t") { timeAxis.window[0] = next(); timeAxis.window[1] = next(); }
+    else if(arg == "-g") { generationAxis.window[0] = next(); generationAxis.window[1] = next(); }
+    else if(arg == "--time-bins") timeAxis.bins = next();
+    else if(arg == "--generation-bins") generationAxis.bins = next();
+    else if(path.empty()) path = arg;
+    else throw invalid_argument("unexpected argument: " + arg);
+  }
+  if(path.empty()) {
+    Usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+  if(timeAxis.bins <= 0 || generationAxis.bins <= 0) throw invalid_argument("bin counts must be positive");
+
+  unique_ptr<TFile> file(TFile::Open(path.c_str()));
+  if(!file || !file->IsOpen()) throw runtime_error("error opening file: " + path);
+
+  vector<double> timeCounts, generationCounts;
+  long long events;
+  if(auto time = file->Get<TH1D>("NeutronGlobalTime")) {
+    // Histogram mode: rebin the merged tallies.
+    auto generation = file->Get<TH1D>("NeutronGeneration");
+    auto parameter = file->Get<TParameter<Long64_t>>("NumberOfEvents");
+    if(!generation || !parameter) throw runtime_error("incomplete histogram-mode file: " + path);
+    if(time->GetNbinsX() % timeAxis.bins || generation->GetNbinsX() % generationAxis.bins) {
+      throw invalid_argument("bin counts must divide the stored binning");
+    }
+    time->Rebin(time->GetNbinsX() / timeAxis.bins);
+    generation->Rebin(generation->GetNbinsX() / generationAxis.bins);
+    timeCounts = Contents(*time);
+    generationCounts = Contents(*generation);
+    events = parameter->GetVal();
+  }
+  else {
+    auto tree = file->Get<TTree>("tree");
+    if(!tree) throw runtime_error("no tree in file: " + path);
+    if(!tree->GetBranch("NeutronGeneration") || !tree->GetBranch("NeutronGlobalTime")) {
+      throw runtime_error("tree lacks the neutron branches: " + path);
+    }
+    bool weighted = tree->GetBranch("NeutronWeight") != nullptr;
+    string generationType = tree->GetBranch("NeutronGeneration")->GetClassName();
+    string timeType = tree->GetBranch("NeutronGlobalTime")->GetClassName();
+    bool shortGeneration = generationType.find("short") != string::npos;
+    bool floatTime = timeType.find("float") != string::npos;
+    file.reset();
+
+    ROOT::EnableImplicitMT(threads);
+    ROOT::TThreadedObject<TH1D> timeTally("NeutronGlobalTime", "NeutronGlobalTime", timeAxis.bins, 0.0, timeAxis.max);
+    ROOT::TThreadedObject<TH1D> generationTally("NeutronGeneration", "NeutronGeneration",
+                                                generationAxis.bins, 0.0, generationAxis.max);
+    if(shortGeneration && floatTime) events = Process<short, float>(path, weighted, timeTally, generationTally);
+    else if(shortGeneration) events = Process<short, double>(path, weighted, timeTally, generationTally);
+    else if(floatTime) events = Process<int, float>(path, weighted, timeTally, generationTally);
+    else events = Process<int, double>(path, weighted, timeTally, generationTally);
+    timeCounts = Contents(*timeTally.Merge());
+    generationCounts = Contents(*generationTally.Merge());
+  }
+
+  cout << events << " events loaded" << endl;
+  Report("NeutronGlobalTime", timeCounts, timeAxis);
+  Report("NeutronGeneration", generationCounts, generationAxis);
+  return EXIT_SUCCESS;
+}
+
+}
+
+int main(int argc, char **argv)
+{
+  try {
+    return Run(argc, argv);
+  }
+  catch(const invalid_argument &error) {
+    // Also thrown by stod for a value that is not a number.
+    cerr << argv[0] << ": " << error.what() << endl;
+    Usage(argv[0]);
+  }
+  catch(const exception &error) {
+    cerr << argv[0] << ": " << error.what() << endl;
+  }
+  return EXIT_FAILURE;
+}
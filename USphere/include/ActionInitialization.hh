@@ -35,16 +35,25 @@
 namespace B1
 {
 
+class RunMessenger;
+class StackingMessenger;
+class FluxMeshMessenger;
+
 /// Action initialization class.
 
 class ActionInitialization : public G4VUserActionInitialization
 {
   public:
-    ActionInitialization() = default;
-    ~ActionInitialization() override = default;
+    ActionInitialization();
+    ~ActionInitialization() override;
 
     void BuildForMaster() const override;
     void Build() const override;
+
+  private:
+    RunMessenger *fRunMessenger;
+    StackingMessenger *fStackingMessenger;
+    FluxMeshMessenger *fFluxMeshMessenger;
 };
 
 }
@@ -35,14 +35,19 @@
 #include "G4SystemOfUnits.hh"
 #include "globals.hh"
 
+#include <map>
+
 class G4VPhysicalVolume;
 class G4LogicalVolume;
 class G4Material;
+class G4Isotope;
+class G4Region;
 
 namespace B1
 {
 
 class DetectorMessenger;
+class StepLimits;
 
 /// Detector construction class to define materials and geometry.
 
@@ -53,11 +58,14 @@ class DetectorConstruction : public G4VUserDetectorConstruction
     ~DetectorConstruction();
 
     G4VPhysicalVolume *Construct() override;
+    void ConstructSDandField() override;
 
     void SetRadius(G4double radius);
     G4double GetRadius() const { return fRadius; }
     void SetU235Enrichment(G4double enrichment);
     G4double GetU235Enrichment() const { return fU235Enrichment; }
+    G4LogicalVolume *GetSphere() const { return fSphere; }
+    StepLimits *GetStepLimits() const { return fStepLimits; }
 
   protected:
     DetectorMessenger *fMessenger;
@@ -67,8 +75,17 @@ class DetectorConstruction : public G4VUserDetectorConstruction
 
     G4LogicalVolume *fWorld = nullptr;
     G4LogicalVolume *fSphere = nullptr;
+    G4Region *fSphereRegion = nullptr;
+    StepLimits *fStepLimits;
+
+    // Uranium isotopes and materials, built once per enrichment so that
+    // revisiting an enrichment does not force a physics table rebuild.
+    G4Isotope *fU234 = nullptr;
+    G4Isotope *fU235 = nullptr;
+    G4Isotope *fU238 = nullptr;
+    std::map<G4double, G4Material *> fUMaterials;
 
-    G4Material *GetUMaterial(G4double U235Enrichment) const;
+    G4Material *GetUMaterial(G4double U235Enrichment);
 };
 
 }
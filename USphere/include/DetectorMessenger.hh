@@ -34,8 +34,10 @@
 #include "G4UImessenger.hh"
 
 class G4UIdirectory;
+class G4UIcmdWithABool;
 class G4UIcmdWithADouble;
 class G4UIcmdWithADoubleAndUnit;
+class G4UIcommand;
 
 namespace B1
 {
@@ -47,6 +49,8 @@ class DetectorConstruction;
 /// It implements commands:
 /// - /det/setRadius value unit
 /// - /det/setU235Enrichment value
+/// - /det/stepLimit particle|all fraction
+/// - /det/fastNeutron true|false
 
 class DetectorMessenger: public G4UImessenger
 {
@@ -62,6 +66,8 @@ class DetectorMessenger: public G4UImessenger
     G4UIdirectory *fDetDirectory = nullptr;
     G4UIcmdWithADoubleAndUnit *fSetRadius = nullptr;
     G4UIcmdWithADouble *fSetU235Enrichment = nullptr;
+    G4UIcommand *fSetStepLimit = nullptr;
+    G4UIcmdWithABool *fSetFastNeutron = nullptr;
 };
 
 }
@@ -0,0 +1,87 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/include/EigenvalueDriver.hh
+/// \brief Definition of the B1::EigenvalueDriver class
+
+#ifndef B1EigenvalueDriver_h
+#define B1EigenvalueDriver_h 1
+
+#include "FissionSource.hh"
+#include "globals.hh"
+
+#include <vector>
+
+namespace B1
+{
+
+class DetectorConstruction;
+class EigenvalueMessenger;
+
+/// Eigenvalue driver class : k-eigenvalue calculation by power iteration.
+///
+/// Each cycle is one run that transports a fixed population of source
+/// neutrons, split into events of equal size. The fission neutrons banked
+/// by the cycle are resampled to the same population and become the source
+/// of the next cycle. k_eff is averaged over the active cycles, after the
+/// inactive ones have let the source converge; the Shannon entropy of the
+/// source on a Cartesian mesh is printed for every cycle to check this.
+
+class EigenvalueDriver
+{
+  public:
+    EigenvalueDriver(DetectorConstruction *detectorConstruction);
+    ~EigenvalueDriver();
+
+    void Run();
+
+    void SetPopulation(G4int population) { fPopulation = population; }
+    void SetSitesPerEvent(G4int sites) { fSitesPerEvent = sites; }
+    void SetInactiveCycles(G4int cycles) { fInactiveCycles = cycles; }
+    void SetActiveCycles(G4int cycles) { fActiveCycles = cycles; }
+    void SetEntropyMesh(G4int bins) { fEntropyMesh = bins; }
+    void SetFileName(const G4String &fileName) { fFileName = fileName; }
+
+  private:
+    DetectorConstruction *fDetectorConstruction;
+    EigenvalueMessenger *fMessenger;
+
+    G4int fPopulation = 10000;
+    G4int fSitesPerEvent = 100;
+    G4int fInactiveCycles = 20;
+    G4int fActiveCycles = 100;
+    G4int fEntropyMesh = 8;  // bins per axis
+    G4String fFileName = "USphere-eigen.txt";
+
+    std::vector<FissionSite> Resample(const std::vector<FissionSite> &bank) const;
+    G4double ShannonEntropy(const std::vector<FissionSite> &source) const;
+};
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,81 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/include/EigenvalueMessenger.hh
+/// \brief Definition of the B1::EigenvalueMessenger class
+
+#ifndef B1EigenvalueMessenger_h
+#define B1EigenvalueMessenger_h 1
+
+#include "globals.hh"
+#include "G4UImessenger.hh"
+
+class G4UIdirectory;
+class G4UIcommand;
+class G4UIcmdWithAString;
+class G4UIcmdWithAnInteger;
+class G4UIcmdWithoutParameter;
+
+namespace B1
+{
+
+class EigenvalueDriver;
+
+/// Messenger class that defines commands for B1::EigenvalueDriver.
+///
+/// It implements commands:
+/// - /eigen/population value
+/// - /eigen/sitesPerEvent value
+/// - /eigen/inactive value
+/// - /eigen/active value
+/// - /eigen/entropyMesh value
+/// - /eigen/output fileName
+/// - /eigen/run
+
+class EigenvalueMessenger: public G4UImessenger
+{
+  public:
+    EigenvalueMessenger(EigenvalueDriver *);
+    ~EigenvalueMessenger() override;
+
+    void SetNewValue(G4UIcommand *, G4String) override;
+
+  private:
+    EigenvalueDriver *fEigenvalueDriver = nullptr;
+
+    G4UIdirectory *fEigenDirectory = nullptr;
+    G4UIcmdWithAnInteger *fSetPopulation = nullptr;
+    G4UIcmdWithAnInteger *fSetSitesPerEvent = nullptr;
+    G4UIcmdWithAnInteger *fSetInactive = nullptr;
+    G4UIcmdWithAnInteger *fSetActive = nullptr;
+    G4UIcmdWithAnInteger *fSetEntropyMesh = nullptr;
+    G4UIcmdWithAString *fSetOutput = nullptr;
+    G4UIcmdWithoutParameter *fRun = nullptr;
+};
+
+}
+
+#endif
@@ -0,0 +1,142 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/include/FastNeutronModel.hh
+/// \brief Definition of the B1::FastNeutronModel class
+
+#ifndef B1FastNeutronModel_h
+#define B1FastNeutronModel_h 1
+
+#include "G4VFastSimulationModel.hh"
+#include "G4VUserTrackInformation.hh"
+#include "G4Threading.hh"
+#include "G4SystemOfUnits.hh"
+#include "globals.hh"
+
+#include <array>
+#include <map>
+#include <memory>
+#include <vector>
+
+class G4Material;
+class G4Region;
+class G4Track;
+
+namespace B1
+{
+
+/// Fast neutron transport in the homogeneous sphere.
+///
+/// Neutrons fly from collision to collision in a single step: the free path
+/// is sampled from the macroscopic total cross section and cut analytically
+/// at the sphere boundary, instead of going through the navigator and a
+/// cross section lookup per process and step. At a collision, the channel
+/// is sampled from the channel cross sections and the final state comes
+/// from the HP model the full physics list would have called; secondaries
+/// are handed back to the stack.
+///
+/// The macroscopic cross sections are tabulated once per material, on one
+/// energy grid shared by all channels, from the cross sections of the
+/// physics list. The grid is bisected until linear interpolation reproduces
+/// them within kTolerance of the total. The master builds the table of the
+/// sphere material at the start of each run, after the physics tables, so
+/// the threads share it read-only and no event pays for the tabulation.
+///
+/// The fast simulation process is only registered, and the model only
+/// built, when the mode is requested at startup with USPHERE_FAST_NEUTRON=1;
+/// /det/fastNeutron then switches it on and off between runs.
+
+class FastNeutronModel : public G4VFastSimulationModel
+{
+  public:
+    FastNeutronModel(const G4String &name, G4Region *envelope);
+    ~FastNeutronModel() override = default;
+
+    G4bool IsApplicable(const G4ParticleDefinition &particle) override;
+    G4bool ModelTrigger(const G4FastTrack &fastTrack) override;
+    void DoIt(const G4FastTrack &fastTrack, G4FastStep &fastStep) override;
+
+    // Global settings.
+    static void SetAvailable(G4bool available) { fAvailable = available; }
+    static G4bool IsAvailable() { return fAvailable; }
+    static void SetEnabled(G4bool enabled) { fEnabled = enabled; }
+    static G4bool GetEnabled() { return fEnabled; }
+
+    // Tabulate the material's cross sections unless already done; call on
+    // the master once the physics tables are built, before the event loop.
+    static void BuildTable(const G4Material *material);
+
+    // Fission neutrons of this model do not carry the nFission creator
+    // process, so they are tagged instead.
+    static G4bool IsFissionNeutron(const G4Track *track);
+
+    // Tabulated energy range: the HP range.
+    static constexpr G4double kMinEnergy = 1e-5 * eV;
+    static constexpr G4double kMaxEnergy = 20 * MeV;
+    static constexpr G4double kPointsPerDecade = 20;
+    static constexpr G4double kTolerance = 1e-3;
+    static constexpr G4int kMaxDepth = 20;
+
+  private:
+    enum Channel { kElastic, kInelastic, kCapture, kFission, kNChannels };
+    using CrossSections = std::array<G4double, kNChannels>;
+
+    struct Table
+    {
+      std::vector<G4double> energies;
+      std::vector<CrossSections> crossSections;
+
+      CrossSections Interpolate(G4double energy) const;
+    };
+
+    class FissionTag : public G4VUserTrackInformation
+    {
+      public:
+        FissionTag() : G4VUserTrackInformation("FastNeutronFission") { }
+    };
+
+    // Table of the material last seen by this thread.
+    const G4Material *fMaterial = nullptr;
+    const Table *fTable = nullptr;
+
+    static G4bool fAvailable;  // fast simulation process registered
+    static G4bool fEnabled;
+    static std::map<const G4Material *, std::unique_ptr<const Table>> fTables;
+
+    static const Table *FindTable(const G4Material *material);
+    static CrossSections ComputeCrossSections(const G4Material *material, G4double energy);
+    static void Refine(const G4Material *material, Table &table, G4double lowEnergy,
+                       const CrossSections &low, G4double highEnergy, const CrossSections &high, G4int depth);
+    static G4double DistanceToBoundary(const G4FastTrack &fastTrack);
+    void Interact(const G4FastTrack &fastTrack, G4FastStep &fastStep, Channel channel,
+                  const G4ThreeVector &position, G4double time);
+};
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,93 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/include/FissionSource.hh
+/// \brief Definition of the B1::FissionSource class
+
+#ifndef B1FissionSource_h
+#define B1FissionSource_h 1
+
+#include "G4ThreeVector.hh"
+#include "G4Threading.hh"
+#include "globals.hh"
+
+#include <utility>
+#include <vector>
+
+namespace B1
+{
+
+/// A fission neutron as banked at birth, or a source neutron of a cycle.
+
+struct FissionSite
+{
+  G4ThreeVector position;
+  G4ThreeVector direction;
+  G4double energy = 0.0;
+  G4double weight = 1.0;
+};
+
+/// Fission source shared between the cycles of a k-eigenvalue calculation.
+///
+/// While active, the source of the current cycle is split into consecutive
+/// slices of fixed size, one per event, which the primary generator reads by
+/// event ID. The stacking action banks fission neutrons instead of tracking
+/// them, and every event hands its sites over here. Banked sites are sorted
+/// by event ID, so the next source does not depend on thread scheduling.
+
+class FissionSource
+{
+  public:
+    static FissionSource *Instance();
+
+    // Source of the current cycle, set by the master between runs.
+    void SetSource(std::vector<FissionSite> source) { fSource = std::move(source); }
+    void SetSitesPerEvent(G4int sites) { fSitesPerEvent = sites; }
+    G4int GetNumberOfEvents() const;
+    std::pair<const FissionSite *, const FissionSite *> GetEventSites(G4int eventID) const;
+
+    // Fission sites produced by the current cycle.
+    void Bank(G4int eventID, const std::vector<FissionSite> &sites);
+    std::vector<FissionSite> TakeBank();
+
+    static void SetActive(G4bool active) { fActive = active; }
+    static G4bool IsActive() { return fActive; }
+
+  private:
+    FissionSource() = default;
+
+    static G4bool fActive;
+
+    std::vector<FissionSite> fSource;
+    G4int fSitesPerEvent = 100;
+
+    G4Mutex fMutex;
+    std::vector<std::pair<G4int, std::vector<FissionSite>>> fBank;
+};
+
+}
+
+#endif
@@ -0,0 +1,83 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/include/FluxMesh.hh
+/// \brief Definition of the B1::FluxMesh class
+
+#ifndef B1FluxMesh_h
+#define B1FluxMesh_h 1
+
+#include "G4Threading.hh"
+#include "G4SystemOfUnits.hh"
+#include "globals.hh"
+
+#include <vector>
+
+namespace B1
+{
+
+/// Radial shell x time bin track-length flux tally of the Sphere.
+///
+/// Each stepping action scores into its own dense array; the arrays are
+/// added here once per thread at end of run. Shells have equal widths and
+/// the bins are indexed [shell * time bins + time bin]. The written flux is
+/// the track length per shell volume per source event, integrated over each
+/// time bin.
+
+class FluxMesh
+{
+  public:
+    static FluxMesh *Instance();
+
+    void Reset();
+    void Merge(const std::vector<G4double> &flux);
+    void Write(G4double radius, G4int events) const;
+
+    void SetEnabled(G4bool enabled) { fEnabled = enabled; }
+    G4bool IsEnabled() const { return fEnabled; }
+    void SetShells(G4int shells) { fShells = shells; }
+    G4int GetShells() const { return fShells; }
+    void SetTimeBins(G4int bins) { fTimeBins = bins; }
+    G4int GetTimeBins() const { return fTimeBins; }
+    void SetTimeMax(G4double time) { fTimeMax = time; }
+    G4double GetTimeMax() const { return fTimeMax; }
+
+  private:
+    FluxMesh() = default;
+
+    // Settings, fixed during a run.
+    G4bool fEnabled = false;
+    G4int fShells = 20;
+    G4int fTimeBins = 250;
+    G4double fTimeMax = 1250 * ns;
+
+    mutable G4Mutex fMutex;
+    std::vector<G4double> fFlux;
+};
+
+}
+
+#endif
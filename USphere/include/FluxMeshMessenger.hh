@@ -0,0 +1,73 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/include/FluxMeshMessenger.hh
+/// \brief Definition of the B1::FluxMeshMessenger class
+
+#ifndef B1FluxMeshMessenger_h
+#define B1FluxMeshMessenger_h 1
+
+#include "globals.hh"
+#include "G4UImessenger.hh"
+
+class G4UIdirectory;
+class G4UIcmdWithABool;
+class G4UIcmdWithAnInteger;
+class G4UIcmdWithADoubleAndUnit;
+
+namespace B1
+{
+
+/// Messenger class that defines commands for B1::FluxMesh.
+///
+/// It implements commands:
+/// - /flux/enable true|false
+/// - /flux/shells value
+/// - /flux/timeBins value
+/// - /flux/timeMax value unit
+///
+/// The settings are shared by all threads, so the commands are only
+/// instantiated and executed on the master thread.
+
+class FluxMeshMessenger: public G4UImessenger
+{
+  public:
+    FluxMeshMessenger();
+    ~FluxMeshMessenger() override;
+
+    void SetNewValue(G4UIcommand *, G4String) override;
+
+  private:
+    G4UIdirectory *fFluxDirectory = nullptr;
+    G4UIcmdWithABool *fSetEnable = nullptr;
+    G4UIcmdWithAnInteger *fSetShells = nullptr;
+    G4UIcmdWithAnInteger *fSetTimeBins = nullptr;
+    G4UIcmdWithADoubleAndUnit *fSetTimeMax = nullptr;
+};
+
+}
+
+#endif
@@ -0,0 +1,140 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/include/GrowthRateEstimator.hh
+/// \brief Definition of the B1::GrowthRateEstimator class
+
+#ifndef B1GrowthRateEstimator_h
+#define B1GrowthRateEstimator_h 1
+
+#include "G4Threading.hh"
+#include "globals.hh"
+
+#include <atomic>
+#include <map>
+#include <vector>
+
+namespace B1
+{
+
+/// Online estimator of the neutron population growth rate.
+///
+/// Worker threads submit batches of events as fixed-bin time and generation
+/// histograms. Each batch is fitted on its own and the spread of the batch
+/// slopes gives the statistical error (batch means). Once the standard
+/// errors of both growth rates k are below the target error, a stop is
+/// requested and the event actions abort the run softly. Complete batches
+/// whose fit fails are counted and reported, since leaving them out can
+/// bias the estimate towards well-behaved batches.
+///
+/// Generations of a batch's events handed to other threads as sub-events
+/// are tallied into that batch: a batch with outstanding sub-events is held
+/// back, and only fitted and merged once all of them have been submitted.
+
+class GrowthRateEstimator
+{
+  public:
+    struct Estimate
+    {
+      G4bool valid = false;
+      G4double slope = 0.0;  // per ns or per generation
+      G4double error = 0.0;  // batch-means standard error
+      G4int batches = 0;
+      G4int dropped = 0;  // complete batches whose fit failed
+    };
+
+    static GrowthRateEstimator *Instance();
+
+    void Reset();
+    // Identifier of a new batch, unique within the process.
+    G4long OpenBatch() { return fNextBatch++; }
+    void AddSubEvents(G4long batch, G4int subEvents);
+    void SubmitBatch(G4long batch, const std::vector<G4double> &timeHistogram,
+                     const std::vector<G4double> &generationHistogram,
+                     G4int events, G4bool complete);
+    void SubmitSubEvent(G4long batch, const std::vector<G4double> &timeHistogram,
+                        const std::vector<G4double> &generationHistogram);
+
+    G4bool IsStopRequested() const { return fStopRequested; }
+    G4int GetNumberOfEvents() const { return fEvents; }
+    Estimate GetTimeEstimate() const;
+    Estimate GetGenerationEstimate() const;
+    void Print() const;
+
+    // Standard error of k at which to stop; 0: never stop early.
+    void SetTargetError(G4double error) { fTargetError = error; }
+    G4double GetTargetError() const { return fTargetError; }
+    void SetBatchSize(G4int size) { fBatchSize = size; }
+    G4int GetBatchSize() const { return fBatchSize; }
+    void SetMinBatches(G4int batches) { fMinBatches = batches; }
+    void SetTimeWindow(G4double lo, G4double hi) { fTimeWindow[0] = lo; fTimeWindow[1] = hi; }
+    void SetGenerationWindow(G4double lo, G4double hi) { fGenerationWindow[0] = lo; fGenerationWindow[1] = hi; }
+
+  private:
+    // Batch waiting for the sub-events of its events.
+    struct Batch
+    {
+      std::vector<G4double> timeHistogram;
+      std::vector<G4double> generationHistogram;
+      G4int events = 0;
+      G4bool complete = false;
+      G4bool submitted = false;
+      G4int subEvents = 0;  // outstanding
+    };
+
+    GrowthRateEstimator();
+
+    mutable G4Mutex fMutex;
+    std::atomic<G4bool> fStopRequested = false;
+
+    // Settings.
+    G4double fTargetError = 0.0;  // 0: never stop early
+    G4int fBatchSize = 100;
+    G4int fMinBatches = 10;
+    G4double fTimeWindow[2] = { 400.0, 1000.0 };  // ns
+    G4double fGenerationWindow[2] = { 54.0, 156.0 };
+
+    // Batch slopes and the merged tallies of all submitted events.
+    std::vector<G4double> fTimeSlopes;
+    std::vector<G4double> fGenerationSlopes;
+    G4int fDroppedTimeBatches = 0;
+    G4int fDroppedGenerationBatches = 0;
+    std::vector<G4double> fTimeHistogram;
+    std::vector<G4double> fGenerationHistogram;
+    std::atomic<G4int> fEvents = 0;  // written under fMutex, read without
+    std::atomic<G4long> fNextBatch = 0;
+    std::map<G4long, Batch> fHeldBatches;
+
+    Batch &GetHeldBatch(G4long batch);
+    void Close(const std::vector<G4double> &timeHistogram,
+               const std::vector<G4double> &generationHistogram,
+               G4int events, G4bool complete);
+    Estimate MakeEstimate(const std::vector<G4double> &slopes) const;
+};
+
+}
+
+#endif
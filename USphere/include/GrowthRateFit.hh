@@ -0,0 +1,59 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/include/GrowthRateFit.hh
+/// \brief Definition of the B1::GrowthRateFit function
+
+#ifndef B1GrowthRateFit_h
+#define B1GrowthRateFit_h 1
+
+#include <vector>
+
+namespace B1
+{
+
+/// Result of an exponential fit: counts ~ exp(intercept + slope * x).
+
+struct GrowthRateFitResult
+{
+  bool valid = false;
+  double slope = 0.0;
+  double slopeError = 0.0;
+  double intercept = 0.0;
+};
+
+/// Fit an exponential to the bins of a fixed-bin histogram that lie fully
+/// inside [lo, hi). Bins start at xmin and have the given width.
+///
+/// The fit maximizes the Poisson likelihood by Newton iterations, so empty
+/// bins are handled without the bias of a log-linear least-squares fit.
+
+GrowthRateFitResult GrowthRateFit(const std::vector<double> &counts,
+                                  double xmin, double width, double lo, double hi);
+
+}
+
+#endif
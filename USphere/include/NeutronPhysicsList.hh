@@ -0,0 +1,60 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/include/NeutronPhysicsList.hh
+/// \brief Definition of the B1::NeutronPhysicsList class
+
+#ifndef B1NeutronPhysicsList_h
+#define B1NeutronPhysicsList_h 1
+
+#include "G4VModularPhysicsList.hh"
+
+namespace B1
+{
+
+/// Trimmed physics list for neutron-only transport.
+///
+/// It keeps the hadronic part of QGSP_BIC_HP that neutrons see: high
+/// precision elastic, inelastic, capture and fission below 20 MeV, and the
+/// binary cascade above. Electromagnetic, stopping and ion physics are left
+/// out, since every non-neutron secondary is killed at birth by the
+/// stacking action in this mode. Particle definitions come with the decay
+/// physics, so fission fragments and photons can still be created.
+
+class NeutronPhysicsList : public G4VModularPhysicsList
+{
+  public:
+    NeutronPhysicsList();
+    ~NeutronPhysicsList() override = default;
+
+    void SetCuts() override;
+};
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
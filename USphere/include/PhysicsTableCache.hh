@@ -0,0 +1,94 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/include/PhysicsTableCache.hh
+/// \brief Definition of the B1::PhysicsTableCache class
+
+#ifndef B1PhysicsTableCache_h
+#define B1PhysicsTableCache_h 1
+
+#include "G4VStateDependent.hh"
+#include "G4Timer.hh"
+#include "globals.hh"
+
+#include <string>
+
+class G4VModularPhysicsList;
+
+namespace B1
+{
+
+/// Physics table cache : store the physics tables once they are built, and
+/// retrieve them in later launches instead of building them again.
+///
+/// Tables are kept in one directory per key, a hash of the Geant4 version,
+/// the data sets, the physics constructors, the materials of the geometry
+/// and the production cuts. The key is computed again whenever a run is
+/// initialized, so changing the enrichment switches to the matching tables.
+/// A directory is written under a temporary name and renamed into place,
+/// so it is always complete; a stale key simply misses and the tables are
+/// built and stored again.
+///
+/// The cache lives in $USPHERE_TABLE_CACHE, or $XDG_CACHE_HOME/USphere,
+/// or ~/.cache/USphere; an empty USPHERE_TABLE_CACHE disables it.
+///
+/// Only the tables the physics list can store are cached: EM tables, cuts
+/// and the other processes that implement StorePhysicsTable. The neutron HP
+/// data sets are still read from G4NEUTRONHPDATA by every launch, which
+/// Geant4 offers no way to store. The time of every initialization is
+/// printed, HP load included, so cold and warm launches can be compared:
+///   USPHERE_TABLE_CACHE=/tmp/tables ./USphere run.mac  (cold, then warm)
+
+class PhysicsTableCache : public G4VStateDependent
+{
+  public:
+    PhysicsTableCache(G4VModularPhysicsList *physicsList);
+    ~PhysicsTableCache() override = default;
+
+    G4bool Notify(G4ApplicationState requestedState) override;
+
+  private:
+    G4VModularPhysicsList *fPhysicsList;
+    G4String fCacheDirectory;  // empty: disabled
+
+    // Key of the tables in use, and whether they still have to be stored.
+    G4String fKey;
+    G4String fDescription;
+    G4bool fKeyChanged = false;
+    G4bool fRetrieved = false;
+    G4Timer fTimer;
+
+    void Prepare();
+    void Finish();
+    G4String Describe() const;
+    G4bool Store(const std::string &directory);
+};
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
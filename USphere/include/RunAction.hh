@@ -33,60 +33,106 @@
 #include "G4UserRunAction.hh"
 #include "G4Accumulable.hh"
 #include "G4Threading.hh"
+#include "G4Timer.hh"
 #include "globals.hh"
 
 #include <vector>
 
 class G4Run;
-class G4Timer;
-class TFile;
-class TTree;
 
 namespace B1
 {
 
 class StackingAction;
+class SteppingAction;
+class TreeWriter;
 
 /// Run action class
 ///
-/// In EndOfRunAction(), it calculates the dose in the selected volume
-/// from the energy deposit accumulated via stepping and event actions.
-/// The computed dose is then printed on the screen.
+/// In tree mode, every neutron of every event is stored in the output tree.
+/// In histogram mode, each thread accumulates fixed-bin time and generation
+/// histograms which are merged at end of run and written as a small file,
+/// optionally together with per-event population summaries. With no output,
+/// only the growth rate estimator is fed.
+///
+/// The output file is shared by all threads and keyed by run ID. Whichever
+/// thread needs it first opens it, so nothing depends on the order in which
+/// the master and the workers (or tasks) start the run; the master closes it
+/// once every event of the run has been processed.
 
 class RunAction : public G4UserRunAction
 {
   public:
-    RunAction(StackingAction *stackingAction);
-    ~RunAction() override = default;
+    enum class OutputMode { Tree, Histogram, None };
+
+    RunAction(StackingAction *stackingAction, SteppingAction *steppingAction);
+    ~RunAction() override;
 
     void BeginOfRunAction(const G4Run*) override;
     void   EndOfRunAction(const G4Run*) override;
 
     void AddEdep (G4double edep);
 
-    void FillTree();
+    void RecordEvent(G4int eventID);
+
+    static void SetOutputMode(OutputMode mode) { fOutputMode = mode; }
+    static OutputMode GetOutputMode() { return fOutputMode; }
+    static void SetEventSummary(G4bool enable) { fEventSummary = enable; }
+    static G4bool GetEventSummary() { return fEventSummary; }
+
+    // Histogram binning: times in ns, one bin per generation.
+    static constexpr G4int kNTimeBins = 250;
+    static constexpr G4double kTimeMax = 1250.0;
+    static constexpr G4int kNGenerationBins = 300;
+    static constexpr G4double kGenerationMax = 300.0;
 
   private:
     StackingAction *fStackingAction;
+    SteppingAction *fSteppingAction;
+    G4int fRunID = -1;
+    G4Timer fRunTimer;
+
+    // Global output settings.
+    static OutputMode fOutputMode;
+    static G4bool fEventSummary;
 
     // Global I/O resources.
     static G4Mutex fTreeMutex;
     static G4String fFileName;
     static G4String fTreeName;
-    static TFile *fFile;
-    static TTree *fTree;
-    static G4Timer *fTimer;
-    static G4double fTimeElapsed;
-    static G4double fTimeElapsedTotal;
-    static G4double fAutoSaveTimeSpan;
-
-    // Local I/O resources.
-    std::vector<int> fNeutronGeneration;
-    std::vector<double> fNeutronGlobalTime;
-
-    void InitializeTree();
-    void SaveTree();
-    void DestroyTree();
+    static TreeWriter *fWriter;
+    static G4int fOutputRunID;
+
+    // Per-event summary.
+    int fNeutronCount = 0;
+    int fMaxGeneration = 0;
+    double fMaxGlobalTime = 0.0;
+
+    // Histogram tallies merged at end of run.
+    std::vector<G4Accumulable<G4double>> fTimeHistogram;
+    std::vector<G4Accumulable<G4double>> fGenerationHistogram;
+
+    // Energy of secondaries killed in neutron-only mode.
+    G4Accumulable<G4double> fEdep = 0.0;
+
+    // Current batch for the growth rate estimator.
+    std::vector<G4double> fBatchTimeHistogram;
+    std::vector<G4double> fBatchGenerationHistogram;
+    G4int fBatchEvents = 0;
+    G4long fBatch = -1;
+
+    void BinEvent();
+    void OpenBatch();
+    void SubmitBatch(G4bool complete);
+    void FillTree();
+    void FillSummary();
+    void WriteHistograms(const G4Run *run);
+    void WriteFlux(const G4Run *run);
+    void ResetSubEvents();
+    void ProcessSubEvents();
+    TreeWriter *GetWriter();
+    void OpenOutput();
+    void CloseOutput();
 };
 
 }
@@ -0,0 +1,96 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/include/RunMessenger.hh
+/// \brief Definition of the B1::RunMessenger class
+
+#ifndef B1RunMessenger_h
+#define B1RunMessenger_h 1
+
+#include "globals.hh"
+#include "G4UImessenger.hh"
+
+class G4UIdirectory;
+class G4UIcmdWithAString;
+class G4UIcmdWithABool;
+class G4UIcmdWithADouble;
+class G4UIcmdWithAnInteger;
+class G4UIcommand;
+
+namespace B1
+{
+
+/// Messenger class that defines output and run control commands for
+/// B1::RunAction, B1::TreeWriter and B1::GrowthRateEstimator.
+///
+/// It implements commands:
+/// - /out/mode tree|histogram|none
+/// - /out/eventSummary true|false
+/// - /out/compression setting
+/// - /out/basketSize bytes
+/// - /out/autoFlush value
+/// - /out/autoSave MB
+/// - /out/queueSize MB
+/// - /out/floatTimes true|false
+/// - /out/shortGenerations true|false
+/// - /run/targetError value
+/// - /run/batchSize value
+/// - /run/minBatches value
+/// - /run/timeFitWindow lo hi unit
+/// - /run/generationFitWindow lo hi
+///
+/// The settings are shared by all threads, so the commands are only
+/// instantiated and executed on the master thread.
+
+class RunMessenger: public G4UImessenger
+{
+  public:
+    RunMessenger();
+    ~RunMessenger() override;
+
+    void SetNewValue(G4UIcommand *, G4String) override;
+
+  private:
+    G4UIdirectory *fOutDirectory = nullptr;
+    G4UIcmdWithAString *fSetMode = nullptr;
+    G4UIcmdWithABool *fSetEventSummary = nullptr;
+    G4UIcmdWithAnInteger *fSetCompression = nullptr;
+    G4UIcmdWithAnInteger *fSetBasketSize = nullptr;
+    G4UIcmdWithAnInteger *fSetAutoFlush = nullptr;
+    G4UIcmdWithAnInteger *fSetAutoSave = nullptr;
+    G4UIcmdWithAnInteger *fSetQueueSize = nullptr;
+    G4UIcmdWithABool *fSetFloatTimes = nullptr;
+    G4UIcmdWithABool *fSetShortGenerations = nullptr;
+    G4UIcmdWithADouble *fSetTargetError = nullptr;
+    G4UIcmdWithAnInteger *fSetBatchSize = nullptr;
+    G4UIcmdWithAnInteger *fSetMinBatches = nullptr;
+    G4UIcommand *fSetTimeFitWindow = nullptr;
+    G4UIcommand *fSetGenerationFitWindow = nullptr;
+};
+
+}
+
+#endif
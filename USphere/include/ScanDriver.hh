@@ -0,0 +1,93 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/include/ScanDriver.hh
+/// \brief Definition of the B1::ScanDriver class
+
+#ifndef B1ScanDriver_h
+#define B1ScanDriver_h 1
+
+#include "globals.hh"
+
+#include <fstream>
+#include <vector>
+
+namespace B1
+{
+
+class DetectorConstruction;
+class ScanMessenger;
+
+/// Scan driver class : run a sequence of geometries in one initialized
+/// process, or bisect the sphere radius on the measured growth rate to
+/// find the critical radius. One line per run is written to a summary table.
+///
+/// The bisection only moves on a growth rate whose sign is significant
+/// (|k| > n sigma); otherwise the point is run again to add statistics. The
+/// critical radius is the zero of a weighted straight-line fit of the growth
+/// rate against the radius over the points of the final bracket.
+
+class ScanDriver
+{
+  public:
+    ScanDriver(DetectorConstruction *detectorConstruction);
+    ~ScanDriver();
+
+    void ScanRadii(const std::vector<G4double> &radii);
+    void ScanEnrichments(const std::vector<G4double> &enrichments);
+    void FindCriticalRadius(G4double lo, G4double hi, G4double tolerance);
+
+    void SetNumberOfEvents(G4int events) { fNumberOfEvents = events; }
+    void SetSignificance(G4double significance) { fSignificance = significance; }
+    void SetFileName(const G4String &fileName);
+
+  private:
+    DetectorConstruction *fDetectorConstruction;
+    ScanMessenger *fMessenger;
+
+    G4int fNumberOfEvents = 10000;
+    G4int fMaxIterations = 20;
+    G4double fSignificance = 3.0;  // sigmas for the sign of a growth rate
+    G4int fMaxRepeats = 4;  // extra runs of a point without a significant sign
+    G4String fFileName = "USphere-scan.txt";
+    std::ofstream fFile;
+
+    struct Point
+    {
+      G4double radius;
+      G4double slope;
+      G4double error;
+    };
+
+    G4bool RunPoint(G4double &slope, G4double &error);
+    G4bool MeasurePoint(G4double radius, Point &point);
+};
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
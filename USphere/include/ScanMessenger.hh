@@ -0,0 +1,79 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/include/ScanMessenger.hh
+/// \brief Definition of the B1::ScanMessenger class
+
+#ifndef B1ScanMessenger_h
+#define B1ScanMessenger_h 1
+
+#include "globals.hh"
+#include "G4UImessenger.hh"
+
+class G4UIdirectory;
+class G4UIcommand;
+class G4UIcmdWithAString;
+class G4UIcmdWithAnInteger;
+class G4UIcmdWithADouble;
+
+namespace B1
+{
+
+class ScanDriver;
+
+/// Messenger class that defines commands for B1::ScanDriver.
+///
+/// It implements commands:
+/// - /scan/events value
+/// - /scan/output fileName
+/// - /scan/radii r1 r2 ... unit
+/// - /scan/enrichments e1 e2 ...
+/// - /scan/criticalRadius lo hi tolerance unit
+/// - /scan/significance value
+
+class ScanMessenger: public G4UImessenger
+{
+  public:
+    ScanMessenger(ScanDriver *);
+    ~ScanMessenger() override;
+
+    void SetNewValue(G4UIcommand *, G4String) override;
+
+  private:
+    ScanDriver *fScanDriver = nullptr;
+
+    G4UIdirectory *fScanDirectory = nullptr;
+    G4UIcmdWithAnInteger *fSetEvents = nullptr;
+    G4UIcmdWithAString *fSetOutput = nullptr;
+    G4UIcmdWithAString *fScanRadii = nullptr;
+    G4UIcmdWithAString *fScanEnrichments = nullptr;
+    G4UIcommand *fFindCriticalRadius = nullptr;
+    G4UIcmdWithADouble *fSetSignificance = nullptr;
+};
+
+}
+
+#endif
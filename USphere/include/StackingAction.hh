@@ -33,7 +33,10 @@
 #include "G4UserStackingAction.hh"
 #include "G4SystemOfUnits.hh"
 #include "globals.hh"
+#include "FissionSource.hh"
+#include "SubEventQueue.hh"
 #include <unordered_map>
+#include <vector>
 
 namespace B1
 {
@@ -42,8 +45,27 @@ class RunAction;
 
 /// Stacking action class : manage the newly generated particles
 ///
-/// One wishes do not track secondary neutrino.Therefore one kills it
-/// immediately, before created particles will  put in a stack.
+/// Neutrons are recorded with their birth time, generation and weight, and
+/// killed past the time or generation limit.
+///
+/// Optional population control keeps the cost of supercritical chains
+/// bounded while preserving expected weights:
+/// - in census mode, each generation waits until the previous one is done;
+///   the generation is then Russian-rouletted down to, or split up to, the
+///   target population;
+/// - above the stack watermark, newborn neutrons survive with probability
+///   1/2 and double their weight.
+///
+/// In k-eigenvalue mode, fission neutrons are banked as sites of the next
+/// cycle's source and killed instead of being tracked.
+///
+/// In neutron-only mode, every other secondary is killed at birth. Its
+/// kinetic energy can be summed per event as an estimate of the energy it
+/// would have deposited; the estimate counts escaping photons as absorbed.
+///
+/// A census generation reaching the sub-event threshold is taken off the
+/// stack, after population control, and handed to idle threads as
+/// sub-events (see SubEventQueue).
 
 class StackingAction : public G4UserStackingAction
 {
@@ -54,17 +76,61 @@ class StackingAction : public G4UserStackingAction
     ~StackingAction() override = default;
 
     G4ClassificationOfNewTrack ClassifyNewTrack(const G4Track*) override;
+    void NewStage() override;
+    void PrepareNewEvent() override;
 
     void ResetRecords();
 
+    // Global population control settings.
+    static void SetCensus(G4bool census) { fCensus = census; }
+    static void SetTargetPopulation(G4int population) { fTargetPopulation = population; }
+    static void SetSplitting(G4bool splitting) { fSplitting = splitting; }
+    static void SetWatermark(G4int watermark) { fWatermark = watermark; }
+    static G4bool IsWeighted() { return fCensus || fWatermark; }
+    static G4bool IsCensus() { return fCensus; }
+    static void SetNeutronOnly(G4bool neutronOnly) { fNeutronOnly = neutronOnly || fNeutronOnlyRequired; }
+    static G4bool GetNeutronOnly() { return fNeutronOnly; }
+    // For physics lists without EM physics: neutron-only cannot be turned off.
+    static void RequireNeutronOnly() { fNeutronOnly = fNeutronOnlyRequired = true; }
+    static G4bool IsNeutronOnlyRequired() { return fNeutronOnlyRequired; }
+    static void SetDepositEstimate(G4bool estimate) { fDepositEstimate = estimate; }
+    static G4bool GetDepositEstimate() { return fDepositEstimate; }
+
   private:
     std::unordered_map<G4int, G4int> fGenerationMap;
     std::unordered_map<G4int, G4double> fGlobalTimeMap;
+    std::unordered_map<G4int, G4double> fWeightMap;
+    std::vector<FissionSite> fFissionSites;
+    G4double fKilledEnergy = 0.0;
     G4int fMaxGeneration = 0;  // 0: unset
     G4double fMaxGlobalTime = 1000 * ns;  // 0: unset
 
+    static G4bool fCensus;
+    static G4int fTargetPopulation;  // 0: unset
+    static G4bool fSplitting;
+    static G4int fWatermark;  // 0: unset
+    static G4bool fNeutronOnly;
+    static G4bool fNeutronOnlyRequired;
+    static G4bool fDepositEstimate;
+
+    // Census state of the current event.
+    G4int fCensusGeneration = 1;
+    G4double fSurvival = 1.0;
+    G4int fSplit = 1;
+    G4bool fReclassifying = false;
+    G4bool fPushingCopies = false;
+    G4bool fOffloading = false;
+    std::vector<SubEventNeutron> fOffloaded;
+    const SubEvent *fSubEvent = nullptr;
+    G4long fBatch = -1;  // growth rate estimator batch, set by RunAction
+
     G4int GetAndRecordGeneration(const G4Track *track);
     G4double GetAndRecordGlobalTime(const G4Track *track);
+    void RecordWeight(const G4Track *track);
+    void BankFissionSite(const G4Track *track);
+    G4ClassificationOfNewTrack Roulette(const G4Track *track, G4double survival);
+    void Split(const G4Track *track, G4int split);
+    void Offload(const G4Track *track);
 };
 
 }
@@ -0,0 +1,79 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/include/StackingMessenger.hh
+/// \brief Definition of the B1::StackingMessenger class
+
+#ifndef B1StackingMessenger_h
+#define B1StackingMessenger_h 1
+
+#include "globals.hh"
+#include "G4UImessenger.hh"
+
+class G4UIdirectory;
+class G4UIcmdWithABool;
+class G4UIcmdWithAnInteger;
+
+namespace B1
+{
+
+/// Messenger class that defines population control commands for
+/// B1::StackingAction.
+///
+/// It implements commands:
+/// - /stack/census true|false
+/// - /stack/targetPopulation value
+/// - /stack/splitting true|false
+/// - /stack/watermark value
+/// - /stack/neutronOnly true|false
+/// - /stack/depositEstimate true|false
+/// - /stack/subEventThreshold value
+///
+/// The settings are shared by all threads, so the commands are only
+/// instantiated and executed on the master thread.
+
+class StackingMessenger: public G4UImessenger
+{
+  public:
+    StackingMessenger();
+    ~StackingMessenger() override;
+
+    void SetNewValue(G4UIcommand *, G4String) override;
+
+  private:
+    G4UIdirectory *fStackDirectory = nullptr;
+    G4UIcmdWithABool *fSetCensus = nullptr;
+    G4UIcmdWithAnInteger *fSetTargetPopulation = nullptr;
+    G4UIcmdWithABool *fSetSplitting = nullptr;
+    G4UIcmdWithAnInteger *fSetWatermark = nullptr;
+    G4UIcmdWithABool *fSetNeutronOnly = nullptr;
+    G4UIcmdWithABool *fSetDepositEstimate = nullptr;
+    G4UIcmdWithAnInteger *fSetSubEventThreshold = nullptr;
+};
+
+}
+
+#endif
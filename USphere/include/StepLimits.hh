@@ -0,0 +1,75 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/include/StepLimits.hh
+/// \brief Definition of the B1::StepLimits class
+
+#ifndef B1StepLimits_h
+#define B1StepLimits_h 1
+
+#include "G4UserLimits.hh"
+#include "globals.hh"
+
+#include <utility>
+#include <vector>
+
+class G4ParticleDefinition;
+
+namespace B1
+{
+
+/// User limits with a maximum step per particle species.
+///
+/// Limits are fractions of the Sphere radius, so they follow radius scans.
+/// Particles without a limit of their own use the default one; a fraction
+/// of 0 turns limiting off.
+
+class StepLimits : public G4UserLimits
+{
+  public:
+    StepLimits(G4double radius, G4double fraction);
+    ~StepLimits() override = default;
+
+    G4double GetMaxAllowedStep(const G4Track &track) override;
+
+    void SetRadius(G4double radius) { fRadius = radius; }
+    void SetDefaultFraction(G4double fraction) { fDefaultFraction = fraction; }
+    void SetFraction(const G4ParticleDefinition *particle, G4double fraction);
+    void Print() const;
+
+  private:
+    G4double fRadius;
+    G4double fDefaultFraction;
+
+    // A handful of species at most, so a linear search is cheapest.
+    std::vector<std::pair<const G4ParticleDefinition *, G4double>> fFractions;
+
+    static G4double ToStep(G4double radius, G4double fraction);
+};
+
+}
+
+#endif
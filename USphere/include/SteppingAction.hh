@@ -0,0 +1,74 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/include/SteppingAction.hh
+/// \brief Definition of the B1::SteppingAction class
+
+#ifndef B1SteppingAction_h
+#define B1SteppingAction_h 1
+
+#include "G4UserSteppingAction.hh"
+#include "globals.hh"
+
+#include <vector>
+
+class G4LogicalVolume;
+
+namespace B1
+{
+
+/// Stepping action class : score the neutron track-length flux of the
+/// Sphere into this thread's dense radius x time array.
+///
+/// Each step is scored at the radius and global time of its midpoint, after
+/// splitting steps longer than a shell into pieces.
+
+class SteppingAction : public G4UserSteppingAction
+{
+  public:
+    SteppingAction() = default;
+    ~SteppingAction() override = default;
+
+    void UserSteppingAction(const G4Step*) override;
+
+    void BeginOfRun();
+    void EndOfRun();
+
+  private:
+    G4bool fEnabled = false;
+    G4LogicalVolume *fSphere = nullptr;
+    G4int fShells = 0;
+    G4int fTimeBins = 0;
+    G4double fInverseShellWidth = 0.0;
+    G4double fInverseTimeWidth = 0.0;
+    std::vector<G4double> fFlux;
+};
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,120 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/include/SubEventQueue.hh
+/// \brief Definition of the B1::SubEventQueue class
+
+#ifndef B1SubEventQueue_h
+#define B1SubEventQueue_h 1
+
+#include "G4ThreeVector.hh"
+#include "G4Threading.hh"
+#include "globals.hh"
+
+#include <deque>
+#include <vector>
+
+namespace B1
+{
+
+/// A neutron taken off the stack of its owning event.
+
+struct SubEventNeutron
+{
+  G4ThreeVector position;
+  G4ThreeVector direction;
+  G4double energy = 0.0;
+  G4double time = 0.0;
+  G4double weight = 1.0;
+};
+
+/// A share of one census generation, transported apart from its event.
+
+struct SubEvent
+{
+  G4int eventID = -1;
+  G4int generation = 0;
+  G4long batch = -1;  // growth rate estimator batch of the owning event
+  std::vector<SubEventNeutron> neutrons;
+};
+
+/// Sub-event queue : spread heavy events over otherwise idle threads.
+///
+/// When a census generation of an event reaches the threshold population,
+/// the stacking action takes it off the stack and submits it here, split
+/// into one sub-event per worker thread. Workers that are done with their
+/// share of the run's events transport queued sub-events before ending the
+/// run, until none is left and no thread can submit more. Sub-event
+/// neutrons were recorded at birth by their owning event; their progeny
+/// keep the owner's generation count and time axis and are tallied by the
+/// thread that transports them, into the growth rate estimator batch of
+/// their owning event, so the merged and batch tallies are the owners'.
+///
+/// Only MT runs with census, and without tree output or k-eigenvalue
+/// cycles, whose records are per event, hand sub-events over.
+
+class SubEventQueue
+{
+  public:
+    static SubEventQueue *Instance();
+
+    // Called by the master at the beginning of each run.
+    void Reset(G4bool enabled);
+    G4bool IsEnabled() const { return fEnabled; }
+
+    void Submit(G4int eventID, G4int generation, G4long batch, std::vector<SubEventNeutron> neutrons);
+
+    // Threads transporting events or sub-events may submit more.
+    void Enter();
+    void Leave();
+    // Wait for a sub-event and enter; false once there is none left.
+    G4bool Take(SubEvent &subEvent);
+
+    // Sub-event transported by this thread, if any.
+    static const SubEvent *GetCurrent() { return fCurrent; }
+    static void SetCurrent(const SubEvent *subEvent) { fCurrent = subEvent; }
+
+    static void SetThreshold(G4int threshold) { fThreshold = threshold; }
+    static G4int GetThreshold() { return fThreshold; }
+
+  private:
+    SubEventQueue() = default;
+
+    static G4int fThreshold;  // 0: unset
+    static G4ThreadLocal const SubEvent *fCurrent;
+
+    G4bool fEnabled = false;
+    G4Mutex fMutex;
+    G4Condition fCondition;
+    std::deque<SubEvent> fQueue;
+    G4int fActive = 0;
+};
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
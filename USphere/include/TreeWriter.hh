@@ -0,0 +1,124 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/include/TreeWriter.hh
+/// \brief Definition of the B1::TreeWriter class
+
+#ifndef B1TreeWriter_h
+#define B1TreeWriter_h 1
+
+#include "G4Threading.hh"
+#include "globals.hh"
+
+#include <condition_variable>
+#include <deque>
+#include <thread>
+#include <vector>
+
+class TFile;
+class TTree;
+
+namespace B1
+{
+
+/// Tree writer class : owns the output file and fills its tree on a
+/// background I/O thread.
+///
+/// Event records are queued by the workers and filled, compressed and
+/// checkpointed by the I/O thread, so workers only wait when the queue
+/// exceeds its size limit. The tree is checkpointed (AutoSave) whenever
+/// the compressed size has grown by the configured number of bytes.
+/// Storage settings are global and apply to files opened afterwards.
+
+class TreeWriter
+{
+  public:
+    enum class Layout { None, Neutrons, Summary };
+
+    struct Record
+    {
+      std::vector<int> neutronGeneration;
+      std::vector<double> neutronGlobalTime;
+      std::vector<double> neutronWeight;
+      int neutronCount = 0;
+      int maxGeneration = 0;
+      double maxGlobalTime = 0.0;
+    };
+
+    TreeWriter(const G4String &fileName, const G4String &treeName, Layout layout, G4bool weighted);
+    ~TreeWriter();
+
+    void Push(Record &&record);
+    void Finish();
+    TFile *GetFile() const { return fFile; }
+
+    // Global storage settings.
+    static void SetCompression(G4int compression) { fCompression = compression; }
+    static void SetBasketSize(G4int size) { fBasketSize = size; }
+    static void SetAutoFlush(G4long autoFlush) { fAutoFlush = autoFlush; }
+    static void SetAutoSaveBytes(G4long bytes) { fAutoSaveBytes = bytes; }
+    static void SetQueueBytes(G4long bytes) { fQueueBytes = bytes; }
+    static void SetFloatTimes(G4bool enable) { fFloatTimes = enable; }
+    static void SetShortGenerations(G4bool enable) { fShortGenerations = enable; }
+
+  private:
+    static G4int fCompression;  // algorithm * 100 + level, < 0: ROOT default
+    static G4int fBasketSize;  // 0: ROOT default
+    static G4long fAutoFlush;  // 0: ROOT default
+    static G4long fAutoSaveBytes;  // 0: never
+    static G4long fQueueBytes;
+    static G4bool fFloatTimes;
+    static G4bool fShortGenerations;
+
+    G4String fTreeName;
+    Layout fLayout;
+    TFile *fFile = nullptr;
+    TTree *fTree = nullptr;
+
+    // Queue shared with the I/O thread.
+    G4Mutex fMutex;
+    std::condition_variable fPushed;
+    std::condition_variable fPopped;
+    std::deque<Record> fQueue;
+    G4long fQueuedBytes = 0;
+    G4bool fFinishing = false;
+    std::thread fThread;
+
+    // Branch buffers, used by the I/O thread only.
+    Record fRecord;
+    std::vector<short> fShortGeneration;
+    G4long fGenerationOverflows = 0;  // generations saturated to 16 bits
+    std::vector<float> fFloatGlobalTime;
+    Long64_t fSavedBytes = 0;
+
+    void Loop();
+    void Fill(Record &record);
+    static G4long GetBytes(const Record &record);
+};
+
+}
+
+#endif
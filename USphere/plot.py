@@ -11,15 +11,30 @@ import matplotlib.pyplot as plt
 logfile = open(re.sub(r'\.py$', '.log', __file__), 'w')
 def print(*args, **kwargs): builtins.print(*args, **kwargs); builtins.print(*args, **{**kwargs, 'file': logfile})
 
-tree = uproot.open('USphere.root:tree')
-gt, gen = tree.arrays(('NeutronGlobalTime', 'NeutronGeneration'), how=tuple)
-n = len(gt)
+file = uproot.open('USphere.root')
+if 'NeutronGlobalTime' in file:  # histogram mode
+    gt, gen = None, None
+    n = int(file['NumberOfEvents'].member('fVal'))
+else:
+    tree = file['tree']
+    gt, gen = tree.arrays(('NeutronGlobalTime', 'NeutronGeneration'), how=tuple)
+    weight = ak.flatten(tree['NeutronWeight'].array()) if 'NeutronWeight' in tree else None
+    n = len(gt)
 print('%d events loaded' % n)
 
+def hist(name, data, bins):
+    if data is None:  # rebin merged tallies
+        counts, _ = file[name].to_numpy()
+        number = counts.reshape(len(bins) - 1, -1).sum(axis=1) / n
+        plt.stairs(number, bins, label='simulation')
+        return number, bins, None
+    w = np.ones_like(ak.flatten(data)) if weight is None else weight
+    return plt.hist(ak.flatten(data), bins, weights=w / n, histtype='step', label='simulation')
+
 plt.style.use(hep.styles.CMS)
 
 plt.figure(figsize=(10, 8))
-number, bins, _ = plt.hist(ak.flatten(gt), np.linspace(0, 1250, 51), weights=np.ones_like(ak.flatten(gt)) / n, histtype='step', label='simulation')
+number, bins, _ = hist('NeutronGlobalTime', gt, np.linspace(0, 1250, 51))
 time = (bins[:-1] + bins[1:]) / 2.0
 
 range_to_fit = np.arange(400 * len(time) // bins[-1], 1000 * len(time) // bins[-1], dtype='int')
@@ -52,7 +67,7 @@ plt.close()
 # ------------------------------------------------------------
 
 plt.figure(figsize=(10, 8))
-number, bins, _ = plt.hist(ak.flatten(gen), np.linspace(0, 300, 51), weights=np.ones_like(ak.flatten(gen)) / n, histtype='step', label='simulation')
+number, bins, _ = hist('NeutronGeneration', gen, np.linspace(0, 300, 51))
 generation = (bins[:-1] + bins[1:]) / 2.0
 
 range_to_fit = np.arange(54 * len(time) // bins[-1], 156 * len(time) // bins[-1], dtype='int')
@@ -30,17 +30,40 @@
 #include "ActionInitialization.hh"
 #include "PrimaryGeneratorAction.hh"
 #include "RunAction.hh"
+#include "RunMessenger.hh"
 #include "EventAction.hh"
 #include "StackingAction.hh"
+#include "StackingMessenger.hh"
+#include "SteppingAction.hh"
+#include "FluxMeshMessenger.hh"
 
 namespace B1
 {
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+ActionInitialization::ActionInitialization()
+{
+  // Run and stacking settings are global, while the actions live on
+  // workers. Under tasking the master thread may also build worker actions,
+  // so the messengers are owned here, once per process.
+  fRunMessenger = new RunMessenger;
+  fStackingMessenger = new StackingMessenger;
+  fFluxMeshMessenger = new FluxMeshMessenger;
+}
+
+ActionInitialization::~ActionInitialization()
+{
+  delete fFluxMeshMessenger;
+  delete fStackingMessenger;
+  delete fRunMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
 void ActionInitialization::BuildForMaster() const
 {
-  auto runAction = new RunAction(NULL);
+  auto runAction = new RunAction(NULL, NULL);
   SetUserAction(runAction);
 }
 
@@ -54,7 +77,10 @@ void ActionInitialization::Build() const
   auto stackingAction = new StackingAction;
   SetUserAction(stackingAction);
 
-  auto runAction = new RunAction(stackingAction);
+  auto steppingAction = new SteppingAction;
+  SetUserAction(steppingAction);
+
+  auto runAction = new RunAction(stackingAction, steppingAction);
   SetUserAction(runAction);
 
   auto eventAction = new EventAction(runAction);
@@ -29,6 +29,8 @@
 
 #include "DetectorConstruction.hh"
 #include "DetectorMessenger.hh"
+#include "StepLimits.hh"
+#include "FastNeutronModel.hh"
 
 #include "G4Isotope.hh"
 #include "G4Element.hh"
@@ -38,7 +40,7 @@
 #include "G4Sphere.hh"
 #include "G4LogicalVolume.hh"
 #include "G4PVPlacement.hh"
-#include "G4UserLimits.hh"
+#include "G4Region.hh"
 #include "G4RunManager.hh"
 #include "G4SystemOfUnits.hh"
 
@@ -51,10 +53,12 @@ namespace B1
 DetectorConstruction::DetectorConstruction()
 {
   fMessenger = new DetectorMessenger(this);
+  fStepLimits = new StepLimits(fRadius, 0.01);
 }
 
 DetectorConstruction::~DetectorConstruction()
 {
+  delete fStepLimits;
   delete fMessenger;
 }
 
@@ -82,28 +86,51 @@ G4VPhysicalVolume* DetectorConstruction::Construct()
    */
   auto solidSphere = new G4Sphere("Sphere", 0.0, fRadius, 0, CLHEP::twopi, 0, CLHEP::pi);
   auto logicalSphere = new G4LogicalVolume(solidSphere, sphereMaterial, "Sphere");
-  logicalSphere->SetUserLimits(new G4UserLimits(0.01 * fRadius));
+  logicalSphere->SetUserLimits(fStepLimits);
   new G4PVPlacement(0, { }, logicalSphere, "Sphere", logicalWorld, false, 0, checkOverlaps);
 
+  /*
+   * Envelope of the fast neutron model.
+   */
+  auto sphereRegion = new G4Region("Sphere");
+  sphereRegion->AddRootLogicalVolume(logicalSphere);
+
   /*
    * Initialize fields.
    */
   fWorld = logicalWorld;
   fSphere = logicalSphere;
+  fSphereRegion = sphereRegion;
   return physicalWorld;
 }
 
-G4Material *DetectorConstruction::GetUMaterial(G4double U235Enrichment) const
+void DetectorConstruction::ConstructSDandField()
+{
+  // One model per thread; it stays idle unless /det/fastNeutron is set.
+  if(FastNeutronModel::IsAvailable()) new FastNeutronModel("FastNeutron", fSphereRegion);
+}
+
+G4Material *DetectorConstruction::GetUMaterial(G4double U235Enrichment)
 {
   if(!(U235Enrichment >= 0.0 && U235Enrichment <= 100.0)) {
     throw std::invalid_argument("unexpected U235 enrichment: " + std::to_string(U235Enrichment));
   }
-  G4Element *U_elem = new G4Element("U", "U", 3);
-  U_elem->AddIsotope(new G4Isotope("U235", 92, 235, 235.04 * (g / mole)), U235Enrichment);
-  U_elem->AddIsotope(new G4Isotope("U238", 92, 238, 238.05 * (g / mole)), (100.0 - U235Enrichment) * (5.27 / 6.29));
-  U_elem->AddIsotope(new G4Isotope("U234", 92, 234, 234.05 * (g / mole)), (100.0 - U235Enrichment) * (1.02 / 6.29));
-  G4Material *U = new G4Material("U", 18.74 * (g / cm3), 1);
+  auto it = fUMaterials.find(U235Enrichment);
+  if(it != fUMaterials.end()) return it->second;
+
+  if(!fU235) {
+    fU235 = new G4Isotope("U235", 92, 235, 235.04 * (g / mole));
+    fU238 = new G4Isotope("U238", 92, 238, 238.05 * (g / mole));
+    fU234 = new G4Isotope("U234", 92, 234, 234.05 * (g / mole));
+  }
+  G4String name = "U-" + std::to_string(U235Enrichment);
+  G4Element *U_elem = new G4Element(name, "U", 3);
+  U_elem->AddIsotope(fU235, U235Enrichment);
+  U_elem->AddIsotope(fU238, (100.0 - U235Enrichment) * (5.27 / 6.29));
+  U_elem->AddIsotope(fU234, (100.0 - U235Enrichment) * (1.02 / 6.29));
+  G4Material *U = new G4Material(name, 18.74 * (g / cm3), 1);
   U->AddElement(U_elem, 1);
+  fUMaterials.emplace(U235Enrichment, U);
   return U;
 }
 
@@ -114,13 +141,16 @@ void DetectorConstruction::SetRadius(G4double radius)
   if(fWorld) ((G4Box *)fWorld->GetSolid())->SetYHalfLength(radius * 1.2);
   if(fWorld) ((G4Box *)fWorld->GetSolid())->SetZHalfLength(radius * 1.2);
   if(fSphere) ((G4Sphere *)fSphere->GetSolid())->SetOuterRadius(radius);
+  fStepLimits->SetRadius(radius);
   G4RunManager::GetRunManager()->GeometryHasBeenModified();
 }
 
 void DetectorConstruction::SetU235Enrichment(G4double enrichment)
 {
+  G4Material *material = GetUMaterial(enrichment);
   fU235Enrichment = enrichment;
-  if(fSphere) fSphere->SetMaterial(GetUMaterial(enrichment));
+  if(!fSphere || fSphere->GetMaterial() == material) return;
+  fSphere->SetMaterial(material);
   G4RunManager::GetRunManager()->GeometryHasBeenModified();
 }
 
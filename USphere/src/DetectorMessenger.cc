@@ -29,10 +29,17 @@
 
 #include "DetectorMessenger.hh"
 #include "DetectorConstruction.hh"
+#include "StepLimits.hh"
+#include "FastNeutronModel.hh"
 
 #include "G4UIdirectory.hh"
+#include "G4UIcmdWithABool.hh"
 #include "G4UIcmdWithADouble.hh"
 #include "G4UIcmdWithADoubleAndUnit.hh"
+#include "G4UIparameter.hh"
+#include "G4ParticleTable.hh"
+
+#include <sstream>
 
 namespace B1
 {
@@ -56,12 +63,35 @@ DetectorMessenger::DetectorMessenger(DetectorConstruction *det)
   setU235Enrichment->SetParameterName("enrichment", false);
   setU235Enrichment->AvailableForStates(G4State_PreInit, G4State_Idle);
   fSetU235Enrichment = setU235Enrichment;
+
+  auto setStepLimit = new G4UIcommand("/det/stepLimit", this);
+  setStepLimit->SetGuidance("Limit the steps of a particle species in the Sphere to a");
+  setStepLimit->SetGuidance("fraction of its radius (0: unlimited). \"all\" sets the limit");
+  setStepLimit->SetGuidance("of every species without one of its own; the default is 0.01.");
+  setStepLimit->SetParameter(new G4UIparameter("particle", 's', false));
+  auto fraction = new G4UIparameter("fraction", 'd', false);
+  fraction->SetParameterRange("fraction >= 0");
+  setStepLimit->SetParameter(fraction);
+  setStepLimit->AvailableForStates(G4State_PreInit, G4State_Idle);
+  fSetStepLimit = setStepLimit;
+
+  auto setFastNeutron = new G4UIcmdWithABool("/det/fastNeutron", this);
+  setFastNeutron->SetGuidance("Transport neutrons below 20 MeV in the Sphere with the fast model:");
+  setFastNeutron->SetGuidance("tabulated macroscopic cross sections and analytic free flights.");
+  setFastNeutron->SetGuidance("Needs USPHERE_FAST_NEUTRON=1 at startup.");
+  setFastNeutron->SetParameterName("enable", true);
+  setFastNeutron->SetDefaultValue(true);
+  setFastNeutron->AvailableForStates(G4State_PreInit, G4State_Idle);
+  setFastNeutron->SetToBeBroadcasted(false);
+  fSetFastNeutron = setFastNeutron;
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 DetectorMessenger::~DetectorMessenger()
 {
+  delete fSetFastNeutron;
+  delete fSetStepLimit;
   delete fSetU235Enrichment;
   delete fSetRadius;
   delete fDetDirectory;
@@ -80,6 +110,34 @@ void DetectorMessenger::SetNewValue(G4UIcommand *command, G4String newValue)
     fDetectorConstruction->SetU235Enrichment(fSetU235Enrichment->GetNewDoubleValue(newValue));
     return;
   }
+
+  if(command == fSetStepLimit) {
+    G4String name;
+    G4double fraction;
+    std::istringstream(newValue) >> name >> fraction;
+    auto stepLimits = fDetectorConstruction->GetStepLimits();
+    if(name == "all") stepLimits->SetDefaultFraction(fraction);
+    else if(auto particle = G4ParticleTable::GetParticleTable()->FindParticle(name)) {
+      stepLimits->SetFraction(particle, fraction);
+    }
+    else {
+      G4cerr << "/det/stepLimit: unknown particle " << name << G4endl;
+      return;
+    }
+    stepLimits->Print();
+    return;
+  }
+
+  if(command == fSetFastNeutron) {
+    G4bool enabled = fSetFastNeutron->GetNewBoolValue(newValue);
+    if(enabled && !FastNeutronModel::IsAvailable()) {
+      G4cerr << "/det/fastNeutron: the fast simulation process is only registered"
+             << " with USPHERE_FAST_NEUTRON=1" << G4endl;
+      return;
+    }
+    FastNeutronModel::SetEnabled(enabled);
+    return;
+  }
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
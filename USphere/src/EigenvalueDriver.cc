@@ -0,0 +1,187 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/src/EigenvalueDriver.cc
+/// \brief Implementation of the B1::EigenvalueDriver class
+
+#include "EigenvalueDriver.hh"
+#include "EigenvalueMessenger.hh"
+#include "DetectorConstruction.hh"
+#include "GrowthRateEstimator.hh"
+#include "RunAction.hh"
+
+#include "G4RunManager.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4RandomDirection.hh"
+#include "Randomize.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <stdexcept>
+
+namespace B1
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+EigenvalueDriver::EigenvalueDriver(DetectorConstruction *detectorConstruction)
+  : fDetectorConstruction(detectorConstruction)
+{
+  fMessenger = new EigenvalueMessenger(this);
+}
+
+EigenvalueDriver::~EigenvalueDriver()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EigenvalueDriver::Run()
+{
+  std::ofstream file(fFileName);
+  if(!file) throw std::runtime_error("error opening eigenvalue output file: " + fFileName);
+  file << "# cycle active k_cycle entropy[bits] k_eff err_k_eff" << std::endl;
+
+  // The first source is the usual thermal neutron at the centre.
+  std::vector<FissionSite> source(fPopulation);
+  for(auto &site : source) {
+    site.direction = G4RandomDirection();
+    site.energy = 0.025 * eV;
+  }
+
+  // Only the fission bank is needed, and a cycle must not stop early.
+  auto outputMode = RunAction::GetOutputMode();
+  auto estimator = GrowthRateEstimator::Instance();
+  auto targetError = estimator->GetTargetError();
+  RunAction::SetOutputMode(RunAction::OutputMode::None);
+  estimator->SetTargetError(0.0);
+
+  auto fissionSource = FissionSource::Instance();
+  fissionSource->SetSitesPerEvent(fSitesPerEvent);
+  FissionSource::SetActive(true);
+
+  G4double sum = 0.0, sum2 = 0.0, keff = 0.0, error = 0.0;
+  G4int active = 0;
+  for(G4int cycle = 1; cycle <= fInactiveCycles + fActiveCycles; ++cycle) {
+    G4double entropy = ShannonEntropy(source);
+    G4double sourceWeight = 0.0;
+    for(const auto &site : source) sourceWeight += site.weight;
+    fissionSource->SetSource(std::move(source));
+    G4RunManager::GetRunManager()->BeamOn(fissionSource->GetNumberOfEvents());
+
+    auto bank = fissionSource->TakeBank();
+    G4double producedWeight = 0.0;
+    for(const auto &site : bank) producedWeight += site.weight;
+    G4double k = producedWeight / sourceWeight;
+
+    G4bool isActive = cycle > fInactiveCycles;
+    if(isActive) {
+      sum += k;
+      sum2 += k * k;
+      ++active;
+      keff = sum / active;
+      error = active > 1 ? std::sqrt(std::max(0.0, sum2 / active - keff * keff) / (active - 1)) : 0.0;
+    }
+    G4cout << "EigenvalueDriver: cycle " << cycle << (isActive ? " (active)" : " (inactive)")
+           << " k = " << k << ", H = " << entropy << " bits";
+    if(isActive) G4cout << ", k_eff = " << keff << " (" << error << ")";
+    G4cout << G4endl;
+    file << cycle << " " << isActive << " " << k << " " << entropy << " "
+         << keff << " " << error << std::endl;
+
+    if(bank.empty()) {
+      G4cerr << "EigenvalueDriver: no fission neutrons in cycle " << cycle << ", stopping" << G4endl;
+      break;
+    }
+    source = Resample(bank);
+  }
+
+  FissionSource::SetActive(false);
+  fissionSource->SetSource({});
+  estimator->SetTargetError(targetError);
+  RunAction::SetOutputMode(outputMode);
+
+  G4cout << G4endl << " k_eff = " << keff << " (" << error << ") over " << active
+         << " active cycles of " << fPopulation << " neutrons, radius "
+         << fDetectorConstruction->GetRadius() / cm << " cm, U235 enrichment "
+         << fDetectorConstruction->GetU235Enrichment() << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::vector<FissionSite> EigenvalueDriver::Resample(const std::vector<FissionSite> &bank) const
+{
+  // Systematic sampling in proportion to weight; the new source has unit
+  // weights and the nominal population.
+  G4double total = 0.0;
+  for(const auto &site : bank) total += site.weight;
+  G4double step = total / fPopulation, next = G4UniformRand() * step, cumulative = 0.0;
+  std::vector<FissionSite> source;
+  source.reserve(fPopulation);
+  for(const auto &site : bank) {
+    cumulative += site.weight;
+    for(G4bool copy = false; next < cumulative && (G4int)source.size() < fPopulation; copy = true) {
+      source.push_back(site);
+      source.back().weight = 1.0;
+      // Fission neutrons are emitted isotropically; copies must not share a path.
+      if(copy) source.back().direction = G4RandomDirection();
+      next += step;
+    }
+  }
+  while((G4int)source.size() < fPopulation) {
+    source.push_back(bank.back());
+    source.back().weight = 1.0;
+    source.back().direction = G4RandomDirection();
+  }
+  return source;
+}
+
+G4double EigenvalueDriver::ShannonEntropy(const std::vector<FissionSite> &source) const
+{
+  // Mesh over the cube enclosing the Sphere.
+  G4double radius = fDetectorConstruction->GetRadius();
+  std::vector<G4double> counts(fEntropyMesh * fEntropyMesh * fEntropyMesh, 0.0);
+  G4double total = 0.0;
+  auto bin = [&](G4double x) {
+    return std::clamp((G4int)((x + radius) / (2.0 * radius) * fEntropyMesh), 0, fEntropyMesh - 1);
+  };
+  for(const auto &site : source) {
+    const auto &p = site.position;
+    counts[(bin(p.x()) * fEntropyMesh + bin(p.y())) * fEntropyMesh + bin(p.z())] += site.weight;
+    total += site.weight;
+  }
+  G4double entropy = 0.0;
+  for(G4double count : counts) {
+    if(count > 0.0) entropy -= count / total * std::log2(count / total);
+  }
+  return entropy;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
@@ -0,0 +1,159 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/src/EigenvalueMessenger.cc
+/// \brief Implementation of the B1::EigenvalueMessenger class
+
+#include "EigenvalueMessenger.hh"
+#include "EigenvalueDriver.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithAnInteger.hh"
+#include "G4UIcmdWithoutParameter.hh"
+
+namespace B1
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+EigenvalueMessenger::EigenvalueMessenger(EigenvalueDriver *eigenvalueDriver)
+ : fEigenvalueDriver(eigenvalueDriver)
+{
+  fEigenDirectory = new G4UIdirectory("/eigen/");
+  fEigenDirectory->SetGuidance("k-eigenvalue calculation by fission source iteration");
+
+  auto setPopulation = new G4UIcmdWithAnInteger("/eigen/population", this);
+  setPopulation->SetGuidance("Number of source neutrons per cycle.");
+  setPopulation->SetParameterName("population", false);
+  setPopulation->SetRange("population > 0");
+  setPopulation->AvailableForStates(G4State_PreInit, G4State_Idle);
+  setPopulation->SetToBeBroadcasted(false);
+  fSetPopulation = setPopulation;
+
+  auto setSitesPerEvent = new G4UIcmdWithAnInteger("/eigen/sitesPerEvent", this);
+  setSitesPerEvent->SetGuidance("Number of source neutrons per event.");
+  setSitesPerEvent->SetParameterName("sites", false);
+  setSitesPerEvent->SetRange("sites > 0");
+  setSitesPerEvent->AvailableForStates(G4State_PreInit, G4State_Idle);
+  setSitesPerEvent->SetToBeBroadcasted(false);
+  fSetSitesPerEvent = setSitesPerEvent;
+
+  auto setInactive = new G4UIcmdWithAnInteger("/eigen/inactive", this);
+  setInactive->SetGuidance("Number of cycles discarded while the source converges.");
+  setInactive->SetParameterName("cycles", false);
+  setInactive->SetRange("cycles >= 0");
+  setInactive->AvailableForStates(G4State_PreInit, G4State_Idle);
+  setInactive->SetToBeBroadcasted(false);
+  fSetInactive = setInactive;
+
+  auto setActive = new G4UIcmdWithAnInteger("/eigen/active", this);
+  setActive->SetGuidance("Number of cycles averaged into k_eff.");
+  setActive->SetParameterName("cycles", false);
+  setActive->SetRange("cycles > 0");
+  setActive->AvailableForStates(G4State_PreInit, G4State_Idle);
+  setActive->SetToBeBroadcasted(false);
+  fSetActive = setActive;
+
+  auto setEntropyMesh = new G4UIcmdWithAnInteger("/eigen/entropyMesh", this);
+  setEntropyMesh->SetGuidance("Bins per axis of the Shannon entropy mesh.");
+  setEntropyMesh->SetParameterName("bins", false);
+  setEntropyMesh->SetRange("bins > 0");
+  setEntropyMesh->AvailableForStates(G4State_PreInit, G4State_Idle);
+  setEntropyMesh->SetToBeBroadcasted(false);
+  fSetEntropyMesh = setEntropyMesh;
+
+  auto setOutput = new G4UIcmdWithAString("/eigen/output", this);
+  setOutput->SetGuidance("Per-cycle table file name.");
+  setOutput->SetParameterName("fileName", false);
+  setOutput->AvailableForStates(G4State_PreInit, G4State_Idle);
+  setOutput->SetToBeBroadcasted(false);
+  fSetOutput = setOutput;
+
+  auto run = new G4UIcmdWithoutParameter("/eigen/run", this);
+  run->SetGuidance("Run the inactive and active cycles.");
+  run->AvailableForStates(G4State_Idle);
+  run->SetToBeBroadcasted(false);
+  fRun = run;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+EigenvalueMessenger::~EigenvalueMessenger()
+{
+  delete fRun;
+  delete fSetOutput;
+  delete fSetEntropyMesh;
+  delete fSetActive;
+  delete fSetInactive;
+  delete fSetSitesPerEvent;
+  delete fSetPopulation;
+  delete fEigenDirectory;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EigenvalueMessenger::SetNewValue(G4UIcommand *command, G4String newValue)
+{
+  if(command == fSetPopulation) {
+    fEigenvalueDriver->SetPopulation(fSetPopulation->GetNewIntValue(newValue));
+    return;
+  }
+
+  if(command == fSetSitesPerEvent) {
+    fEigenvalueDriver->SetSitesPerEvent(fSetSitesPerEvent->GetNewIntValue(newValue));
+    return;
+  }
+
+  if(command == fSetInactive) {
+    fEigenvalueDriver->SetInactiveCycles(fSetInactive->GetNewIntValue(newValue));
+    return;
+  }
+
+  if(command == fSetActive) {
+    fEigenvalueDriver->SetActiveCycles(fSetActive->GetNewIntValue(newValue));
+    return;
+  }
+
+  if(command == fSetEntropyMesh) {
+    fEigenvalueDriver->SetEntropyMesh(fSetEntropyMesh->GetNewIntValue(newValue));
+    return;
+  }
+
+  if(command == fSetOutput) {
+    fEigenvalueDriver->SetFileName(newValue);
+    return;
+  }
+
+  if(command == fRun) {
+    fEigenvalueDriver->Run();
+    return;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
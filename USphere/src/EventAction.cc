@@ -29,6 +29,7 @@
 
 #include "EventAction.hh"
 #include "RunAction.hh"
+#include "GrowthRateEstimator.hh"
 
 #include "G4Event.hh"
 #include "G4RunManager.hh"
@@ -51,10 +52,15 @@ void EventAction::BeginOfEventAction(const G4Event*)
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-void EventAction::EndOfEventAction(const G4Event*)
+void EventAction::EndOfEventAction(const G4Event* event)
 {
   // accumulate statistics in run action
-  fRunAction->FillTree();
+  fRunAction->RecordEvent(event->GetEventID());
+
+  // stop softly once the growth rate is known precisely enough
+  if(GrowthRateEstimator::Instance()->IsStopRequested()) {
+    G4RunManager::GetRunManager()->AbortRun(true);
+  }
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
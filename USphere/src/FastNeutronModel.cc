@@ -0,0 +1,286 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/src/FastNeutronModel.cc
+/// \brief Implementation of the B1::FastNeutronModel class
+
+#include "FastNeutronModel.hh"
+
+#include "G4FastTrack.hh"
+#include "G4FastStep.hh"
+#include "G4Sphere.hh"
+#include "G4Material.hh"
+#include "G4Neutron.hh"
+#include "G4Track.hh"
+#include "G4DynamicParticle.hh"
+#include "G4GeometryTolerance.hh"
+#include "G4HadronicProcessStore.hh"
+#include "G4HadronicProcess.hh"
+#include "G4HadronicInteraction.hh"
+#include "G4EnergyRangeManager.hh"
+#include "G4HadProjectile.hh"
+#include "G4HadFinalState.hh"
+#include "G4CrossSectionDataStore.hh"
+#include "G4Nucleus.hh"
+#include "G4Log.hh"
+#include "G4ios.hh"
+#include "Randomize.hh"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <stdexcept>
+
+namespace B1
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool FastNeutronModel::fAvailable = false;
+G4bool FastNeutronModel::fEnabled = false;
+std::map<const G4Material *, std::unique_ptr<const FastNeutronModel::Table>> FastNeutronModel::fTables;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+FastNeutronModel::FastNeutronModel(const G4String &name, G4Region *envelope)
+  : G4VFastSimulationModel(name, envelope)
+{ }
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool FastNeutronModel::IsApplicable(const G4ParticleDefinition &particle)
+{
+  return &particle == G4Neutron::Neutron();
+}
+
+G4bool FastNeutronModel::ModelTrigger(const G4FastTrack &fastTrack)
+{
+  if(!fEnabled) return false;
+  G4double energy = fastTrack.GetPrimaryTrack()->GetKineticEnergy();
+  if(energy < kMinEnergy || energy > kMaxEnergy) return false;
+
+  // On the surface on its way out: leave the neutron to the navigator.
+  return DistanceToBoundary(fastTrack) > G4GeometryTolerance::GetInstance()->GetSurfaceTolerance();
+}
+
+void FastNeutronModel::DoIt(const G4FastTrack &fastTrack, G4FastStep &fastStep)
+{
+  const G4Track *track = fastTrack.GetPrimaryTrack();
+  const G4Material *material = track->GetMaterial();
+  if(material != fMaterial) {
+    fTable = FindTable(material);
+    fMaterial = material;
+  }
+
+  // Free flight up to the next collision or the boundary.
+  CrossSections crossSections = fTable->Interpolate(track->GetKineticEnergy());
+  G4double total = 0.0;
+  for(G4double crossSection : crossSections) total += crossSection;
+  G4double boundary = DistanceToBoundary(fastTrack);
+  G4double flight = total > 0.0 ? -G4Log(G4UniformRand()) / total : DBL_MAX;
+  G4double length = std::min(flight, boundary);
+  G4double flightTime = length / track->CalculateVelocity();
+  G4double mass = track->GetDynamicParticle()->GetMass();
+  G4double time = track->GetGlobalTime() + flightTime;
+  G4ThreeVector position = fastTrack.GetPrimaryTrackLocalPosition() + length * fastTrack.GetPrimaryTrackLocalDirection();
+  fastStep.ProposePrimaryTrackFinalPosition(position);
+  fastStep.ProposePrimaryTrackFinalTime(time);
+  fastStep.ProposePrimaryTrackFinalProperTime(track->GetProperTime() + flightTime * mass / track->GetTotalEnergy());
+  fastStep.ProposePrimaryTrackPathLength(length);
+  if(flight >= boundary) return;
+
+  // Sample the channel of the collision.
+  G4double channelSample = total * G4UniformRand();
+  G4int channel = 0;
+  while(channel < kNChannels - 1 && channelSample >= crossSections[channel]) {
+    channelSample -= crossSections[channel++];
+  }
+  Interact(fastTrack, fastStep, (Channel)channel, position, time);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool FastNeutronModel::IsFissionNeutron(const G4Track *track)
+{
+  return dynamic_cast<const FissionTag *>(track->GetUserInformation()) != nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+FastNeutronModel::CrossSections FastNeutronModel::Table::Interpolate(G4double energy) const
+{
+  // Lin-lin between grid points, as the HP data themselves.
+  size_t i = std::upper_bound(energies.begin(), energies.end(), energy) - energies.begin();
+  if(i == 0) return crossSections.front();
+  if(i == energies.size()) return crossSections.back();
+  G4double fraction = (energy - energies[i - 1]) / (energies[i] - energies[i - 1]);
+  CrossSections result;
+  for(G4int channel = 0; channel < kNChannels; ++channel) {
+    result[channel] = crossSections[i - 1][channel] + fraction * (crossSections[i][channel] - crossSections[i - 1][channel]);
+  }
+  return result;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+const FastNeutronModel::Table *FastNeutronModel::FindTable(const G4Material *material)
+{
+  // Read-only during the event loop.
+  auto it = fTables.find(material);
+  if(it != fTables.end()) return it->second.get();
+  throw std::runtime_error("no fast neutron cross section table for " + material->GetName());
+}
+
+void FastNeutronModel::BuildTable(const G4Material *material)
+{
+  if(fTables.count(material)) return;
+
+  // Coarse logarithmic grid, each interval bisected on demand.
+  auto table = std::make_unique<Table>();
+  G4double decades = std::log10(kMaxEnergy / kMinEnergy);
+  G4int intervals = (G4int)std::ceil(decades * kPointsPerDecade);
+  G4double lowEnergy = kMinEnergy;
+  CrossSections low = ComputeCrossSections(material, lowEnergy);
+  table->energies.push_back(lowEnergy);
+  table->crossSections.push_back(low);
+  for(G4int i = 1; i <= intervals; ++i) {
+    G4double highEnergy = kMinEnergy * std::pow(10.0, decades * i / intervals);
+    CrossSections high = ComputeCrossSections(material, highEnergy);
+    Refine(material, *table, lowEnergy, low, highEnergy, high, 0);
+    lowEnergy = highEnergy;
+    low = high;
+  }
+  G4cout << "FastNeutronModel: " << table->energies.size() << " grid points for "
+         << material->GetName() << G4endl;
+  fTables.emplace(material, std::move(table));
+}
+
+FastNeutronModel::CrossSections FastNeutronModel::ComputeCrossSections(const G4Material *material, G4double energy)
+{
+  auto store = G4HadronicProcessStore::Instance();
+  auto neutron = G4Neutron::Neutron();
+  CrossSections result;
+  result[kElastic] = store->GetElasticCrossSectionPerVolume(neutron, energy, material);
+  result[kInelastic] = store->GetInelasticCrossSectionPerVolume(neutron, energy, material);
+  result[kCapture] = store->GetCaptureCrossSectionPerVolume(neutron, energy, material);
+  result[kFission] = store->GetFissionCrossSectionPerVolume(neutron, energy, material);
+  return result;
+}
+
+void FastNeutronModel::Refine(const G4Material *material, Table &table, G4double lowEnergy,
+                              const CrossSections &low, G4double highEnergy, const CrossSections &high, G4int depth)
+{
+  // Bisect in log energy while interpolation misses the midpoint, then
+  // append the upper end; the lower end is already in the table.
+  G4double energy = std::sqrt(lowEnergy * highEnergy);
+  CrossSections middle = ComputeCrossSections(material, energy);
+  G4double fraction = (energy - lowEnergy) / (highEnergy - lowEnergy);
+  G4double total = 0.0, error = 0.0;
+  for(G4int channel = 0; channel < kNChannels; ++channel) {
+    total += middle[channel];
+    G4double interpolation = low[channel] + fraction * (high[channel] - low[channel]);
+    error = std::max(error, std::fabs(interpolation - middle[channel]));
+  }
+  if(depth < kMaxDepth && error > kTolerance * total) {
+    Refine(material, table, lowEnergy, low, energy, middle, depth + 1);
+    Refine(material, table, energy, middle, highEnergy, high, depth + 1);
+    return;
+  }
+  table.energies.push_back(highEnergy);
+  table.crossSections.push_back(high);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double FastNeutronModel::DistanceToBoundary(const G4FastTrack &fastTrack)
+{
+  // Forward intersection with the outer surface of the sphere.
+  G4double radius = static_cast<const G4Sphere *>(fastTrack.GetEnvelopeSolid())->GetOuterRadius();
+  const G4ThreeVector &position = fastTrack.GetPrimaryTrackLocalPosition();
+  const G4ThreeVector &direction = fastTrack.GetPrimaryTrackLocalDirection();
+  G4double b = position.dot(direction);
+  G4double discriminant = b * b - (position.mag2() - radius * radius);
+  if(discriminant <= 0.0) return 0.0;
+  return std::max(std::sqrt(discriminant) - b, 0.0);
+}
+
+void FastNeutronModel::Interact(const G4FastTrack &fastTrack, G4FastStep &fastStep, Channel channel,
+                                const G4ThreeVector &position, G4double time)
+{
+  static const G4HadronicProcessType processTypes[kNChannels] = {
+    fHadronElastic, fHadronInelastic, fCapture, fFission
+  };
+  const G4Track *track = fastTrack.GetPrimaryTrack();
+  const G4Material *material = track->GetMaterial();
+  auto process = G4HadronicProcessStore::Instance()->FindProcess(G4Neutron::Neutron(), processTypes[channel]);
+  if(!process) return;
+
+  // Target nucleus and model, as the process itself picks them through its
+  // energy range manager (ChooseHadronicInteraction is protected).
+  G4CrossSectionDataStore *dataStore = process->GetCrossSectionDataStore();
+  dataStore->ComputeCrossSection(track->GetDynamicParticle(), material);
+  G4Nucleus target;
+  const G4Element *element = dataStore->SampleZandA(track->GetDynamicParticle(), material, target);
+  G4HadProjectile projectile(*track);
+  G4HadronicInteraction *model =
+    process->GetManagerPointer()->GetHadronicInteraction(projectile, target, material, element);
+  G4HadFinalState *result = model ? model->ApplyYourself(projectile, target) : nullptr;
+  if(!result) return;
+
+  // The final state is given along the projectile and rotated about it at
+  // random, as in G4HadronicProcess::FillResult.
+  G4double rotation = CLHEP::twopi * G4UniformRand();
+  const G4ThreeVector axis(0.0, 0.0, 1.0);
+  const G4ThreeVector &direction = fastTrack.GetPrimaryTrackLocalDirection();
+  fastStep.ProposeTotalEnergyDeposited(result->GetLocalEnergyDeposit());
+  if(result->GetStatusChange() == stopAndKill) fastStep.KillPrimaryTrack();
+  else {
+    G4ThreeVector newDirection = result->GetMomentumChange();
+    newDirection.rotate(rotation, axis);
+    newDirection.rotateUz(direction);
+    fastStep.ProposePrimaryTrackFinalKineticEnergyAndDirection(std::max(result->GetEnergyChange(), 0.0), newDirection);
+  }
+
+  G4int nSecondaries = (G4int)result->GetNumberOfSecondaries();
+  fastStep.SetNumberOfSecondaryTracks(nSecondaries);
+  for(G4int i = 0; i < nSecondaries; ++i) {
+    G4HadSecondary *secondary = result->GetSecondary(i);
+    G4DynamicParticle *particle = secondary->GetParticle();
+    G4LorentzVector momentum = particle->Get4Momentum();
+    momentum.rotate(rotation, axis);
+    momentum.rotateUz(direction);
+    particle->Set4Momentum(momentum);
+    G4Track *newTrack = fastStep.CreateSecondaryTrack(*particle, position, time + std::max(secondary->GetTime(), 0.0));
+    newTrack->SetWeight(track->GetWeight() * secondary->GetWeight());
+    if(channel == kFission) newTrack->SetUserInformation(new FissionTag);
+    delete particle;
+  }
+  result->Clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
@@ -0,0 +1,86 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/src/FissionSource.cc
+/// \brief Implementation of the B1::FissionSource class
+
+#include "FissionSource.hh"
+
+#include "G4AutoLock.hh"
+
+#include <algorithm>
+
+namespace B1
+{
+
+G4bool FissionSource::fActive = false;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+FissionSource *FissionSource::Instance()
+{
+  static FissionSource instance;
+  return &instance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int FissionSource::GetNumberOfEvents() const
+{
+  return (fSource.size() + fSitesPerEvent - 1) / fSitesPerEvent;
+}
+
+std::pair<const FissionSite *, const FissionSite *> FissionSource::GetEventSites(G4int eventID) const
+{
+  size_t begin = std::min(fSource.size(), (size_t)eventID * fSitesPerEvent);
+  size_t end = std::min(fSource.size(), begin + fSitesPerEvent);
+  return { fSource.data() + begin, fSource.data() + end };
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void FissionSource::Bank(G4int eventID, const std::vector<FissionSite> &sites)
+{
+  G4AutoLock lock(fMutex);
+  fBank.emplace_back(eventID, sites);
+}
+
+std::vector<FissionSite> FissionSource::TakeBank()
+{
+  G4AutoLock lock(fMutex);
+  std::sort(fBank.begin(), fBank.end(),
+            [](const auto &a, const auto &b) { return a.first < b.first; });
+  std::vector<FissionSite> sites;
+  for(auto &[eventID, eventSites] : fBank) {
+    sites.insert(sites.end(), eventSites.begin(), eventSites.end());
+  }
+  fBank.clear();
+  return sites;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
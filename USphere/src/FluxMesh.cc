@@ -0,0 +1,85 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/src/FluxMesh.cc
+/// \brief Implementation of the B1::FluxMesh class
+
+#include "FluxMesh.hh"
+
+#include "G4AutoLock.hh"
+#include "G4PhysicalConstants.hh"
+
+#include <TH2D.h>
+
+namespace B1
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+FluxMesh *FluxMesh::Instance()
+{
+  static FluxMesh instance;
+  return &instance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void FluxMesh::Reset()
+{
+  G4AutoLock lock(fMutex);
+  fFlux.assign(fEnabled ? fShells * fTimeBins : 0, 0.0);
+}
+
+void FluxMesh::Merge(const std::vector<G4double> &flux)
+{
+  G4AutoLock lock(fMutex);
+  if(flux.size() != fFlux.size()) return;
+  for(size_t i = 0; i < flux.size(); ++i) fFlux[i] += flux[i];
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void FluxMesh::Write(G4double radius, G4int events) const
+{
+  // Written to the current ROOT directory.
+  G4AutoLock lock(fMutex);
+  if(fFlux.empty() || events == 0) return;
+  TH2D flux("NeutronFlux", "NeutronFlux;Radius [cm];Global Time [ns];Flux [cm^{-2}]",
+            fShells, 0.0, radius / cm, fTimeBins, 0.0, fTimeMax / ns);
+  G4double width = radius / fShells;
+  for(G4int shell = 0; shell < fShells; ++shell) {
+    G4double inner = shell * width, outer = inner + width;
+    G4double volume = 4.0 / 3.0 * pi * (outer * outer * outer - inner * inner * inner);
+    for(G4int bin = 0; bin < fTimeBins; ++bin) {
+      flux.SetBinContent(shell + 1, bin + 1, fFlux[shell * fTimeBins + bin] / volume / events * cm2);
+    }
+  }
+  flux.Write();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
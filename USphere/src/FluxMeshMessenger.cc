@@ -0,0 +1,122 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/src/FluxMeshMessenger.cc
+/// \brief Implementation of the B1::FluxMeshMessenger class
+
+#include "FluxMeshMessenger.hh"
+#include "FluxMesh.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithAnInteger.hh"
+#include "G4UIcmdWithADoubleAndUnit.hh"
+
+namespace B1
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+FluxMeshMessenger::FluxMeshMessenger()
+{
+  fFluxDirectory = new G4UIdirectory("/flux/");
+  fFluxDirectory->SetGuidance("Radial x time track-length flux tally of the Sphere");
+
+  auto setEnable = new G4UIcmdWithABool("/flux/enable", this);
+  setEnable->SetGuidance("Score the neutron flux and write it as the NeutronFlux histogram.");
+  setEnable->SetParameterName("enable", true);
+  setEnable->SetDefaultValue(true);
+  setEnable->AvailableForStates(G4State_PreInit, G4State_Idle);
+  setEnable->SetToBeBroadcasted(false);
+  fSetEnable = setEnable;
+
+  auto setShells = new G4UIcmdWithAnInteger("/flux/shells", this);
+  setShells->SetGuidance("Number of radial shells of equal width.");
+  setShells->SetParameterName("shells", false);
+  setShells->SetRange("shells > 0");
+  setShells->AvailableForStates(G4State_PreInit, G4State_Idle);
+  setShells->SetToBeBroadcasted(false);
+  fSetShells = setShells;
+
+  auto setTimeBins = new G4UIcmdWithAnInteger("/flux/timeBins", this);
+  setTimeBins->SetGuidance("Number of global time bins.");
+  setTimeBins->SetParameterName("bins", false);
+  setTimeBins->SetRange("bins > 0");
+  setTimeBins->AvailableForStates(G4State_PreInit, G4State_Idle);
+  setTimeBins->SetToBeBroadcasted(false);
+  fSetTimeBins = setTimeBins;
+
+  auto setTimeMax = new G4UIcmdWithADoubleAndUnit("/flux/timeMax", this);
+  setTimeMax->SetGuidance("Upper edge of the last time bin.");
+  setTimeMax->SetParameterName("time", false);
+  setTimeMax->SetRange("time > 0");
+  setTimeMax->SetUnitCategory("Time");
+  setTimeMax->AvailableForStates(G4State_PreInit, G4State_Idle);
+  setTimeMax->SetToBeBroadcasted(false);
+  fSetTimeMax = setTimeMax;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+FluxMeshMessenger::~FluxMeshMessenger()
+{
+  delete fSetTimeMax;
+  delete fSetTimeBins;
+  delete fSetShells;
+  delete fSetEnable;
+  delete fFluxDirectory;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void FluxMeshMessenger::SetNewValue(G4UIcommand *command, G4String newValue)
+{
+  auto fluxMesh = FluxMesh::Instance();
+
+  if(command == fSetEnable) {
+    fluxMesh->SetEnabled(fSetEnable->GetNewBoolValue(newValue));
+    return;
+  }
+
+  if(command == fSetShells) {
+    fluxMesh->SetShells(fSetShells->GetNewIntValue(newValue));
+    return;
+  }
+
+  if(command == fSetTimeBins) {
+    fluxMesh->SetTimeBins(fSetTimeBins->GetNewIntValue(newValue));
+    return;
+  }
+
+  if(command == fSetTimeMax) {
+    fluxMesh->SetTimeMax(fSetTimeMax->GetNewDoubleValue(newValue));
+    return;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
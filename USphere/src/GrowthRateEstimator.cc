@@ -0,0 +1,247 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/src/GrowthRateEstimator.cc
+/// \brief Implementation of the B1::GrowthRateEstimator class
+
+#include "GrowthRateEstimator.hh"
+#include "GrowthRateFit.hh"
+#include "RunAction.hh"
+
+#include "G4AutoLock.hh"
+
+#include <algorithm>
+#include <cmath>
+
+namespace B1
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+GrowthRateEstimator *GrowthRateEstimator::Instance()
+{
+  static GrowthRateEstimator instance;
+  return &instance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+GrowthRateEstimator::GrowthRateEstimator()
+{
+  Reset();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void GrowthRateEstimator::Reset()
+{
+  G4AutoLock lock(fMutex);
+  fStopRequested = false;
+  fTimeSlopes.clear();
+  fGenerationSlopes.clear();
+  fDroppedTimeBatches = 0;
+  fDroppedGenerationBatches = 0;
+  fTimeHistogram.assign(RunAction::kNTimeBins, 0.0);
+  fGenerationHistogram.assign(RunAction::kNGenerationBins, 0.0);
+  fEvents = 0;
+  fHeldBatches.clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void GrowthRateEstimator::AddSubEvents(G4long batch, G4int subEvents)
+{
+  G4AutoLock lock(fMutex);
+  GetHeldBatch(batch).subEvents += subEvents;
+}
+
+void GrowthRateEstimator::SubmitBatch(G4long batch, const std::vector<G4double> &timeHistogram,
+                                      const std::vector<G4double> &generationHistogram,
+                                      G4int events, G4bool complete)
+{
+  // Without sub-events, the batch is closed right away.
+  Batch held;
+  {
+    G4AutoLock lock(fMutex);
+    auto it = fHeldBatches.find(batch);
+    if(it == fHeldBatches.end()) {
+      lock.unlock();
+      Close(timeHistogram, generationHistogram, events, complete);
+      return;
+    }
+    Batch &pending = it->second;
+    for(size_t i = 0; i < timeHistogram.size(); ++i) pending.timeHistogram[i] += timeHistogram[i];
+    for(size_t i = 0; i < generationHistogram.size(); ++i) pending.generationHistogram[i] += generationHistogram[i];
+    pending.events = events;
+    pending.complete = complete;
+    pending.submitted = true;
+    if(pending.subEvents > 0) return;
+    held = std::move(pending);
+    fHeldBatches.erase(it);
+  }
+  Close(held.timeHistogram, held.generationHistogram, held.events, held.complete);
+}
+
+void GrowthRateEstimator::SubmitSubEvent(G4long batch, const std::vector<G4double> &timeHistogram,
+                                         const std::vector<G4double> &generationHistogram)
+{
+  // The last of the batch's sub-events closes it, once the batch is in.
+  Batch held;
+  {
+    G4AutoLock lock(fMutex);
+    Batch &pending = GetHeldBatch(batch);
+    for(size_t i = 0; i < timeHistogram.size(); ++i) pending.timeHistogram[i] += timeHistogram[i];
+    for(size_t i = 0; i < generationHistogram.size(); ++i) pending.generationHistogram[i] += generationHistogram[i];
+    if(--pending.subEvents > 0 || !pending.submitted) return;
+    held = std::move(pending);
+    fHeldBatches.erase(batch);
+  }
+  Close(held.timeHistogram, held.generationHistogram, held.events, held.complete);
+}
+
+GrowthRateEstimator::Batch &GrowthRateEstimator::GetHeldBatch(G4long batch)
+{
+  // Called with the mutex held.
+  Batch &held = fHeldBatches[batch];
+  if(held.timeHistogram.empty()) {
+    held.timeHistogram.assign(RunAction::kNTimeBins, 0.0);
+    held.generationHistogram.assign(RunAction::kNGenerationBins, 0.0);
+  }
+  return held;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void GrowthRateEstimator::Close(const std::vector<G4double> &timeHistogram,
+                                const std::vector<G4double> &generationHistogram,
+                                G4int events, G4bool complete)
+{
+  // Fit outside the lock; incomplete batches, and the sub-events of other
+  // threads' batches, only enter the merged tallies.
+  GrowthRateFitResult timeFit, generationFit;
+  if(complete && events > 0) {
+    timeFit = GrowthRateFit(timeHistogram, 0.0, RunAction::kTimeMax / RunAction::kNTimeBins,
+                            fTimeWindow[0], fTimeWindow[1]);
+    generationFit = GrowthRateFit(generationHistogram, 0.0, RunAction::kGenerationMax / RunAction::kNGenerationBins,
+                                  fGenerationWindow[0], fGenerationWindow[1]);
+  }
+
+  G4AutoLock lock(fMutex);
+  for(size_t i = 0; i < timeHistogram.size(); ++i) fTimeHistogram[i] += timeHistogram[i];
+  for(size_t i = 0; i < generationHistogram.size(); ++i) fGenerationHistogram[i] += generationHistogram[i];
+  fEvents += events;
+  if(complete && events > 0) {
+    if(timeFit.valid) fTimeSlopes.push_back(timeFit.slope);
+    else ++fDroppedTimeBatches;
+    if(generationFit.valid) fGenerationSlopes.push_back(generationFit.slope);
+    else ++fDroppedGenerationBatches;
+  }
+
+  // The error of k is compared as is: it is also the relative error of exp(k).
+  if(fTargetError <= 0.0 || fStopRequested) return;
+  Estimate timeEstimate = MakeEstimate(fTimeSlopes);
+  Estimate generationEstimate = MakeEstimate(fGenerationSlopes);
+  G4int minBatches = std::max(fMinBatches, 2);
+  if(timeEstimate.batches < minBatches || generationEstimate.batches < minBatches) return;
+  if(timeEstimate.error > fTargetError || generationEstimate.error > fTargetError) return;
+  fStopRequested = true;
+  G4cout << "GrowthRateEstimator: target error " << fTargetError << " of k reached after "
+         << fEvents.load() << " events, stopping run" << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+GrowthRateEstimator::Estimate GrowthRateEstimator::GetTimeEstimate() const
+{
+  G4AutoLock lock(fMutex);
+  Estimate estimate = MakeEstimate(fTimeSlopes);
+  estimate.dropped = fDroppedTimeBatches;
+  GrowthRateFitResult fit = GrowthRateFit(fTimeHistogram, 0.0, RunAction::kTimeMax / RunAction::kNTimeBins,
+                                          fTimeWindow[0], fTimeWindow[1]);
+  estimate.valid = fit.valid;
+  estimate.slope = fit.slope;
+  if(estimate.batches < 2) estimate.error = fit.slopeError;
+  return estimate;
+}
+
+GrowthRateEstimator::Estimate GrowthRateEstimator::GetGenerationEstimate() const
+{
+  G4AutoLock lock(fMutex);
+  Estimate estimate = MakeEstimate(fGenerationSlopes);
+  estimate.dropped = fDroppedGenerationBatches;
+  GrowthRateFitResult fit = GrowthRateFit(fGenerationHistogram, 0.0, RunAction::kGenerationMax / RunAction::kNGenerationBins,
+                                          fGenerationWindow[0], fGenerationWindow[1]);
+  estimate.valid = fit.valid;
+  estimate.slope = fit.slope;
+  if(estimate.batches < 2) estimate.error = fit.slopeError;
+  return estimate;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void GrowthRateEstimator::Print() const
+{
+  Estimate timeEstimate = GetTimeEstimate();
+  Estimate generationEstimate = GetGenerationEstimate();
+  G4cout << G4endl << " Growth rate over " << fEvents.load() << " events" << G4endl;
+  for(auto [name, estimate] : { std::make_pair("time [1/ns]", timeEstimate),
+                                std::make_pair("generation", generationEstimate) }) {
+    if(!estimate.valid) {
+      G4cout << "  " << name << ": no valid fit" << G4endl;
+      continue;
+    }
+    G4cout << "  " << name << ": k = " << estimate.slope << " (" << estimate.error << "), exp(k) = "
+           << std::exp(estimate.slope) << " (" << std::exp(estimate.slope) * estimate.error << "), "
+           << estimate.batches << " batches";
+    if(estimate.dropped > 0)
+      G4cout << ", " << estimate.dropped << " batches dropped (fit failed)";
+    G4cout << G4endl;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+GrowthRateEstimator::Estimate GrowthRateEstimator::MakeEstimate(const std::vector<G4double> &slopes) const
+{
+  Estimate estimate;
+  estimate.batches = slopes.size();
+  if(slopes.empty()) return estimate;
+  G4double mean = 0.0;
+  for(G4double slope : slopes) mean += slope;
+  mean /= slopes.size();
+  estimate.valid = true;
+  estimate.slope = mean;
+  if(slopes.size() < 2) return estimate;
+  G4double variance = 0.0;
+  for(G4double slope : slopes) variance += (slope - mean) * (slope - mean);
+  variance /= slopes.size() - 1;
+  estimate.error = std::sqrt(variance / slopes.size());
+  return estimate;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
@@ -0,0 +1,123 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/src/GrowthRateFit.cc
+/// \brief Implementation of the B1::GrowthRateFit function
+
+#include "GrowthRateFit.hh"
+
+#include <cmath>
+
+namespace B1
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+GrowthRateFitResult GrowthRateFit(const std::vector<double> &counts,
+                                  double xmin, double width, double lo, double hi)
+{
+  GrowthRateFitResult result;
+
+  // Select bins fully inside the window; x is centered for conditioning.
+  std::vector<double> x, n;
+  double tolerance = 1e-9 * width;
+  for(size_t i = 0; i < counts.size(); ++i) {
+    double low = xmin + i * width;
+    if(low < lo - tolerance || low + width > hi + tolerance) continue;
+    x.push_back(low + 0.5 * width);
+    n.push_back(counts[i]);
+  }
+  size_t nonzero = 0;
+  double xc = 0.0;
+  for(size_t i = 0; i < x.size(); ++i) {
+    xc += x[i];
+    if(n[i] > 0.0) ++nonzero;
+  }
+  if(x.size() < 3 || nonzero < 2) return result;
+  xc /= x.size();
+  for(double &xi : x) xi -= xc;
+
+  // Start from a weighted log-linear fit.
+  double s0 = 0.0, s1 = 0.0, s2 = 0.0, t0 = 0.0, t1 = 0.0;
+  for(size_t i = 0; i < x.size(); ++i) {
+    double w = n[i] + 0.5, y = std::log(n[i] + 0.5);
+    s0 += w; s1 += w * x[i]; s2 += w * x[i] * x[i];
+    t0 += w * y; t1 += w * x[i] * y;
+  }
+  double det = s0 * s2 - s1 * s1;
+  if(!(det > 0.0)) return result;
+  double a = (s2 * t0 - s1 * t1) / det;
+  double k = (s0 * t1 - s1 * t0) / det;
+
+  // Maximize the Poisson likelihood sum(n ln mu - mu), mu = exp(a + k x).
+  auto likelihood = [&](double aa, double kk) {
+    double l = 0.0;
+    for(size_t i = 0; i < x.size(); ++i) {
+      double lnmu = aa + kk * x[i];
+      l += n[i] * lnmu - std::exp(lnmu);
+    }
+    return l;
+  };
+  double l = likelihood(a, k);
+  double i00 = 0.0, i01 = 0.0, i11 = 0.0;
+  for(int iteration = 0; iteration < 100; ++iteration) {
+    double g0 = 0.0, g1 = 0.0;
+    i00 = i01 = i11 = 0.0;
+    for(size_t i = 0; i < x.size(); ++i) {
+      double mu = std::exp(a + k * x[i]);
+      g0 += n[i] - mu; g1 += (n[i] - mu) * x[i];
+      i00 += mu; i01 += mu * x[i]; i11 += mu * x[i] * x[i];
+    }
+    det = i00 * i11 - i01 * i01;
+    if(!(det > 0.0)) return result;
+    double da = (i11 * g0 - i01 * g1) / det;
+    double dk = (i00 * g1 - i01 * g0) / det;
+
+    // Halve the step until the likelihood does not decrease.
+    double step = 1.0, lnew = l;
+    for(int halving = 0; halving < 30; ++halving, step *= 0.5) {
+      lnew = likelihood(a + step * da, k + step * dk);
+      if(lnew >= l) break;
+    }
+    if(!(lnew >= l)) break;
+    a += step * da;
+    k += step * dk;
+    bool converged = std::fabs(step * dk) <= 1e-12 * (1.0 + std::fabs(k)) && lnew - l <= 1e-12 * (1.0 + std::fabs(l));
+    l = lnew;
+    if(converged) break;
+  }
+  if(!(det > 0.0) || !std::isfinite(k)) return result;
+
+  result.valid = true;
+  result.slope = k;
+  result.slopeError = std::sqrt(i00 / det);
+  result.intercept = a - k * xc;
+  return result;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
@@ -0,0 +1,66 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/src/NeutronPhysicsList.cc
+/// \brief Implementation of the B1::NeutronPhysicsList class
+
+#include "NeutronPhysicsList.hh"
+
+#include "G4DecayPhysics.hh"
+#include "G4HadronElasticPhysicsHP.hh"
+#include "G4HadronPhysicsQGSP_BIC_HP.hh"
+#include "G4NeutronTrackingCut.hh"
+#include "G4SystemOfUnits.hh"
+
+namespace B1
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+NeutronPhysicsList::NeutronPhysicsList()
+{
+  SetVerboseLevel(1);
+  defaultCutValue = 0.7 * mm;
+
+  // All particle definitions, fission fragments included.
+  RegisterPhysics(new G4DecayPhysics(verboseLevel));
+
+  // Neutron transport as in QGSP_BIC_HP.
+  RegisterPhysics(new G4HadronElasticPhysicsHP(verboseLevel));
+  RegisterPhysics(new G4HadronPhysicsQGSP_BIC_HP(verboseLevel));
+  RegisterPhysics(new G4NeutronTrackingCut(verboseLevel));
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void NeutronPhysicsList::SetCuts()
+{
+  SetCutsWithDefault();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
@@ -0,0 +1,196 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/src/PhysicsTableCache.cc
+/// \brief Implementation of the B1::PhysicsTableCache class
+
+#include "PhysicsTableCache.hh"
+
+#include "G4VModularPhysicsList.hh"
+#include "G4VPhysicsConstructor.hh"
+#include "G4StateManager.hh"
+#include "G4LogicalVolumeStore.hh"
+#include "G4LogicalVolume.hh"
+#include "G4RegionStore.hh"
+#include "G4Region.hh"
+#include "G4ProductionCuts.hh"
+#include "G4Material.hh"
+#include "G4Element.hh"
+#include "G4Isotope.hh"
+#include "G4Version.hh"
+#include "G4ios.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <set>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <unistd.h>
+
+namespace B1
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+PhysicsTableCache::PhysicsTableCache(G4VModularPhysicsList *physicsList)
+  : fPhysicsList(physicsList)
+{
+  if(auto cache = getenv("USPHERE_TABLE_CACHE")) fCacheDirectory = cache;
+  else if(auto xdgCache = getenv("XDG_CACHE_HOME")) fCacheDirectory = G4String(xdgCache) + "/USphere";
+  else if(auto home = getenv("HOME")) fCacheDirectory = G4String(home) + "/.cache/USphere";
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool PhysicsTableCache::Notify(G4ApplicationState requestedState)
+{
+  if(fCacheDirectory.empty()) return true;
+
+  // Run initialization goes from Idle to Init, builds the tables if needed,
+  // and then closes the geometry.
+  G4ApplicationState currentState = G4StateManager::GetStateManager()->GetCurrentState();
+  if(currentState == G4State_Idle && requestedState == G4State_Init) Prepare();
+  else if(currentState == G4State_Idle && requestedState == G4State_GeomClosed) Finish();
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PhysicsTableCache::Prepare()
+{
+  fTimer.Start();
+  G4String description = Describe();
+
+  // FNV-1a, which unlike std::hash is the same in every build.
+  std::uint64_t hash = 14695981039346656037ull;
+  for(unsigned char c : description) {
+    hash ^= c;
+    hash *= 1099511628211ull;
+  }
+  std::ostringstream key;
+  key << std::hex << std::setw(16) << std::setfill('0') << hash;
+  if(key.str() == fKey) return;
+
+  fKey = key.str();
+  fDescription = description;
+  fKeyChanged = true;
+  std::string directory = fCacheDirectory + "/" + fKey;
+  fRetrieved = std::filesystem::is_directory(directory);
+  if(fRetrieved) fPhysicsList->SetPhysicsTableRetrieved(directory);
+  else fPhysicsList->ResetPhysicsTableRetrieved();
+}
+
+void PhysicsTableCache::Finish()
+{
+  fTimer.Stop();
+  std::string directory = fCacheDirectory + "/" + fKey;
+  if(!fKeyChanged) {
+    G4cout << "Physics tables unchanged, run initialized in " << fTimer.GetRealElapsed() << " s" << G4endl;
+    return;
+  }
+  fKeyChanged = false;
+
+  // The HP data sets are read either way; only the stored tables are saved.
+  if(fRetrieved) {
+    G4cout << "Physics tables retrieved from " << directory << " in "
+           << fTimer.GetRealElapsed() << " s (HP data read from G4NEUTRONHPDATA)" << G4endl;
+    return;
+  }
+  G4cout << "Physics tables built in " << fTimer.GetRealElapsed() << " s";
+  if(Store(directory)) G4cout << ", stored in " << directory;
+  G4cout << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4String PhysicsTableCache::Describe() const
+{
+  std::ostringstream description;
+  description << std::setprecision(17) << G4Version << '\n';
+  for(const char *variable : { "G4LEDATA", "G4PARTICLEXSDATA", "G4NEUTRONHPDATA", "G4ENSDFSTATEDATA" }) {
+    description << variable << '=' << (getenv(variable) ? : "") << '\n';
+  }
+  for(G4int i = 0; auto physics = fPhysicsList->GetPhysics(i); ++i) {
+    description << "physics " << physics->GetPhysicsName() << '\n';
+  }
+  description << "cut " << fPhysicsList->GetDefaultCutValue() << '\n';
+
+  for(auto region : *G4RegionStore::GetInstance()) {
+    description << "region " << region->GetName();
+    if(auto cuts = region->GetProductionCuts()) {
+      for(G4double cut : cuts->GetProductionCuts()) description << ' ' << cut;
+    }
+    description << '\n';
+  }
+
+  // Materials of the geometry, in volume order.
+  std::set<const G4Material *> materials;
+  for(auto volume : *G4LogicalVolumeStore::GetInstance()) {
+    const G4Material *material = volume->GetMaterial();
+    if(!material || !materials.insert(material).second) continue;
+    description << "material " << material->GetName() << ' ' << material->GetDensity() << ' '
+                << material->GetTemperature() << ' ' << material->GetPressure() << '\n';
+    const G4double *fractions = material->GetFractionVector();
+    for(size_t i = 0; i < material->GetNumberOfElements(); ++i) {
+      const G4Element *element = material->GetElement(i);
+      description << "  element " << element->GetName() << ' ' << fractions[i] << '\n';
+      const G4double *abundances = element->GetRelativeAbundanceVector();
+      for(size_t j = 0; j < element->GetNumberOfIsotopes(); ++j) {
+        const G4Isotope *isotope = element->GetIsotope(j);
+        description << "    isotope " << isotope->GetZ() << ' ' << isotope->GetN() << ' '
+                    << isotope->GetA() << ' ' << abundances[j] << '\n';
+      }
+    }
+  }
+  return description.str();
+}
+
+G4bool PhysicsTableCache::Store(const std::string &directory)
+{
+  // Write under a temporary name, then rename: another process may store
+  // the same key concurrently, and a half-written directory must never be
+  // retrieved.
+  std::error_code error;
+  std::string temporary = directory + ".tmp-" + std::to_string(getpid());
+  std::filesystem::create_directories(temporary, error);
+  if(error || !fPhysicsList->StorePhysicsTable(temporary)) {
+    G4cerr << "PhysicsTableCache: cannot store physics tables in " << temporary << G4endl;
+    std::filesystem::remove_all(temporary, error);
+    return false;
+  }
+  std::ofstream(temporary + "/key.txt") << fDescription;
+  std::filesystem::rename(temporary, directory, error);
+  if(error) std::filesystem::remove_all(temporary, error);
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
@@ -28,9 +28,13 @@
 /// \brief Implementation of the B1::PrimaryGeneratorAction class
 
 #include "PrimaryGeneratorAction.hh"
+#include "FissionSource.hh"
 
+#include "G4Event.hh"
 #include "G4ParticleGun.hh"
 #include "G4ParticleTable.hh"
+#include "G4PrimaryParticle.hh"
+#include "G4PrimaryVertex.hh"
 #include "G4SystemOfUnits.hh"
 #include "Randomize.hh"
 #include <math.h>
@@ -61,6 +65,20 @@ PrimaryGeneratorAction::~PrimaryGeneratorAction()
 void PrimaryGeneratorAction::GeneratePrimaries(G4Event *event)
 {
   // This function is called at the begining of ecah event.
+  if(FissionSource::IsActive()) {
+    // One slice of the current cycle's fission source.
+    auto [begin, end] = FissionSource::Instance()->GetEventSites(event->GetEventID());
+    for(auto site = begin; site != end; ++site) {
+      auto particle = new G4PrimaryParticle(fParticleGun->GetParticleDefinition());
+      particle->SetMomentumDirection(site->direction);
+      particle->SetKineticEnergy(site->energy);
+      auto vertex = new G4PrimaryVertex(site->position, 0.0);
+      vertex->SetPrimary(particle);
+      event->AddPrimaryVertex(vertex);
+    }
+    return;
+  }
+
   G4double z = 2.0 * G4UniformRand() - 1.0, xy = sqrt(1.0 - z*z);
   G4double p = G4UniformRand() * CLHEP::twopi;
   fParticleGun->SetParticleMomentumDirection({ xy * cos(p), xy * sin(p), z });  // Random direction.
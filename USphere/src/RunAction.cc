@@ -28,11 +28,24 @@
 /// \brief Implementation of the B1::RunAction class
 
 #include "RunAction.hh"
+#include "GrowthRateEstimator.hh"
+#include "FissionSource.hh"
+#include "TreeWriter.hh"
 #include "StackingAction.hh"
+#include "SteppingAction.hh"
+#include "FluxMesh.hh"
+#include "SubEventQueue.hh"
 #include "PrimaryGeneratorAction.hh"
 #include "DetectorConstruction.hh"
+#include "FastNeutronModel.hh"
 
 #include "G4RunManager.hh"
+#include "G4TaskRunManager.hh"
+#include "G4EventManager.hh"
+#include "G4Event.hh"
+#include "G4PrimaryParticle.hh"
+#include "G4PrimaryVertex.hh"
+#include "G4Neutron.hh"
 #include "G4Run.hh"
 #include "G4AccumulableManager.hh"
 #include "G4ParticleGun.hh"
@@ -41,7 +54,8 @@
 #include "G4Timer.hh"
 
 #include <TFile.h>
-#include <TTree.h>
+#include <TH1D.h>
+#include <TParameter.h>
 #include <stdexcept>
 #include <vector>
 #include <utility>
@@ -53,17 +67,15 @@ namespace B1
 G4Mutex RunAction::fTreeMutex;
 G4String RunAction::fFileName = "USphere";
 G4String RunAction::fTreeName = "tree";
-TFile *RunAction::fFile;
-TTree *RunAction::fTree;
-G4Timer *RunAction::fTimer;
-G4double RunAction::fTimeElapsed;
-G4double RunAction::fTimeElapsedTotal;
-G4double RunAction::fAutoSaveTimeSpan = 10.0;
+TreeWriter *RunAction::fWriter;
+G4int RunAction::fOutputRunID = -1;
+RunAction::OutputMode RunAction::fOutputMode = RunAction::OutputMode::Tree;
+G4bool RunAction::fEventSummary = false;
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-RunAction::RunAction(StackingAction *stackingAction)
-  : fStackingAction(stackingAction)
+RunAction::RunAction(StackingAction *stackingAction, SteppingAction *steppingAction)
+  : fStackingAction(stackingAction), fSteppingAction(steppingAction)
 {
   // add new units for dose
   //
@@ -77,16 +89,26 @@ RunAction::RunAction(StackingAction *stackingAction)
   new G4UnitDefinition("nanogray" , "nanoGy"  , "Dose", nanogray);
   new G4UnitDefinition("picogray" , "picoGy"  , "Dose", picogray);
 
-  //// Register accumulable to the accumulable manager
-  //G4AccumulableManager* accumulableManager = G4AccumulableManager::Instance();
-  //accumulableManager->RegisterAccumulable(fEdep);
-  //accumulableManager->RegisterAccumulable(fEdep2);
+  // Register histogram bins to the accumulable manager.
+  // Every thread registers them in the same order, which the merge relies on.
+  G4AccumulableManager* accumulableManager = G4AccumulableManager::Instance();
+  fTimeHistogram.resize(kNTimeBins);
+  fGenerationHistogram.resize(kNGenerationBins);
+  for(auto &bin : fTimeHistogram) accumulableManager->RegisterAccumulable(bin);
+  for(auto &bin : fGenerationHistogram) accumulableManager->RegisterAccumulable(bin);
+  accumulableManager->RegisterAccumulable(fEdep);
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-void RunAction::BeginOfRunAction(const G4Run*)
+RunAction::~RunAction() = default;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunAction::BeginOfRunAction(const G4Run* run)
 {
+  fRunID = run->GetRunID();
+
   // inform the runManager to save random number seed
   G4RunManager::GetRunManager()->SetRandomNumberStore(false);
 
@@ -94,19 +116,54 @@ void RunAction::BeginOfRunAction(const G4Run*)
   G4AccumulableManager* accumulableManager = G4AccumulableManager::Instance();
   accumulableManager->Reset();
 
-  if(G4Threading::IsMasterThread()) InitializeTree();
+  // Start a fresh batch on event-processing threads.
+  if(fStackingAction) OpenBatch();
+  if(fSteppingAction) fSteppingAction->BeginOfRun();
+  if(fStackingAction && SubEventQueue::Instance()->IsEnabled()) SubEventQueue::Instance()->Enter();
+
+  // Decide by role rather than by thread: with tasking, the thread that
+  // constructed the master actions may also execute worker tasks.
+  if(IsMaster()) {
+    if(FastNeutronModel::IsAvailable() && FastNeutronModel::GetEnabled()) {
+      auto detectorConstruction = (DetectorConstruction *)
+        G4RunManager::GetRunManager()->GetUserDetectorConstruction();
+      FastNeutronModel::BuildTable(detectorConstruction->GetSphere()->GetMaterial());
+    }
+    GrowthRateEstimator::Instance()->Reset();
+    FluxMesh::Instance()->Reset();
+    ResetSubEvents();
+    if(fOutputMode != OutputMode::None) {
+      G4AutoLock lock(fTreeMutex);
+      OpenOutput();
+    }
+    fRunTimer.Start();
+  }
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 void RunAction::EndOfRunAction(const G4Run* run)
 {
-  if(G4Threading::IsMasterThread()) DestroyTree();
+  // Flush the incomplete batch into the merged tallies, then help with the
+  // heavy events of other threads, which are tallied into their own batches.
+  if(fStackingAction) SubmitBatch(false);
+  if(fStackingAction && SubEventQueue::Instance()->IsEnabled()) ProcessSubEvents();
+  if(fSteppingAction) fSteppingAction->EndOfRun();
 
   // Merge accumulables
   G4AccumulableManager* accumulableManager = G4AccumulableManager::Instance();
   accumulableManager->Merge();
 
+  // Every worker has finished its event loop by now, for MT and tasking.
+  if(IsMaster() && fOutputMode != OutputMode::None) {
+    G4AutoLock lock(fTreeMutex);
+    OpenOutput();
+    fWriter->Finish();
+    if(fOutputMode == OutputMode::Histogram) WriteHistograms(run);
+    WriteFlux(run);
+    CloseOutput();
+  }
+
   // Run conditions
   //  note: There is no primary generator action object for "master"
   //        run manager for multi-threaded mode.
@@ -143,18 +200,54 @@ void RunAction::EndOfRunAction(const G4Run* run)
      << "------------------------------------------------------------"
      << G4endl
      << G4endl;
+
+  if(IsMaster()) {
+    fRunTimer.Stop();
+    G4double seconds = fRunTimer.GetRealElapsed();
+    G4cout << " Throughput: " << run->GetNumberOfEvent() << " events in " << seconds << " s";
+    if(seconds > 0.0) G4cout << " (" << run->GetNumberOfEvent() / seconds << " events/s)";
+    G4cout << G4endl;
+    GrowthRateEstimator::Instance()->Print();
+    if(StackingAction::GetNeutronOnly() && StackingAction::GetDepositEstimate() && run->GetNumberOfEvent()) {
+      G4cout << " Killed secondary energy: " << G4BestUnit(fEdep.GetValue() / run->GetNumberOfEvent(), "Energy")
+             << " per event" << G4endl;
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunAction::AddEdep(G4double edep)
+{
+  fEdep += edep;
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+void RunAction::RecordEvent(G4int eventID)
+{
+  // Sub-events only add to the tallies of their owning events.
+  G4bool subEvent = SubEventQueue::GetCurrent() != nullptr;
+  BinEvent();
+  if(fOutputMode == OutputMode::Histogram && !subEvent) FillSummary();
+  else if(fOutputMode == OutputMode::Tree && !subEvent) FillTree();
+  if(FissionSource::IsActive()) FissionSource::Instance()->Bank(eventID, fStackingAction->fFissionSites);
+  if(StackingAction::GetDepositEstimate()) AddEdep(fStackingAction->fKilledEnergy);
+
+  // Reset stacking controller.
+  fStackingAction->ResetRecords();
+}
+
 void RunAction::FillTree()
 {
   // Adapt size.
   if(fStackingAction->fGenerationMap.size() != fStackingAction->fGlobalTimeMap.size()) {
     throw std::logic_error("bad stacking records");
   }
-  fNeutronGeneration.reserve(fStackingAction->fGenerationMap.size());
-  fNeutronGlobalTime.reserve(fStackingAction->fGenerationMap.size());
+  TreeWriter::Record record;
+  record.neutronGeneration.reserve(fStackingAction->fGenerationMap.size());
+  record.neutronGlobalTime.reserve(fStackingAction->fGenerationMap.size());
+  record.neutronWeight.reserve(fStackingAction->fGenerationMap.size());
 
   // Sort data by generation and ID.
   std::vector<std::pair<G4int, G4int>> generationAndIDs;
@@ -167,66 +260,183 @@ void RunAction::FillTree()
   // Transcript data.
   for(auto [generation, ID] : generationAndIDs) {
     G4double globalTime = fStackingAction->fGlobalTimeMap.at(ID);
-    fNeutronGeneration.push_back(generation);
-    fNeutronGlobalTime.push_back(globalTime / ns);
+    record.neutronGeneration.push_back(generation);
+    record.neutronGlobalTime.push_back(globalTime / ns);
+    record.neutronWeight.push_back(fStackingAction->fWeightMap.at(ID));
   }
 
-  // Output data.
-  {
-    G4AutoLock lock(fTreeMutex);
+  // Hand the event to the I/O thread.
+  GetWriter()->Push(std::move(record));
+}
 
-    // Fill tree.
-    *(void **)fTree->GetBranch("NeutronGeneration")->GetAddress() = (void *)&fNeutronGeneration;
-    *(void **)fTree->GetBranch("NeutronGlobalTime")->GetAddress() = (void *)&fNeutronGlobalTime;
-    fTree->Fill();
+void RunAction::BinEvent()
+{
+  if(fStackingAction->fGenerationMap.size() != fStackingAction->fGlobalTimeMap.size()) {
+    throw std::logic_error("bad stacking records");
+  }
 
-    // Save tree periodically.
-    fTimer->Stop();
-    fTimeElapsed += fTimer->GetRealElapsed();
-    fTimer->Start();
-    if(fTimeElapsed > fAutoSaveTimeSpan) SaveTree();
+  // Bin data. Out-of-range entries are dropped.
+  G4bool histogramMode = fOutputMode == OutputMode::Histogram;
+  fNeutronCount = (int)fStackingAction->fGenerationMap.size();
+  fMaxGeneration = 0;
+  fMaxGlobalTime = 0.0;
+  for(auto [ID, generation] : fStackingAction->fGenerationMap) {
+    G4double globalTime = fStackingAction->fGlobalTimeMap.at(ID) / ns;
+    G4double weight = fStackingAction->fWeightMap.at(ID);
+    fMaxGeneration = std::max(fMaxGeneration, generation);
+    fMaxGlobalTime = std::max(fMaxGlobalTime, globalTime);
+    if(globalTime >= 0.0 && globalTime < kTimeMax) {
+      G4int bin = std::min((G4int)(globalTime * (kNTimeBins / kTimeMax)), kNTimeBins - 1);
+      fBatchTimeHistogram[bin] += weight;
+      if(histogramMode) fTimeHistogram[bin] += weight;
+    }
+    if(generation >= 0 && generation < kGenerationMax) {
+      G4int bin = std::min((G4int)(generation * (kNGenerationBins / kGenerationMax)), kNGenerationBins - 1);
+      fBatchGenerationHistogram[bin] += weight;
+      if(histogramMode) fGenerationHistogram[bin] += weight;
+    }
   }
 
-  // Reset stacking controller.
-  fStackingAction->ResetRecords();
+  // Hand complete batches to the growth rate estimator. Sub-events are
+  // parts of events counted by their owners, and go to the owners' batches.
+  auto estimator = GrowthRateEstimator::Instance();
+  if(auto subEvent = SubEventQueue::GetCurrent()) {
+    estimator->SubmitSubEvent(subEvent->batch, fBatchTimeHistogram, fBatchGenerationHistogram);
+    fBatchTimeHistogram.assign(kNTimeBins, 0.0);
+    fBatchGenerationHistogram.assign(kNGenerationBins, 0.0);
+    return;
+  }
+  if(++fBatchEvents >= estimator->GetBatchSize()) SubmitBatch(true);
+}
+
+void RunAction::OpenBatch()
+{
+  fBatchTimeHistogram.assign(kNTimeBins, 0.0);
+  fBatchGenerationHistogram.assign(kNGenerationBins, 0.0);
+  fBatchEvents = 0;
+  fBatch = GrowthRateEstimator::Instance()->OpenBatch();
+  fStackingAction->fBatch = fBatch;
+}
+
+void RunAction::SubmitBatch(G4bool complete)
+{
+  GrowthRateEstimator::Instance()->SubmitBatch(fBatch, fBatchTimeHistogram, fBatchGenerationHistogram,
+                                               fBatchEvents, complete);
+  OpenBatch();
+}
 
-  // Clean up.
-  fNeutronGeneration.clear();
-  fNeutronGeneration.shrink_to_fit();
-  fNeutronGlobalTime.clear();
-  fNeutronGlobalTime.shrink_to_fit();
+void RunAction::FillSummary()
+{
+  if(!fEventSummary) return;
+  TreeWriter::Record record;
+  record.neutronCount = fNeutronCount;
+  record.maxGeneration = fMaxGeneration;
+  record.maxGlobalTime = fMaxGlobalTime;
+  GetWriter()->Push(std::move(record));
+}
+
+void RunAction::WriteHistograms(const G4Run *run)
+{
+  fWriter->GetFile()->cd();
+  TH1D timeHistogram("NeutronGlobalTime", "NeutronGlobalTime;Global Time [ns];Neutron Number",
+                     kNTimeBins, 0.0, kTimeMax);
+  for(G4int i = 0; i < kNTimeBins; ++i) {
+    timeHistogram.SetBinContent(i + 1, fTimeHistogram[i].GetValue());
+  }
+  timeHistogram.Write();
+  TH1D generationHistogram("NeutronGeneration", "NeutronGeneration;Neutron Generation;Neutron Number",
+                           kNGenerationBins, 0.0, kGenerationMax);
+  for(G4int i = 0; i < kNGenerationBins; ++i) {
+    generationHistogram.SetBinContent(i + 1, fGenerationHistogram[i].GetValue());
+  }
+  generationHistogram.Write();
+  TParameter<Long64_t>("NumberOfEvents", run->GetNumberOfEvent()).Write();
 }
 
-void RunAction::InitializeTree()
+void RunAction::WriteFlux(const G4Run *run)
 {
   auto detectorConstruction = (DetectorConstruction *)
     G4RunManager::GetRunManager()->GetUserDetectorConstruction();
-  G4double radius = detectorConstruction->GetRadius() / cm;
-  fFile = new TFile((fFileName + "-" + std::to_string(radius) + ".root").c_str(), "NEW");
-  if(!fFile->IsOpen()) throw std::runtime_error("error opening output file: " + fFileName);
-  fTree = new TTree(fTreeName, fTreeName);
-  fTree->Branch("NeutronGeneration", &fNeutronGeneration);
-  fTree->Branch("NeutronGlobalTime", &fNeutronGlobalTime);
-  fTimer = new G4Timer;
-  fTimer->Start();
+  fWriter->GetFile()->cd();
+  FluxMesh::Instance()->Write(detectorConstruction->GetRadius(), run->GetNumberOfEvent());
+}
+
+void RunAction::ResetSubEvents()
+{
+  // Sub-events need idle worker threads during the event loop, and output
+  // without per-event records.
+  G4bool enabled = SubEventQueue::GetThreshold() > 0;
+  auto runManager = G4RunManager::GetRunManager();
+  if(enabled && (runManager->GetRunManagerType() != G4RunManager::masterRM ||
+                 dynamic_cast<G4TaskRunManager *>(runManager))) {
+    G4cout << "Sub-events are only supported by the MT run manager." << G4endl;
+    enabled = false;
+  }
+  if(enabled && (!StackingAction::IsCensus() || fOutputMode == OutputMode::Tree || FissionSource::IsActive())) {
+    G4cout << "Sub-events need census mode, and neither tree output nor k-eigenvalue cycles." << G4endl;
+    enabled = false;
+  }
+  SubEventQueue::Instance()->Reset(enabled);
+}
+
+void RunAction::ProcessSubEvents()
+{
+  // This thread is done with its events: transport sub-events of others
+  // until none can come any more. The run is still open, and the geometry
+  // closed, so the event manager can be driven directly.
+  auto queue = SubEventQueue::Instance();
+  queue->Leave();
+  SubEvent subEvent;
+  while(queue->Take(subEvent)) {
+    auto event = new G4Event(subEvent.eventID);
+    for(const auto &neutron : subEvent.neutrons) {
+      auto particle = new G4PrimaryParticle(G4Neutron::Neutron());
+      particle->SetMomentumDirection(neutron.direction);
+      particle->SetKineticEnergy(neutron.energy);
+      particle->SetWeight(neutron.weight);
+      auto vertex = new G4PrimaryVertex(neutron.position, neutron.time);
+      vertex->SetPrimary(particle);
+      event->AddPrimaryVertex(vertex);
+    }
+    SubEventQueue::SetCurrent(&subEvent);
+    G4EventManager::GetEventManager()->ProcessOneEvent(event);
+    SubEventQueue::SetCurrent(nullptr);
+    delete event;
+    queue->Leave();
+  }
 }
 
-void RunAction::SaveTree()
+TreeWriter *RunAction::GetWriter()
 {
-  fTimeElapsedTotal += fTimeElapsed;
-  fTimeElapsed = 0.0;
-  G4cout << "AutoSave: saving " << fTree->GetEntries() << " events ("
-         << fTimeElapsedTotal << " secs elapsed)" << G4endl;
-  fTree->AutoSave("SaveSelf, Overwrite");
+  // The writer stays valid until the master closes it after the event loop.
+  G4AutoLock lock(fTreeMutex);
+  OpenOutput();
+  return fWriter;
+}
+
+void RunAction::OpenOutput()
+{
+  // Called with fTreeMutex held; a no-op once this run's output is open.
+  if(fOutputRunID == fRunID) return;
+  if(fWriter) CloseOutput();
+
+  auto detectorConstruction = (DetectorConstruction *)
+    G4RunManager::GetRunManager()->GetUserDetectorConstruction();
+  G4double radius = detectorConstruction->GetRadius() / cm;
+  auto layout = TreeWriter::Layout::Neutrons;
+  if(fOutputMode == OutputMode::Histogram) {
+    layout = fEventSummary ? TreeWriter::Layout::Summary : TreeWriter::Layout::None;
+  }
+  fWriter = new TreeWriter(fFileName + "-" + std::to_string(radius) + ".root", fTreeName,
+                           layout, StackingAction::IsWeighted());
+  fOutputRunID = fRunID;
 }
 
-void RunAction::DestroyTree()
+void RunAction::CloseOutput()
 {
-  delete fTimer;
-  fFile->cd();
-  fTree->Write(fTreeName, fTree->kOverwrite);
-  delete fTree;
-  delete fFile;
+  delete fWriter;
+  fWriter = nullptr;
+  fOutputRunID = -1;
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
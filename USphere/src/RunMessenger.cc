@@ -0,0 +1,285 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/src/RunMessenger.cc
+/// \brief Implementation of the B1::RunMessenger class
+
+#include "RunMessenger.hh"
+#include "RunAction.hh"
+#include "TreeWriter.hh"
+#include "GrowthRateEstimator.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithADouble.hh"
+#include "G4UIcmdWithAnInteger.hh"
+#include "G4UIparameter.hh"
+#include "G4UnitsTable.hh"
+
+#include <sstream>
+
+namespace B1
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+RunMessenger::RunMessenger()
+{
+  fOutDirectory = new G4UIdirectory("/out/");
+  fOutDirectory->SetGuidance("Output control");
+
+  auto setMode = new G4UIcmdWithAString("/out/mode", this);
+  setMode->SetGuidance("Select output mode.");
+  setMode->SetGuidance("  tree      : store every neutron of every event.");
+  setMode->SetGuidance("  histogram : store merged time and generation histograms only.");
+  setMode->SetGuidance("  none      : write no file, only estimate growth rates.");
+  setMode->SetParameterName("mode", false);
+  setMode->SetCandidates("tree histogram none");
+  setMode->AvailableForStates(G4State_PreInit, G4State_Idle);
+  setMode->SetToBeBroadcasted(false);
+  fSetMode = setMode;
+
+  auto setEventSummary = new G4UIcmdWithABool("/out/eventSummary", this);
+  setEventSummary->SetGuidance("Store per-event population summaries in histogram mode.");
+  setEventSummary->SetParameterName("enable", true);
+  setEventSummary->SetDefaultValue(true);
+  setEventSummary->AvailableForStates(G4State_PreInit, G4State_Idle);
+  setEventSummary->SetToBeBroadcasted(false);
+  fSetEventSummary = setEventSummary;
+
+  auto setCompression = new G4UIcmdWithAnInteger("/out/compression", this);
+  setCompression->SetGuidance("ROOT compression setting, algorithm * 100 + level (-1: ROOT default).");
+  setCompression->SetGuidance("  e.g. 505 for ZSTD level 5, 207 for LZMA level 7.");
+  setCompression->SetParameterName("setting", false);
+  setCompression->SetRange("setting >= -1");
+  setCompression->AvailableForStates(G4State_PreInit, G4State_Idle);
+  setCompression->SetToBeBroadcasted(false);
+  fSetCompression = setCompression;
+
+  auto setBasketSize = new G4UIcmdWithAnInteger("/out/basketSize", this);
+  setBasketSize->SetGuidance("Basket size of all branches in bytes (0: ROOT default).");
+  setBasketSize->SetParameterName("bytes", false);
+  setBasketSize->SetRange("bytes >= 0");
+  setBasketSize->AvailableForStates(G4State_PreInit, G4State_Idle);
+  setBasketSize->SetToBeBroadcasted(false);
+  fSetBasketSize = setBasketSize;
+
+  auto setAutoFlush = new G4UIcmdWithAnInteger("/out/autoFlush", this);
+  setAutoFlush->SetGuidance("Cluster size: entries if positive, bytes if negative (0: ROOT default).");
+  setAutoFlush->SetParameterName("value", false);
+  setAutoFlush->AvailableForStates(G4State_PreInit, G4State_Idle);
+  setAutoFlush->SetToBeBroadcasted(false);
+  fSetAutoFlush = setAutoFlush;
+
+  auto setAutoSave = new G4UIcmdWithAnInteger("/out/autoSave", this);
+  setAutoSave->SetGuidance("Checkpoint the tree every this many compressed MB (0: never).");
+  setAutoSave->SetParameterName("MB", false);
+  setAutoSave->SetRange("MB >= 0");
+  setAutoSave->AvailableForStates(G4State_PreInit, G4State_Idle);
+  setAutoSave->SetToBeBroadcasted(false);
+  fSetAutoSave = setAutoSave;
+
+  auto setQueueSize = new G4UIcmdWithAnInteger("/out/queueSize", this);
+  setQueueSize->SetGuidance("Size in MB of queued events above which workers wait for the I/O thread.");
+  setQueueSize->SetParameterName("MB", false);
+  setQueueSize->SetRange("MB > 0");
+  setQueueSize->AvailableForStates(G4State_PreInit, G4State_Idle);
+  setQueueSize->SetToBeBroadcasted(false);
+  fSetQueueSize = setQueueSize;
+
+  auto setFloatTimes = new G4UIcmdWithABool("/out/floatTimes", this);
+  setFloatTimes->SetGuidance("Store neutron global times as 32-bit floats.");
+  setFloatTimes->SetParameterName("enable", true);
+  setFloatTimes->SetDefaultValue(true);
+  setFloatTimes->AvailableForStates(G4State_PreInit, G4State_Idle);
+  setFloatTimes->SetToBeBroadcasted(false);
+  fSetFloatTimes = setFloatTimes;
+
+  auto setShortGenerations = new G4UIcmdWithABool("/out/shortGenerations", this);
+  setShortGenerations->SetGuidance("Store neutron generations as 16-bit integers.");
+  setShortGenerations->SetGuidance("Generations above 32767 are saturated and counted.");
+  setShortGenerations->SetParameterName("enable", true);
+  setShortGenerations->SetDefaultValue(true);
+  setShortGenerations->AvailableForStates(G4State_PreInit, G4State_Idle);
+  setShortGenerations->SetToBeBroadcasted(false);
+  fSetShortGenerations = setShortGenerations;
+
+  auto setTargetError = new G4UIcmdWithADouble("/run/targetError", this);
+  setTargetError->SetGuidance("Stop the run once the batch-means standard errors of both growth");
+  setTargetError->SetGuidance("rates k (per ns and per generation) are below this value (0: never");
+  setTargetError->SetGuidance("stop early). It is also about the relative error of exp(k).");
+  setTargetError->SetParameterName("error", false);
+  setTargetError->SetRange("error >= 0");
+  setTargetError->AvailableForStates(G4State_PreInit, G4State_Idle);
+  setTargetError->SetToBeBroadcasted(false);
+  fSetTargetError = setTargetError;
+
+  auto setBatchSize = new G4UIcmdWithAnInteger("/run/batchSize", this);
+  setBatchSize->SetGuidance("Number of events per batch for batch-means error estimates.");
+  setBatchSize->SetParameterName("events", false);
+  setBatchSize->SetRange("events > 0");
+  setBatchSize->AvailableForStates(G4State_PreInit, G4State_Idle);
+  setBatchSize->SetToBeBroadcasted(false);
+  fSetBatchSize = setBatchSize;
+
+  auto setMinBatches = new G4UIcmdWithAnInteger("/run/minBatches", this);
+  setMinBatches->SetGuidance("Minimum number of batches before the run may stop early.");
+  setMinBatches->SetParameterName("batches", false);
+  setMinBatches->SetRange("batches > 1");
+  setMinBatches->AvailableForStates(G4State_PreInit, G4State_Idle);
+  setMinBatches->SetToBeBroadcasted(false);
+  fSetMinBatches = setMinBatches;
+
+  auto setTimeFitWindow = new G4UIcommand("/run/timeFitWindow", this);
+  setTimeFitWindow->SetGuidance("Global time window of the exponential fit.");
+  setTimeFitWindow->SetParameter(new G4UIparameter("lo", 'd', false));
+  setTimeFitWindow->SetParameter(new G4UIparameter("hi", 'd', false));
+  auto timeUnit = new G4UIparameter("unit", 's', true);
+  timeUnit->SetDefaultValue("ns");
+  setTimeFitWindow->SetParameter(timeUnit);
+  setTimeFitWindow->AvailableForStates(G4State_PreInit, G4State_Idle);
+  setTimeFitWindow->SetToBeBroadcasted(false);
+  fSetTimeFitWindow = setTimeFitWindow;
+
+  auto setGenerationFitWindow = new G4UIcommand("/run/generationFitWindow", this);
+  setGenerationFitWindow->SetGuidance("Generation window of the exponential fit.");
+  setGenerationFitWindow->SetParameter(new G4UIparameter("lo", 'd', false));
+  setGenerationFitWindow->SetParameter(new G4UIparameter("hi", 'd', false));
+  setGenerationFitWindow->AvailableForStates(G4State_PreInit, G4State_Idle);
+  setGenerationFitWindow->SetToBeBroadcasted(false);
+  fSetGenerationFitWindow = setGenerationFitWindow;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+RunMessenger::~RunMessenger()
+{
+  delete fSetGenerationFitWindow;
+  delete fSetTimeFitWindow;
+  delete fSetMinBatches;
+  delete fSetBatchSize;
+  delete fSetTargetError;
+  delete fSetShortGenerations;
+  delete fSetFloatTimes;
+  delete fSetQueueSize;
+  delete fSetAutoSave;
+  delete fSetAutoFlush;
+  delete fSetBasketSize;
+  delete fSetCompression;
+  delete fSetEventSummary;
+  delete fSetMode;
+  delete fOutDirectory;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunMessenger::SetNewValue(G4UIcommand *command, G4String newValue)
+{
+  if(command == fSetMode) {
+    if(newValue == "histogram") RunAction::SetOutputMode(RunAction::OutputMode::Histogram);
+    else if(newValue == "none") RunAction::SetOutputMode(RunAction::OutputMode::None);
+    else RunAction::SetOutputMode(RunAction::OutputMode::Tree);
+    return;
+  }
+
+  if(command == fSetEventSummary) {
+    RunAction::SetEventSummary(fSetEventSummary->GetNewBoolValue(newValue));
+    return;
+  }
+
+  if(command == fSetCompression) {
+    TreeWriter::SetCompression(fSetCompression->GetNewIntValue(newValue));
+    return;
+  }
+
+  if(command == fSetBasketSize) {
+    TreeWriter::SetBasketSize(fSetBasketSize->GetNewIntValue(newValue));
+    return;
+  }
+
+  if(command == fSetAutoFlush) {
+    TreeWriter::SetAutoFlush(fSetAutoFlush->GetNewIntValue(newValue));
+    return;
+  }
+
+  if(command == fSetAutoSave) {
+    TreeWriter::SetAutoSaveBytes(fSetAutoSave->GetNewIntValue(newValue) * 1000000L);
+    return;
+  }
+
+  if(command == fSetQueueSize) {
+    TreeWriter::SetQueueBytes(fSetQueueSize->GetNewIntValue(newValue) * 1000000L);
+    return;
+  }
+
+  if(command == fSetFloatTimes) {
+    TreeWriter::SetFloatTimes(fSetFloatTimes->GetNewBoolValue(newValue));
+    return;
+  }
+
+  if(command == fSetShortGenerations) {
+    TreeWriter::SetShortGenerations(fSetShortGenerations->GetNewBoolValue(newValue));
+    return;
+  }
+
+  auto estimator = GrowthRateEstimator::Instance();
+
+  if(command == fSetTargetError) {
+    estimator->SetTargetError(fSetTargetError->GetNewDoubleValue(newValue));
+    return;
+  }
+
+  if(command == fSetBatchSize) {
+    estimator->SetBatchSize(fSetBatchSize->GetNewIntValue(newValue));
+    return;
+  }
+
+  if(command == fSetMinBatches) {
+    estimator->SetMinBatches(fSetMinBatches->GetNewIntValue(newValue));
+    return;
+  }
+
+  if(command == fSetTimeFitWindow) {
+    G4double lo, hi;
+    G4String unit;
+    std::istringstream(newValue) >> lo >> hi >> unit;
+    G4double scale = G4UIcommand::ValueOf(unit) / ns;
+    estimator->SetTimeWindow(lo * scale, hi * scale);
+    return;
+  }
+
+  if(command == fSetGenerationFitWindow) {
+    G4double lo, hi;
+    std::istringstream(newValue) >> lo >> hi;
+    estimator->SetGenerationWindow(lo, hi);
+    return;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
@@ -0,0 +1,210 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/src/ScanDriver.cc
+/// \brief Implementation of the B1::ScanDriver class
+
+#include "ScanDriver.hh"
+#include "ScanMessenger.hh"
+#include "DetectorConstruction.hh"
+#include "GrowthRateEstimator.hh"
+#include "RunAction.hh"
+
+#include "G4RunManager.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <cmath>
+#include <stdexcept>
+
+namespace B1
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ScanDriver::ScanDriver(DetectorConstruction *detectorConstruction)
+  : fDetectorConstruction(detectorConstruction)
+{
+  fMessenger = new ScanMessenger(this);
+}
+
+ScanDriver::~ScanDriver()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ScanDriver::SetFileName(const G4String &fileName)
+{
+  // A table already written is closed; the next point opens the new file.
+  if(fFile.is_open() && fileName != fFileName) fFile.close();
+  fFileName = fileName;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ScanDriver::ScanRadii(const std::vector<G4double> &radii)
+{
+  G4double slope, error;
+  for(G4double radius : radii) {
+    fDetectorConstruction->SetRadius(radius);
+    RunPoint(slope, error);
+  }
+}
+
+void ScanDriver::ScanEnrichments(const std::vector<G4double> &enrichments)
+{
+  G4double slope, error;
+  for(G4double enrichment : enrichments) {
+    fDetectorConstruction->SetU235Enrichment(enrichment);
+    RunPoint(slope, error);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ScanDriver::FindCriticalRadius(G4double lo, G4double hi, G4double tolerance)
+{
+  // The chain is critical where the per-generation slope crosses zero.
+  std::vector<Point> points(2);
+  if(!MeasurePoint(lo, points[0]) || !MeasurePoint(hi, points[1])) return;
+  if(points[0].slope * points[1].slope > 0.0) {
+    G4cout << "ScanDriver: growth rate does not change sign in ["
+           << lo / cm << ", " << hi / cm << "] cm" << G4endl;
+    return;
+  }
+  G4double signLo = points[0].slope;
+
+  for(G4int iteration = 0; iteration < fMaxIterations && hi - lo > tolerance; ++iteration) {
+    Point point;
+    if(!MeasurePoint(0.5 * (lo + hi), point)) return;
+    points.push_back(point);
+    // Without a significant sign the bracket cannot be narrowed any further.
+    if(std::abs(point.slope) <= fSignificance * point.error) {
+      G4cout << "ScanDriver: growth rate at " << point.radius / cm << " cm is "
+             << point.slope << " (" << point.error << "), within "
+             << fSignificance << " sigma of zero; stopping the bisection" << G4endl;
+      break;
+    }
+    if(point.slope * signLo > 0.0) lo = point.radius;
+    else hi = point.radius;
+  }
+
+  // Weighted straight-line fit k = a + b * r over the points of the final
+  // bracket, including a last point that could not be signed.
+  G4double s = 0.0, sr = 0.0, srr = 0.0, sk = 0.0, srk = 0.0;
+  for(const auto &point : points) {
+    if(point.radius < lo || point.radius > hi) continue;
+    G4double weight = point.error > 0.0 ? 1.0 / (point.error * point.error) : 1.0;
+    s += weight;
+    sr += weight * point.radius;
+    srr += weight * point.radius * point.radius;
+    sk += weight * point.slope;
+    srk += weight * point.radius * point.slope;
+  }
+  G4double determinant = s * srr - sr * sr;
+  G4double critical = 0.5 * (lo + hi), criticalError = 0.5 * (hi - lo);
+  if(determinant > 0.0) {
+    G4double a = (srr * sk - sr * srk) / determinant;
+    G4double b = (s * srk - sr * sk) / determinant;
+    if(b != 0.0) {
+      // Propagate the covariance of (a, b) to r = -a / b.
+      G4double va = srr / determinant, vb = s / determinant, vab = -sr / determinant;
+      critical = -a / b;
+      criticalError = std::sqrt(va + critical * critical * vb + 2.0 * critical * vab) / std::abs(b);
+    }
+  }
+  G4cout << "ScanDriver: critical radius " << critical / cm << " (" << criticalError / cm
+         << ") cm (bracket [" << lo / cm << ", " << hi / cm << "] cm) at U235 enrichment "
+         << fDetectorConstruction->GetU235Enrichment() << G4endl;
+  if(fFile.is_open()) {
+    fFile << "# critical radius " << critical / cm << " +- " << criticalError / cm
+          << " cm, bracket [" << lo / cm << ", " << hi / cm << "] cm" << std::endl;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool ScanDriver::MeasurePoint(G4double radius, Point &point)
+{
+  // Repeat the point until the sign of its growth rate is significant,
+  // combining the runs by their inverse variances.
+  fDetectorConstruction->SetRadius(radius);
+  point.radius = radius;
+  G4double slope, error, weight = 0.0, weightedSlope = 0.0;
+  for(G4int run = 0; run <= fMaxRepeats; ++run) {
+    if(!RunPoint(slope, error)) return false;
+    if(error <= 0.0) {
+      point.slope = slope;
+      point.error = 0.0;
+      return true;
+    }
+    weight += 1.0 / (error * error);
+    weightedSlope += slope / (error * error);
+    point.slope = weightedSlope / weight;
+    point.error = 1.0 / std::sqrt(weight);
+    if(std::abs(point.slope) > fSignificance * point.error) break;
+  }
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool ScanDriver::RunPoint(G4double &slope, G4double &error)
+{
+  if(!fFile.is_open()) {
+    fFile.open(fFileName);
+    if(!fFile) throw std::runtime_error("error opening scan output file: " + fFileName);
+    fFile << "# radius[cm] enrichment events k_time[1/ns] err_k_time k_generation err_k_generation" << std::endl;
+  }
+
+  // Only the growth rate is needed, so per-run files are suppressed.
+  auto outputMode = RunAction::GetOutputMode();
+  RunAction::SetOutputMode(RunAction::OutputMode::None);
+  G4RunManager::GetRunManager()->BeamOn(fNumberOfEvents);
+  RunAction::SetOutputMode(outputMode);
+
+  auto estimator = GrowthRateEstimator::Instance();
+  auto timeEstimate = estimator->GetTimeEstimate();
+  auto generationEstimate = estimator->GetGenerationEstimate();
+  fFile << fDetectorConstruction->GetRadius() / cm << " "
+        << fDetectorConstruction->GetU235Enrichment() << " "
+        << estimator->GetNumberOfEvents() << " "
+        << timeEstimate.slope << " " << timeEstimate.error << " "
+        << generationEstimate.slope << " " << generationEstimate.error << std::endl;
+
+  slope = generationEstimate.slope;
+  error = generationEstimate.error;
+  if(!generationEstimate.valid) {
+    G4cout << "ScanDriver: no valid generation fit at radius "
+           << fDetectorConstruction->GetRadius() / cm << " cm" << G4endl;
+  }
+  return generationEstimate.valid;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
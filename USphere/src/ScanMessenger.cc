@@ -0,0 +1,176 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/src/ScanMessenger.cc
+/// \brief Implementation of the B1::ScanMessenger class
+
+#include "ScanMessenger.hh"
+#include "ScanDriver.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcommand.hh"
+#include "G4UIparameter.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithAnInteger.hh"
+#include "G4UIcmdWithADouble.hh"
+
+#include <sstream>
+#include <vector>
+
+namespace B1
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ScanMessenger::ScanMessenger(ScanDriver *scanDriver)
+ : fScanDriver(scanDriver)
+{
+  fScanDirectory = new G4UIdirectory("/scan/");
+  fScanDirectory->SetGuidance("Geometry scans in one initialized process");
+
+  auto setEvents = new G4UIcmdWithAnInteger("/scan/events", this);
+  setEvents->SetGuidance("Number of events per scan point (an upper bound with /run/targetError).");
+  setEvents->SetParameterName("events", false);
+  setEvents->SetRange("events > 0");
+  setEvents->AvailableForStates(G4State_PreInit, G4State_Idle);
+  setEvents->SetToBeBroadcasted(false);
+  fSetEvents = setEvents;
+
+  auto setOutput = new G4UIcmdWithAString("/scan/output", this);
+  setOutput->SetGuidance("Summary table file name; later points go to the new file.");
+  setOutput->SetParameterName("fileName", false);
+  setOutput->AvailableForStates(G4State_PreInit, G4State_Idle);
+  setOutput->SetToBeBroadcasted(false);
+  fSetOutput = setOutput;
+
+  auto scanRadii = new G4UIcmdWithAString("/scan/radii", this);
+  scanRadii->SetGuidance("Run one point per Sphere radius, e.g. \"8.5 8.7407 9.0 cm\".");
+  scanRadii->SetParameterName("radii", false);
+  scanRadii->AvailableForStates(G4State_Idle);
+  scanRadii->SetToBeBroadcasted(false);
+  fScanRadii = scanRadii;
+
+  auto scanEnrichments = new G4UIcmdWithAString("/scan/enrichments", this);
+  scanEnrichments->SetGuidance("Run one point per U235 enrichment, e.g. \"90 93.71\".");
+  scanEnrichments->SetParameterName("enrichments", false);
+  scanEnrichments->AvailableForStates(G4State_Idle);
+  scanEnrichments->SetToBeBroadcasted(false);
+  fScanEnrichments = scanEnrichments;
+
+  auto findCriticalRadius = new G4UIcommand("/scan/criticalRadius", this);
+  findCriticalRadius->SetGuidance("Bisect the Sphere radius in [lo, hi] until the bracket of");
+  findCriticalRadius->SetGuidance("the zero of the per-generation growth rate is below tolerance.");
+  findCriticalRadius->SetParameter(new G4UIparameter("lo", 'd', false));
+  findCriticalRadius->SetParameter(new G4UIparameter("hi", 'd', false));
+  findCriticalRadius->SetParameter(new G4UIparameter("tolerance", 'd', false));
+  auto unit = new G4UIparameter("unit", 's', true);
+  unit->SetDefaultValue("cm");
+  findCriticalRadius->SetParameter(unit);
+  findCriticalRadius->AvailableForStates(G4State_Idle);
+  findCriticalRadius->SetToBeBroadcasted(false);
+  fFindCriticalRadius = findCriticalRadius;
+
+  auto setSignificance = new G4UIcmdWithADouble("/scan/significance", this);
+  setSignificance->SetGuidance("Sigmas a growth rate must be away from zero for the bisection");
+  setSignificance->SetGuidance("to use its sign; otherwise the point is rerun to add statistics.");
+  setSignificance->SetParameterName("sigmas", false);
+  setSignificance->SetRange("sigmas > 0");
+  setSignificance->AvailableForStates(G4State_PreInit, G4State_Idle);
+  setSignificance->SetToBeBroadcasted(false);
+  fSetSignificance = setSignificance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ScanMessenger::~ScanMessenger()
+{
+  delete fSetSignificance;
+  delete fFindCriticalRadius;
+  delete fScanEnrichments;
+  delete fScanRadii;
+  delete fSetOutput;
+  delete fSetEvents;
+  delete fScanDirectory;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ScanMessenger::SetNewValue(G4UIcommand *command, G4String newValue)
+{
+  if(command == fSetEvents) {
+    fScanDriver->SetNumberOfEvents(fSetEvents->GetNewIntValue(newValue));
+    return;
+  }
+
+  if(command == fSetSignificance) {
+    fScanDriver->SetSignificance(fSetSignificance->GetNewDoubleValue(newValue));
+    return;
+  }
+
+  if(command == fSetOutput) {
+    fScanDriver->SetFileName(newValue);
+    return;
+  }
+
+  if(command == fScanRadii) {
+    // Values followed by a unit.
+    std::vector<G4String> tokens;
+    std::istringstream stream(newValue);
+    for(G4String token; stream >> token; ) tokens.push_back(token);
+    if(tokens.size() < 2) {
+      G4cerr << "/scan/radii: expected values followed by a unit" << G4endl;
+      return;
+    }
+    G4double unit = G4UIcommand::ValueOf(tokens.back());
+    std::vector<G4double> radii;
+    for(size_t i = 0; i + 1 < tokens.size(); ++i) {
+      radii.push_back(G4UIcommand::ConvertToDouble(tokens[i]) * unit);
+    }
+    fScanDriver->ScanRadii(radii);
+    return;
+  }
+
+  if(command == fScanEnrichments) {
+    std::vector<G4double> enrichments;
+    std::istringstream stream(newValue);
+    for(G4double enrichment; stream >> enrichment; ) enrichments.push_back(enrichment);
+    fScanDriver->ScanEnrichments(enrichments);
+    return;
+  }
+
+  if(command == fFindCriticalRadius) {
+    G4double lo, hi, tolerance;
+    G4String unit;
+    std::istringstream(newValue) >> lo >> hi >> tolerance >> unit;
+    G4double scale = G4UIcommand::ValueOf(unit);
+    fScanDriver->FindCriticalRadius(lo * scale, hi * scale, tolerance * scale);
+    return;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
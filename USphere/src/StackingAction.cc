@@ -28,35 +28,134 @@
 /// \brief Implementation of the B1::StackingAction class
 
 #include "StackingAction.hh"
+#include "FastNeutronModel.hh"
 
 #include "G4Track.hh"
 #include "G4Neutron.hh"
+#include "G4StackManager.hh"
+#include "G4EventManager.hh"
+#include "G4Event.hh"
+#include "G4VProcess.hh"
+#include "Randomize.hh"
 
 namespace B1
 {
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+G4bool StackingAction::fCensus = false;
+G4int StackingAction::fTargetPopulation = 0;
+G4bool StackingAction::fSplitting = false;
+G4int StackingAction::fWatermark = 0;
+G4bool StackingAction::fNeutronOnly = false;
+G4bool StackingAction::fNeutronOnlyRequired = false;
+G4bool StackingAction::fDepositEstimate = false;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
 G4ClassificationOfNewTrack
 StackingAction::ClassifyNewTrack(const G4Track* track)
 {
-  // Select neutrons only.
-  if(track->GetDefinition() != G4Neutron::Neutron()) return fUrgent;
+  // Select neutrons only; in neutron-only mode, other secondaries die here.
+  if(track->GetDefinition() != G4Neutron::Neutron()) {
+    if(!fNeutronOnly || track->GetParentID() == 0) return fUrgent;
+    if(fDepositEstimate) fKilledEnergy += track->GetKineticEnergy() * track->GetWeight();
+    return fKill;
+  }
+
+  // Split copies have been classified together with their original.
+  if(fPushingCopies) return fUrgent;
 
-  // Record time and generation first.
+  // Sub-event primaries have been recorded by their owning event.
+  if(fSubEvent && track->GetParentID() == 0) return fUrgent;
+
+  // Fission neutrons start the next cycle of a k-eigenvalue calculation.
+  if(FissionSource::IsActive()) {
+    auto process = track->GetCreatorProcess();
+    if((process && process->GetProcessName() == "nFission") || FastNeutronModel::IsFissionNeutron(track)) {
+      BankFissionSite(track);
+      return fKill;
+    }
+  }
+
+  // Record time, generation and weight first.
   G4double globalTime = GetAndRecordGlobalTime(track);
   G4int generation = GetAndRecordGeneration(track);
+  RecordWeight(track);
 
   // Either time or generation exceeding triggers a kill.
   if(fMaxGlobalTime && globalTime > fMaxGlobalTime) return fKill;
   if(fMaxGeneration && generation > fMaxGeneration) return fKill;
+
+  // Later generations wait for the census of their stage.
+  if(fCensus && generation > fCensusGeneration) return fWaiting;
+
+  // Census of a new stage: roulette or split the whole generation.
+  if(fReclassifying) {
+    if(fOffloading) {
+      Offload(track);
+      return fKill;
+    }
+    if(fSplit > 1) {
+      Split(track, fSplit);
+      return fUrgent;
+    }
+    return Roulette(track, fSurvival);
+  }
+
+  // Bound the stack size whatever the multiplication factor.
+  if(fWatermark && stackManager->GetNTotalTrack() >= fWatermark) return Roulette(track, 0.5);
   return fUrgent;
 }
 
+void StackingAction::NewStage()
+{
+  // The waiting generation has just been moved to the urgent stack.
+  if(!fCensus) return;
+  G4int population = stackManager->GetNUrgentTrack();
+  ++fCensusGeneration;
+  fSurvival = 1.0;
+  fSplit = 1;
+  if(fTargetPopulation && population > fTargetPopulation) {
+    fSurvival = (G4double)fTargetPopulation / population;
+  }
+  else if(fTargetPopulation && fSplitting && 2 * population <= fTargetPopulation) {
+    fSplit = fTargetPopulation / population;
+  }
+
+  // A heavy generation goes to idle threads instead.
+  auto subEventQueue = SubEventQueue::Instance();
+  fOffloading = subEventQueue->IsEnabled() && population >= SubEventQueue::GetThreshold();
+  if(fSurvival == 1.0 && fSplit == 1 && !fOffloading) return;
+  fReclassifying = true;
+  stackManager->ReClassify();
+  fReclassifying = false;
+  if(fOffloading) {
+    // Offloaded generations count in the batch of the owning event.
+    G4int eventID = G4EventManager::GetEventManager()->GetConstCurrentEvent()->GetEventID();
+    G4long batch = fSubEvent ? fSubEvent->batch : fBatch;
+    subEventQueue->Submit(eventID, fCensusGeneration, batch, std::move(fOffloaded));
+    fOffloaded.clear();
+    fOffloading = false;
+  }
+}
+
+void StackingAction::PrepareNewEvent()
+{
+  // A sub-event resumes the census of its owner.
+  fSubEvent = SubEventQueue::GetCurrent();
+  fCensusGeneration = fSubEvent ? fSubEvent->generation : 1;
+  fSurvival = 1.0;
+  fSplit = 1;
+}
+
 void StackingAction::ResetRecords()
 {
   fGenerationMap.clear();
   fGlobalTimeMap.clear();
+  fWeightMap.clear();
+  fFissionSites.clear();
+  fKilledEnergy = 0.0;
 }
 
 G4int StackingAction::GetAndRecordGeneration(const G4Track *track)
@@ -72,6 +171,7 @@ G4int StackingAction::GetAndRecordGeneration(const G4Track *track)
   G4int generation = 1;
   it = fGenerationMap.find(parentID);
   if(it != fGenerationMap.end()) generation += it->second;
+  else if(fSubEvent && parentID <= (G4int)fSubEvent->neutrons.size()) generation += fSubEvent->generation;
   fGenerationMap.emplace(ID, generation);
   return generation;
 }
@@ -81,6 +181,60 @@ G4double StackingAction::GetAndRecordGlobalTime(const G4Track *track)
   return fGlobalTimeMap[track->GetTrackID()] = track->GetGlobalTime();
 }
 
+void StackingAction::RecordWeight(const G4Track *track)
+{
+  // Keep the birth weight; later roulette or splitting must not change it.
+  fWeightMap.emplace(track->GetTrackID(), track->GetWeight());
+}
+
+void StackingAction::BankFissionSite(const G4Track *track)
+{
+  FissionSite site;
+  site.position = track->GetPosition();
+  site.direction = track->GetMomentumDirection();
+  site.energy = track->GetKineticEnergy();
+  site.weight = track->GetWeight();
+  fFissionSites.push_back(site);
+}
+
+G4ClassificationOfNewTrack StackingAction::Roulette(const G4Track *track, G4double survival)
+{
+  if(survival >= 1.0) return fUrgent;
+  if(G4UniformRand() >= survival) return fKill;
+  auto survivor = const_cast<G4Track *>(track);
+  survivor->SetWeight(track->GetWeight() / survival);
+  return fUrgent;
+}
+
+void StackingAction::Split(const G4Track *track, G4int split)
+{
+  // Copies share the track ID, so they are neither recorded twice nor do
+  // they break the generation lineage of their secondaries.
+  auto original = const_cast<G4Track *>(track);
+  original->SetWeight(track->GetWeight() / split);
+  fPushingCopies = true;
+  for(G4int i = 1; i < split; ++i) {
+    auto copy = new G4Track(*track);
+    copy->SetTrackID(track->GetTrackID());
+    copy->SetParentID(track->GetParentID());
+    stackManager->PushOneTrack(copy);
+  }
+  fPushingCopies = false;
+}
+
+void StackingAction::Offload(const G4Track *track)
+{
+  // Population control of the census still applies.
+  if(fSurvival < 1.0 && G4UniformRand() >= fSurvival) return;
+  SubEventNeutron neutron;
+  neutron.position = track->GetPosition();
+  neutron.direction = track->GetMomentumDirection();
+  neutron.energy = track->GetKineticEnergy();
+  neutron.time = track->GetGlobalTime();
+  neutron.weight = track->GetWeight() / fSurvival / fSplit;
+  fOffloaded.insert(fOffloaded.end(), fSplit, neutron);
+}
+
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 }
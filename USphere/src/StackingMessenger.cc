@@ -0,0 +1,170 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/src/StackingMessenger.cc
+/// \brief Implementation of the B1::StackingMessenger class
+
+#include "StackingMessenger.hh"
+#include "StackingAction.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithAnInteger.hh"
+
+namespace B1
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+StackingMessenger::StackingMessenger()
+{
+  fStackDirectory = new G4UIdirectory("/stack/");
+  fStackDirectory->SetGuidance("Neutron population control");
+
+  auto setCensus = new G4UIcmdWithABool("/stack/census", this);
+  setCensus->SetGuidance("Transport one neutron generation at a time.");
+  setCensus->SetParameterName("enable", true);
+  setCensus->SetDefaultValue(true);
+  setCensus->AvailableForStates(G4State_PreInit, G4State_Idle);
+  setCensus->SetToBeBroadcasted(false);
+  fSetCensus = setCensus;
+
+  auto setTargetPopulation = new G4UIcmdWithAnInteger("/stack/targetPopulation", this);
+  setTargetPopulation->SetGuidance("Roulette each census generation down to this population (0: unset).");
+  setTargetPopulation->SetParameterName("population", false);
+  setTargetPopulation->SetRange("population >= 0");
+  setTargetPopulation->AvailableForStates(G4State_PreInit, G4State_Idle);
+  setTargetPopulation->SetToBeBroadcasted(false);
+  fSetTargetPopulation = setTargetPopulation;
+
+  auto setSplitting = new G4UIcmdWithABool("/stack/splitting", this);
+  setSplitting->SetGuidance("Split census generations below half the target population.");
+  setSplitting->SetParameterName("enable", true);
+  setSplitting->SetDefaultValue(true);
+  setSplitting->AvailableForStates(G4State_PreInit, G4State_Idle);
+  setSplitting->SetToBeBroadcasted(false);
+  fSetSplitting = setSplitting;
+
+  auto setWatermark = new G4UIcmdWithAnInteger("/stack/watermark", this);
+  setWatermark->SetGuidance("Roulette newborn neutrons with survival 1/2 while the stack");
+  setWatermark->SetGuidance("holds at least this many tracks (0: unset).");
+  setWatermark->SetParameterName("tracks", false);
+  setWatermark->SetRange("tracks >= 0");
+  setWatermark->AvailableForStates(G4State_PreInit, G4State_Idle);
+  setWatermark->SetToBeBroadcasted(false);
+  fSetWatermark = setWatermark;
+
+  auto setNeutronOnly = new G4UIcmdWithABool("/stack/neutronOnly", this);
+  setNeutronOnly->SetGuidance("Kill every secondary other than neutrons at birth.");
+  setNeutronOnly->SetGuidance("Always on with the neutron-only physics list (USPHERE_PHYSICS=neutron).");
+  setNeutronOnly->SetParameterName("enable", true);
+  setNeutronOnly->SetDefaultValue(true);
+  setNeutronOnly->AvailableForStates(G4State_PreInit, G4State_Idle);
+  setNeutronOnly->SetToBeBroadcasted(false);
+  fSetNeutronOnly = setNeutronOnly;
+
+  auto setDepositEstimate = new G4UIcmdWithABool("/stack/depositEstimate", this);
+  setDepositEstimate->SetGuidance("Sum the kinetic energy of secondaries killed in neutron-only");
+  setDepositEstimate->SetGuidance("mode, and report it per event at end of run.");
+  setDepositEstimate->SetParameterName("enable", true);
+  setDepositEstimate->SetDefaultValue(true);
+  setDepositEstimate->AvailableForStates(G4State_PreInit, G4State_Idle);
+  setDepositEstimate->SetToBeBroadcasted(false);
+  fSetDepositEstimate = setDepositEstimate;
+
+  auto setSubEventThreshold = new G4UIcmdWithAnInteger("/stack/subEventThreshold", this);
+  setSubEventThreshold->SetGuidance("Hand census generations of at least this many neutrons over to");
+  setSubEventThreshold->SetGuidance("idle worker threads as sub-events (0: unset). MT runs only.");
+  setSubEventThreshold->SetParameterName("population", false);
+  setSubEventThreshold->SetRange("population >= 0");
+  setSubEventThreshold->AvailableForStates(G4State_PreInit, G4State_Idle);
+  setSubEventThreshold->SetToBeBroadcasted(false);
+  fSetSubEventThreshold = setSubEventThreshold;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+StackingMessenger::~StackingMessenger()
+{
+  delete fSetSubEventThreshold;
+  delete fSetDepositEstimate;
+  delete fSetNeutronOnly;
+  delete fSetWatermark;
+  delete fSetSplitting;
+  delete fSetTargetPopulation;
+  delete fSetCensus;
+  delete fStackDirectory;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void StackingMessenger::SetNewValue(G4UIcommand *command, G4String newValue)
+{
+  if(command == fSetCensus) {
+    StackingAction::SetCensus(fSetCensus->GetNewBoolValue(newValue));
+    return;
+  }
+
+  if(command == fSetTargetPopulation) {
+    StackingAction::SetTargetPopulation(fSetTargetPopulation->GetNewIntValue(newValue));
+    return;
+  }
+
+  if(command == fSetSplitting) {
+    StackingAction::SetSplitting(fSetSplitting->GetNewBoolValue(newValue));
+    return;
+  }
+
+  if(command == fSetWatermark) {
+    StackingAction::SetWatermark(fSetWatermark->GetNewIntValue(newValue));
+    return;
+  }
+
+  if(command == fSetNeutronOnly) {
+    G4bool neutronOnly = fSetNeutronOnly->GetNewBoolValue(newValue);
+    if(!neutronOnly && StackingAction::IsNeutronOnlyRequired()) {
+      G4cerr << "/stack/neutronOnly: the neutron-only physics list has no EM physics;"
+             << " non-neutron secondaries stay killed" << G4endl;
+      return;
+    }
+    StackingAction::SetNeutronOnly(neutronOnly);
+    return;
+  }
+
+  if(command == fSetDepositEstimate) {
+    StackingAction::SetDepositEstimate(fSetDepositEstimate->GetNewBoolValue(newValue));
+    return;
+  }
+
+  if(command == fSetSubEventThreshold) {
+    SubEventQueue::SetThreshold(fSetSubEventThreshold->GetNewIntValue(newValue));
+    return;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
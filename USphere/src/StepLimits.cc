@@ -0,0 +1,89 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/src/StepLimits.cc
+/// \brief Implementation of the B1::StepLimits class
+
+#include "StepLimits.hh"
+
+#include "G4Track.hh"
+#include "G4ParticleDefinition.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <cfloat>
+
+namespace B1
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+StepLimits::StepLimits(G4double radius, G4double fraction)
+  : G4UserLimits(ToStep(radius, fraction)), fRadius(radius), fDefaultFraction(fraction)
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double StepLimits::GetMaxAllowedStep(const G4Track &track)
+{
+  auto particle = track.GetDefinition();
+  for(auto [definition, fraction] : fFractions) {
+    if(definition == particle) return ToStep(fRadius, fraction);
+  }
+  return ToStep(fRadius, fDefaultFraction);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void StepLimits::SetFraction(const G4ParticleDefinition *particle, G4double fraction)
+{
+  for(auto &entry : fFractions) {
+    if(entry.first == particle) {
+      entry.second = fraction;
+      return;
+    }
+  }
+  fFractions.emplace_back(particle, fraction);
+}
+
+void StepLimits::Print() const
+{
+  G4cout << "StepLimits: default " << fDefaultFraction << " x radius";
+  for(auto [definition, fraction] : fFractions) {
+    G4cout << ", " << definition->GetParticleName() << " " << fraction << " x radius";
+  }
+  G4cout << " (0: unlimited)" << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double StepLimits::ToStep(G4double radius, G4double fraction)
+{
+  return fraction > 0.0 ? fraction * radius : DBL_MAX;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
@@ -0,0 +1,103 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/src/SteppingAction.cc
+/// \brief Implementation of the B1::SteppingAction class
+
+#include "SteppingAction.hh"
+#include "FluxMesh.hh"
+#include "DetectorConstruction.hh"
+
+#include "G4Step.hh"
+#include "G4Neutron.hh"
+#include "G4LogicalVolume.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4RunManager.hh"
+
+#include <algorithm>
+#include <cmath>
+
+namespace B1
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SteppingAction::UserSteppingAction(const G4Step* step)
+{
+  if(!fEnabled) return;
+  if(step->GetTrack()->GetDefinition() != G4Neutron::Neutron()) return;
+  auto preStepPoint = step->GetPreStepPoint();
+  if(preStepPoint->GetPhysicalVolume()->GetLogicalVolume() != fSphere) return;
+
+  // Steps longer than a shell are scored in pieces; with the default step
+  // limit there is a single piece.
+  auto postStepPoint = step->GetPostStepPoint();
+  G4double length = step->GetStepLength();
+  G4int pieces = std::max(1, (G4int)std::ceil(length * fInverseShellWidth));
+  G4ThreeVector position = preStepPoint->GetPosition();
+  G4ThreeVector delta = (postStepPoint->GetPosition() - position) / pieces;
+  G4double time = preStepPoint->GetGlobalTime();
+  G4double deltaTime = (postStepPoint->GetGlobalTime() - time) / pieces;
+  G4double weight = length / pieces * preStepPoint->GetWeight();
+  for(G4int piece = 0; piece < pieces; ++piece) {
+    G4double middle = piece + 0.5;
+    G4int bin = (G4int)((time + middle * deltaTime) * fInverseTimeWidth);
+    if(bin < 0 || bin >= fTimeBins) continue;
+    G4double radius = (position + middle * delta).mag();
+    G4int shell = std::min((G4int)(radius * fInverseShellWidth), fShells - 1);
+    fFlux[shell * fTimeBins + bin] += weight;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SteppingAction::BeginOfRun()
+{
+  // Cache the mesh for the per-step path.
+  auto fluxMesh = FluxMesh::Instance();
+  fEnabled = fluxMesh->IsEnabled();
+  if(!fEnabled) {
+    fFlux.clear();
+    return;
+  }
+  auto detectorConstruction = (const DetectorConstruction *)
+    G4RunManager::GetRunManager()->GetUserDetectorConstruction();
+  fSphere = detectorConstruction->GetSphere();
+  fShells = fluxMesh->GetShells();
+  fTimeBins = fluxMesh->GetTimeBins();
+  fInverseShellWidth = fShells / detectorConstruction->GetRadius();
+  fInverseTimeWidth = fTimeBins / fluxMesh->GetTimeMax();
+  fFlux.assign(fShells * fTimeBins, 0.0);
+}
+
+void SteppingAction::EndOfRun()
+{
+  if(fEnabled) FluxMesh::Instance()->Merge(fFlux);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
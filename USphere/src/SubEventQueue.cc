@@ -0,0 +1,115 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/src/SubEventQueue.cc
+/// \brief Implementation of the B1::SubEventQueue class
+
+#include "SubEventQueue.hh"
+#include "GrowthRateEstimator.hh"
+
+#include "G4AutoLock.hh"
+
+#include <algorithm>
+
+namespace B1
+{
+
+G4int SubEventQueue::fThreshold = 0;
+G4ThreadLocal const SubEvent *SubEventQueue::fCurrent = nullptr;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+SubEventQueue *SubEventQueue::Instance()
+{
+  static SubEventQueue instance;
+  return &instance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SubEventQueue::Reset(G4bool enabled)
+{
+  G4AutoLock lock(fMutex);
+  fEnabled = enabled;
+  fQueue.clear();
+  fActive = 0;
+}
+
+void SubEventQueue::Submit(G4int eventID, G4int generation, G4long batch, std::vector<SubEventNeutron> neutrons)
+{
+  // One share per worker, so every idle thread gets one.
+  if(neutrons.empty()) return;
+  size_t shares = std::max(1, G4Threading::GetNumberOfRunningWorkerThreads());
+  size_t size = (neutrons.size() + shares - 1) / shares;
+
+  // The batch must expect the sub-events before any of them can be done.
+  GrowthRateEstimator::Instance()->AddSubEvents(batch, (neutrons.size() + size - 1) / size);
+  {
+    G4AutoLock lock(fMutex);
+    for(size_t begin = 0; begin < neutrons.size(); begin += size) {
+      SubEvent subEvent;
+      subEvent.eventID = eventID;
+      subEvent.generation = generation;
+      subEvent.batch = batch;
+      auto first = neutrons.begin() + begin;
+      subEvent.neutrons.assign(first, first + std::min(size, neutrons.size() - begin));
+      fQueue.push_back(std::move(subEvent));
+    }
+  }
+  fCondition.notify_all();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SubEventQueue::Enter()
+{
+  G4AutoLock lock(fMutex);
+  ++fActive;
+}
+
+void SubEventQueue::Leave()
+{
+  {
+    G4AutoLock lock(fMutex);
+    --fActive;
+  }
+  fCondition.notify_all();
+}
+
+G4bool SubEventQueue::Take(SubEvent &subEvent)
+{
+  G4AutoLock lock(fMutex);
+  fCondition.wait(lock, [this] { return !fQueue.empty() || !fActive; });
+  if(fQueue.empty()) return false;
+  subEvent = std::move(fQueue.front());
+  fQueue.pop_front();
+  ++fActive;
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
@@ -0,0 +1,179 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B1/src/TreeWriter.cc
+/// \brief Implementation of the B1::TreeWriter class
+
+#include "TreeWriter.hh"
+
+#include "G4AutoLock.hh"
+
+#include <TROOT.h>
+#include <TFile.h>
+#include <TTree.h>
+#include <algorithm>
+#include <climits>
+#include <stdexcept>
+#include <utility>
+
+namespace B1
+{
+
+G4int TreeWriter::fCompression = -1;
+G4int TreeWriter::fBasketSize = 0;
+G4long TreeWriter::fAutoFlush = 0;
+G4long TreeWriter::fAutoSaveBytes = 300000000;
+G4long TreeWriter::fQueueBytes = 256000000;
+G4bool TreeWriter::fFloatTimes = false;
+G4bool TreeWriter::fShortGenerations = false;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+TreeWriter::TreeWriter(const G4String &fileName, const G4String &treeName, Layout layout, G4bool weighted)
+  : fTreeName(treeName), fLayout(layout)
+{
+  // The file is opened here and filled on the I/O thread.
+  ROOT::EnableThreadSafety();
+  fFile = new TFile(fileName, "NEW");
+  if(!fFile->IsOpen()) throw std::runtime_error("error opening output file: " + fileName);
+  if(fCompression >= 0) fFile->SetCompressionSettings(fCompression);
+  if(fLayout == Layout::None) return;
+
+  fTree = new TTree(fTreeName, fTreeName);
+  if(fLayout == Layout::Summary) {
+    fTree->Branch("NeutronCount", &fRecord.neutronCount, "NeutronCount/I");
+    fTree->Branch("MaxGeneration", &fRecord.maxGeneration, "MaxGeneration/I");
+    fTree->Branch("MaxGlobalTime", &fRecord.maxGlobalTime, "MaxGlobalTime/D");
+  }
+  else {
+    if(fShortGenerations) fTree->Branch("NeutronGeneration", &fShortGeneration);
+    else fTree->Branch("NeutronGeneration", &fRecord.neutronGeneration);
+    if(fFloatTimes) fTree->Branch("NeutronGlobalTime", &fFloatGlobalTime);
+    else fTree->Branch("NeutronGlobalTime", &fRecord.neutronGlobalTime);
+    if(weighted) fTree->Branch("NeutronWeight", &fRecord.neutronWeight);
+  }
+  if(fBasketSize > 0) fTree->SetBasketSize("*", fBasketSize);
+  if(fAutoFlush != 0) fTree->SetAutoFlush(fAutoFlush);
+  fTree->SetAutoSave(0);  // checkpoints are taken in Fill()
+  fThread = std::thread(&TreeWriter::Loop, this);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+TreeWriter::~TreeWriter()
+{
+  Finish();
+  delete fTree;
+  delete fFile;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TreeWriter::Push(Record &&record)
+{
+  G4long bytes = GetBytes(record);
+  G4AutoLock lock(fMutex);
+  // Back-pressure only when the I/O thread falls far behind.
+  fPopped.wait(lock, [&] { return fQueue.empty() || fQueuedBytes + bytes <= fQueueBytes; });
+  fQueuedBytes += bytes;
+  fQueue.push_back(std::move(record));
+  fPushed.notify_one();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TreeWriter::Finish()
+{
+  // Drain the queue, then write the tree from the calling thread.
+  if(fThread.joinable()) {
+    {
+      G4AutoLock lock(fMutex);
+      fFinishing = true;
+      fPushed.notify_one();
+    }
+    fThread.join();
+    if(fGenerationOverflows > 0) {
+      G4cerr << "TreeWriter: " << fGenerationOverflows << " neutron generations above "
+             << SHRT_MAX << " were saturated by /out/shortGenerations" << G4endl;
+    }
+    fFile->cd();
+    fTree->Write(fTreeName, fTree->kOverwrite);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TreeWriter::Loop()
+{
+  for(;;) {
+    Record record;
+    {
+      G4AutoLock lock(fMutex);
+      fPushed.wait(lock, [&] { return !fQueue.empty() || fFinishing; });
+      if(fQueue.empty()) return;
+      record = std::move(fQueue.front());
+      fQueue.pop_front();
+      fQueuedBytes -= GetBytes(record);
+      fPopped.notify_all();
+    }
+    Fill(record);
+  }
+}
+
+void TreeWriter::Fill(Record &record)
+{
+  // Swap the record into the branch buffers, converting where requested.
+  std::swap(fRecord, record);
+  if(fShortGenerations) {
+    // Saturate instead of wrapping, and count the generations that did not fit.
+    fShortGeneration.resize(fRecord.neutronGeneration.size());
+    for(size_t i = 0; i < fShortGeneration.size(); ++i) {
+      int generation = fRecord.neutronGeneration[i];
+      if(generation > SHRT_MAX) ++fGenerationOverflows;
+      fShortGeneration[i] = (short)std::min(generation, (int)SHRT_MAX);
+    }
+  }
+  if(fFloatTimes) fFloatGlobalTime.assign(fRecord.neutronGlobalTime.begin(), fRecord.neutronGlobalTime.end());
+  fTree->Fill();
+
+  // Checkpoint by compressed size.
+  if(fAutoSaveBytes > 0 && fTree->GetZipBytes() - fSavedBytes >= fAutoSaveBytes) {
+    fSavedBytes = fTree->GetZipBytes();
+    G4cout << "AutoSave: saving " << fTree->GetEntries() << " events ("
+           << fSavedBytes / 1000000 << " MB compressed)" << G4endl;
+    fTree->AutoSave("SaveSelf, Overwrite");
+  }
+}
+
+G4long TreeWriter::GetBytes(const Record &record)
+{
+  return sizeof(Record) + record.neutronGeneration.size() * sizeof(int)
+       + (record.neutronGlobalTime.size() + record.neutronWeight.size()) * sizeof(double);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
@@ -0,0 +1,57 @@
+#!/usr/bin/env python3
+
+# Differences of the growth-rate tallies of USphere runs to the first run,
+# with their combined errors, e.g. for steplimit.mac or neutrononly.mac:
+#   ./tallydiff.py steplimit.log
+#   ./tallydiff.py full.log neutron.log
+# Runs are named by a preceding "/control/echo Run: <name>", or else by
+# their log file and position in it.
+
+import re
+import sys
+import math
+
+runs = []
+for filename in sys.argv[1:]:
+    name, count = None, 0
+    for line in open(filename):
+        match = re.match(r'"?Run: ([^"]*)', line)
+        if match:
+            name = match.group(1).strip()
+            continue
+        match = re.match(r' Throughput: .*?(?:\(([-+.\deE]+) events/s\))?$', line)
+        if match:
+            count += 1
+            if name and len(sys.argv) > 2:
+                name = '%s: %s' % (filename, name)
+            runs.append({'name': name or '%s:%d' % (filename, count)})
+            if match.group(1):
+                runs[-1]['rate'] = float(match.group(1))
+            name = None
+            continue
+        match = re.match(r'  (time \[1/ns\]|generation): k = ([-+.\deE]+) \(([-+.\deE]+)\)', line)
+        if match and runs:
+            runs[-1][match.group(1)] = (float(match.group(2)), float(match.group(3)))
+
+if len(runs) < 2:
+    sys.exit('usage: %s log... (with at least two runs)' % sys.argv[0])
+
+reference = runs[0]
+print('reference: %s' % reference['name'], end='')
+for tally in ('time [1/ns]', 'generation'):
+    if tally in reference:
+        print('  %s: k = %.4e (%.1e)' % ((tally,) + reference[tally]), end='')
+print()
+for run in runs[1:]:
+    print('%-24s' % run['name'], end='')
+    if 'rate' in run and 'rate' in reference:
+        print('  %10.1f events/s (x%.2f)' % (run['rate'], run['rate'] / reference['rate']), end='')
+    for tally in ('time [1/ns]', 'generation'):
+        if tally not in run or tally not in reference:
+            print('  %s: no fit' % tally, end='')
+            continue
+        (k, error), (k0, error0) = run[tally], reference[tally]
+        sigma = math.hypot(error, error0)
+        z = (k - k0) / sigma if sigma > 0 else 0.0
+        print('  %s: dk = %+.3e (%.1e, %+.1f sigma)' % (tally, k - k0, sigma, z), end='')
+    print()
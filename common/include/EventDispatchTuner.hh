@@ -0,0 +1,115 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file common/include/EventDispatchTuner.hh
+/// \brief Definition of the EventDispatchTuner class
+
+#ifndef EventDispatchTuner_h
+#define EventDispatchTuner_h 1
+
+#include "G4UserWorkerInitialization.hh"
+#include "G4VStateDependent.hh"
+#include "G4Threading.hh"
+#include "globals.hh"
+
+#include <chrono>
+
+/// Event dispatch tuner : choose the event modulo, and the task grain size
+/// with tasking, from the measured wall time of events.
+///
+/// Every worker times its events; the statistics are merged at the end of
+/// each run, and the master derives the dispatch of the next run from them:
+/// - events are handed out by chunks of about kChunkTime, so short events
+///   do not pay the dispatch cost one at a time;
+/// - each thread still gets at least kChunksPerThread chunks, and events
+///   longer than kTailRatio times the mean fall back to one at a time, so
+///   a few long events do not leave the other threads idle at the end.
+/// The event modulo is read when a run starts, so it is derived from the
+/// event times of the previous run and the event and thread counts of the
+/// run about to start. Decisions are logged to G4cout and appended to
+/// <name>-dispatch.log, which keeps the last kLogLines of them; the event
+/// times of its last line seed the first run of the next launch.
+///
+/// Shared by the applications of this repository; pass it to an MT or
+/// tasking run manager as its worker initialization.
+
+class EventDispatchTuner : public G4UserWorkerInitialization, public G4VStateDependent
+{
+  public:
+    EventDispatchTuner(const G4String &name);
+    ~EventDispatchTuner() override = default;
+
+    // Worker side, called on each worker thread.
+    void WorkerStart() const override;
+    void WorkerRunEnd() const override;
+    void WorkerStop() const override;
+
+    // Master side: run boundaries.
+    G4bool Notify(G4ApplicationState requestedState) override;
+
+    static constexpr G4double kChunkTime = 0.01;  // s
+    static constexpr G4int kChunksPerThread = 16;
+    static constexpr G4double kTailRatio = 20.0;
+    static constexpr G4int kLogLines = 100;
+
+  private:
+    struct Statistics
+    {
+      G4long events = 0;
+      G4double sum = 0.0;  // s
+      G4double max = 0.0;  // s
+
+      void Add(const Statistics &other);
+    };
+
+    class EventTimer;
+
+    G4String fLogName;
+    G4int fNumberOfThreads = 0;
+    G4int fNumberOfEvents = 0;
+    std::chrono::steady_clock::time_point fRunStart;
+
+    // Event times of the last measured run, 0 if none; s.
+    G4double fMean = 0.0;
+    G4double fMax = 0.0;
+
+    // Current decision; 0 leaves the run manager default.
+    G4int fEventModulo = 0;
+    G4int fGrainsize = 0;
+
+    // Merged from the workers at the end of each run.
+    mutable G4Mutex fMutex;
+    mutable Statistics fStatistics;
+    static G4ThreadLocal EventTimer *fEventTimer;
+
+    void Apply();
+    void Decide(G4double wallTime);
+    G4int Modulo(G4int events, G4int threads) const;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,218 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file common/src/EventDispatchTuner.cc
+/// \brief Implementation of the EventDispatchTuner class
+
+#include "EventDispatchTuner.hh"
+
+#include "G4MTRunManager.hh"
+#include "G4TaskRunManager.hh"
+#include "G4StateManager.hh"
+#include "G4AutoLock.hh"
+#include "G4ios.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+/// Per-thread event timer: events run between GeomClosed and EventProc.
+
+class EventDispatchTuner::EventTimer : public G4VStateDependent
+{
+  public:
+    G4bool Notify(G4ApplicationState requestedState) override
+    {
+      G4ApplicationState currentState = G4StateManager::GetStateManager()->GetCurrentState();
+      if(currentState == G4State_Idle && requestedState == G4State_GeomClosed) {
+        fStatistics = Statistics();
+      }
+      else if(currentState == G4State_GeomClosed && requestedState == G4State_EventProc) {
+        fStart = std::chrono::steady_clock::now();
+      }
+      else if(currentState == G4State_EventProc && requestedState == G4State_GeomClosed) {
+        std::chrono::duration<G4double> time = std::chrono::steady_clock::now() - fStart;
+        ++fStatistics.events;
+        fStatistics.sum += time.count();
+        fStatistics.max = std::max(fStatistics.max, time.count());
+      }
+      return true;
+    }
+
+    Statistics fStatistics;
+
+  private:
+    std::chrono::steady_clock::time_point fStart;
+};
+
+G4ThreadLocal EventDispatchTuner::EventTimer *EventDispatchTuner::fEventTimer = nullptr;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventDispatchTuner::Statistics::Add(const Statistics &other)
+{
+  events += other.events;
+  sum += other.sum;
+  max = std::max(max, other.max);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+EventDispatchTuner::EventDispatchTuner(const G4String &name)
+  : fLogName(name + "-dispatch.log")
+{
+  // Start from the event times of the previous launch, if any; the modulo
+  // follows from them and the counts of the first run.
+  std::ifstream log(fLogName);
+  std::string line, last;
+  while(std::getline(log, line)) if(!line.empty()) last = line;
+  std::istringstream fields(last);
+  std::string key;
+  while(fields >> key) {
+    if(key == "mean") fields >> fMean;
+    else if(key == "max") fields >> fMax;
+  }
+  if(!(fMean > 0.0 && fMax >= fMean)) fMean = fMax = 0.0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventDispatchTuner::WorkerStart() const
+{
+  if(!fEventTimer) fEventTimer = new EventTimer;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventDispatchTuner::WorkerRunEnd() const
+{
+  // Workers reach this before the end-of-run barrier, so the master sees
+  // every thread merged when it goes back to Idle.
+  if(!fEventTimer) return;
+  G4AutoLock lock(&fMutex);
+  fStatistics.Add(fEventTimer->fStatistics);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventDispatchTuner::WorkerStop() const
+{
+  // Deregisters the timer from this thread's state manager.
+  delete fEventTimer;
+  fEventTimer = nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool EventDispatchTuner::Notify(G4ApplicationState requestedState)
+{
+  // Run initialization closes the geometry before the event loop reads the
+  // event modulo, and run termination opens it after the workers are done.
+  G4ApplicationState currentState = G4StateManager::GetStateManager()->GetCurrentState();
+  if(currentState == G4State_Idle && requestedState == G4State_GeomClosed) {
+    auto runManager = G4RunManager::GetRunManager();
+    fNumberOfEvents = runManager->GetNumberOfEventsToBeProcessed();
+    if(auto mtRunManager = dynamic_cast<G4MTRunManager *>(runManager)) {
+      fNumberOfThreads = mtRunManager->GetNumberOfThreads();
+    }
+    fStatistics = Statistics();
+    fRunStart = std::chrono::steady_clock::now();
+    Apply();
+  }
+  else if(currentState == G4State_GeomClosed && requestedState == G4State_Idle) {
+    std::chrono::duration<G4double> wallTime = std::chrono::steady_clock::now() - fRunStart;
+    Decide(wallTime.count());
+  }
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventDispatchTuner::Apply()
+{
+  if(fMean <= 0.0 || fNumberOfEvents <= 0 || fNumberOfThreads <= 0) return;
+  fEventModulo = Modulo(fNumberOfEvents, fNumberOfThreads);
+  auto runManager = G4RunManager::GetRunManager();
+  if(auto taskRunManager = dynamic_cast<G4TaskRunManager *>(runManager)) {
+    // Tasks of about one chunk each, but at least one per thread.
+    G4int tasks = (fNumberOfEvents + fEventModulo - 1) / fEventModulo;
+    fGrainsize = std::min(fNumberOfEvents, std::max(fNumberOfThreads, tasks));
+    taskRunManager->SetGrainsize(fGrainsize);
+  }
+  if(auto mtRunManager = dynamic_cast<G4MTRunManager *>(runManager)) {
+    mtRunManager->SetEventModulo(fEventModulo);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventDispatchTuner::Decide(G4double wallTime)
+{
+  if(fStatistics.events == 0 || fNumberOfThreads <= 0) return;
+  G4double idle = 1.0 - fStatistics.sum / (fNumberOfThreads * wallTime);
+  fMean = fStatistics.sum / fStatistics.events;
+  fMax = fStatistics.max;
+
+  // The modulo a run of the same size would start with; the next run
+  // derives its own from its event and thread counts.
+  std::ostringstream line;
+  line << "events " << fStatistics.events << " mean " << fMean << " max " << fMax
+       << " threads " << fNumberOfThreads << " idle " << std::max(idle, 0.0)
+       << " grainsize " << fGrainsize << " modulo " << fEventModulo
+       << " -> modulo " << Modulo(fNumberOfEvents, fNumberOfThreads);
+  G4cout << "EventDispatchTuner: " << line.str() << G4endl;
+
+  // Keep the log to its last kLogLines decisions.
+  std::deque<std::string> lines;
+  {
+    std::ifstream log(fLogName);
+    for(std::string previous; std::getline(log, previous); ) {
+      if(previous.empty()) continue;
+      lines.push_back(previous);
+      if((G4int)lines.size() >= kLogLines) lines.pop_front();
+    }
+  }
+  lines.push_back(line.str());
+  std::ofstream log(fLogName, std::ios::trunc);
+  for(const auto &entry : lines) log << entry << '\n';
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int EventDispatchTuner::Modulo(G4int events, G4int threads) const
+{
+  if(fMax > kTailRatio * fMean) return 1;
+  G4double chunk = std::ceil(kChunkTime / fMean);
+  G4double share = G4double(events) / (kChunksPerThread * threads);
+  return G4int(std::max(1.0, std::min({chunk, share, 1e9})));
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......